@@ -4,7 +4,7 @@
 #include <functional>
 #include "mandelbrotrenderer.h"
 #include "computeddatasegment.h"
-#include "renderworker.h"
+#include "cancellationtoken.h"
 
 /*
  * This templated class represents
@@ -14,20 +14,26 @@
  * which prepares the correct parameter values for the kernel
  * to execute the task given the type used.
  *
+ * The task owner supplies the pass, set type, colormap
+ * and colour scale used by the kernel.
+ *
  */
-template <typename T>
+template <typename T, typename TaskOwner>
 class ComputeTaskGenerator
 {
 public:
-    ComputeTaskGenerator(RenderWorker& workerOwner);
+    ComputeTaskGenerator(TaskOwner& workerOwner);
 
-    RenderWorker::computeFunction generateComputeTask();
+    MandelBrotRenderer::computeFunction generateComputeTask();
 
 
 private:
-    RenderWorker& workerOwner;
+    TaskOwner& workerOwner;
 };
 
+template <typename TaskOwner>
+MandelBrotRenderer::computeFunction generateComputeTaskForType(TaskOwner& taskOwner, MandelBrotRenderer::internalDataType numericType);
+
 #include "ComputeTaskGenerator.cpp"
 
 #endif // COMPUTETASK_H
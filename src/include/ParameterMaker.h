@@ -58,7 +58,7 @@ struct ParameterMaker
 
     template <typename TT, typename U = ComputedDataSegment>
     explicit ParameterMaker(typename std::enable_if<!MandelParams::needs_scale_shift<TT>::value &&
-                                        MandelParams::multiply_by_float_supported<TT>::value, U>::type dataSegment, TT limitValue) :
+                                        MandelParams::multiply_by_float_supported<TT>::value, const U&>::type dataSegment, TT limitValue) :
         scalingShift(0),
         scaling(1),
         minX(dataSegment.getMinX()),
@@ -80,7 +80,7 @@ struct ParameterMaker
  */
     template <typename TT, typename U = ComputedDataSegment>
     explicit ParameterMaker(typename std::enable_if<MandelParams::needs_scale_shift<TT>::value &&
-                                            MandelParams::multiply_by_float_supported<TT>::value, U>::type dataSegment, TT limitValue) :
+                                            MandelParams::multiply_by_float_supported<TT>::value, const U&>::type dataSegment, TT limitValue) :
     scalingShift(((sizeof(T) * CHAR_BIT) / 2) - (MAGNITUDE_BITS * 2)),
     scaling(static_cast<int64_t>(1LL << scalingShift)),
     minX(dataSegment.getMinX()),
@@ -97,7 +97,7 @@ struct ParameterMaker
  * Constructor for Boost multiprecision integer types
  */
     template <typename U = ComputedDataSegment>
-    explicit ParameterMaker(ComputedDataSegment dataSegment, MandelBrotRenderer::Int128 limitValue) :
+    explicit ParameterMaker(const ComputedDataSegment& dataSegment, MandelBrotRenderer::Int128 limitValue) :
         scalingShift(doubleToIntShift),
         scaling((1LL << scalingShift)),
         minX(dataSegment.getMinX()),
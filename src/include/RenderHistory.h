@@ -2,7 +2,12 @@
 #define RENDERHISTORY_H
 #include "mandelbrotrenderer.h"
 
+#include <QByteArray>
+#include <QImage>
 #include <QObject>
+#include <QSize>
+
+#include <cstddef>
 #include <list>
 
 class MandelbrotWidget;
@@ -14,6 +19,9 @@ class MandelbrotWidget;
  * consider saving the state to prevent its loss on quitting
  * the program.
  *
+ * Entries keep a compressed copy of their completed image (within
+ * a memory budget), so undo and redo show it without rendering again
+ *
  */
 
 class RenderHistory : public QObject
@@ -27,26 +35,54 @@ public:
     bool undoIsPossible() const;
     bool redoIsPossible() const;
 
+    void setFrameMemoryBudget(std::size_t bytes);
+    std::size_t getFrameMemoryBudget() const { return frameMemoryBudget; }
+
+    static constexpr std::size_t DEFAULT_FRAME_MEMORY_BUDGET_IN_BYTES = 64 * 1024 * 1024;
+
 public slots:
     void undo();
     void redo();
+    void storeFrame(const QImage& image, const QString& originX, const QString& originY, double scaleFactor, int numPasses);
 
 signals:
     void undoIsAvailable(bool available);
     void redoIsAvailable(bool available);
 
 private:
-    using stateListIter = std::list<MandelBrotRenderer::RenderState>::iterator;
+    struct HistoryFrame
+    {
+        QByteArray pixels;      // compressed lines of an RGB32 image, empty if there is no frame
+        QSize size;
+        int numPasses;
+    };
+
+    struct HistoryEntry
+    {
+        MandelBrotRenderer::RenderState state;
+        HistoryFrame frame;
+    };
+
+    using stateListIter = std::list<HistoryEntry>::iterator;
     enum class Direction { forwards, backwards };
 
     void setNewState(Direction moveDirection);
     void checkAvailability();
     stateListIter getLastEntryPos();
     void removeTailEntries();
+    void dropFrame(HistoryFrame& frame);
+    void trimFrames();
+
+    static QByteArray compressFrame(const QImage& image);
+    static QImage decompressFrame(const HistoryFrame& frame);
 
     MandelbrotWidget* const stateHolder;
-    std::list<MandelBrotRenderer::RenderState> historyLog;
+    std::list<HistoryEntry> historyLog;
     stateListIter currentPos;
+    std::size_t frameMemoryBudget;
+    std::size_t frameMemoryUsed;
+
+    static constexpr int FRAME_COMPRESSION_LEVEL = 1;
 
 };
 
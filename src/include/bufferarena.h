@@ -0,0 +1,87 @@
+#ifndef BUFFERARENA_H
+#define BUFFERARENA_H
+
+#include <QImage>
+#include <QMutex>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+
+/*
+ * Pool of cache line aligned pixel buffers, reused across passes and renders
+ *
+ * Images created by the arena give their buffer back to the pool when the
+ * last copy of the image is destroyed (this may happen in any thread), a
+ * few released buffers are kept for the next image of the same size.
+ * Image lines are padded to a whole number of cache lines, so workers
+ * writing neighbouring lines never share a cache line.
+ *
+ * Large buffers can optionally be backed by huge pages (Linux only,
+ * otherwise the request is ignored).
+ *
+ * The arena must outlive every image it has created
+ */
+
+class BufferArena
+{
+public:
+    explicit BufferArena(bool useHugePages = false);
+    ~BufferArena();
+
+    BufferArena(const BufferArena&) = delete;
+    BufferArena& operator=(const BufferArena&) = delete;
+
+    QImage createImage(const QSize& size);
+
+    uchar* acquire(std::size_t size);
+    void release(uchar* buffer, std::size_t size);
+
+    struct Statistics
+    {
+        int64_t allocationCount;    // buffers newly allocated
+        int64_t allocatedBytes;     // bytes of all buffers currently owned by the arena
+        int64_t reuseCount;         // requests served from the pool
+        int64_t pooledBytes;        // bytes of released buffers waiting for reuse
+    };
+
+    Statistics getStatistics() const;
+    void resetCounters();
+
+    bool getUseHugePages() const;
+    void setUseHugePages(bool value);
+
+    static constexpr std::size_t CACHE_LINE_SIZE = 64;
+    static constexpr std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    static constexpr std::size_t MAX_POOLED_BUFFERS = 4;
+
+private:
+    struct PooledBuffer
+    {
+        uchar* buffer;
+        std::size_t size;
+    };
+
+    struct ImageBuffer
+    {
+        BufferArena* arena;
+        uchar* buffer;
+        std::size_t size;
+    };
+
+    static void releaseImageBuffer(void* info);
+
+    uchar* allocate(std::size_t size);
+    void deallocate(uchar* buffer, std::size_t size);
+
+    mutable QMutex mutex;
+    std::list<PooledBuffer> pool;
+    bool useHugePages;
+
+    int64_t allocationCount;
+    int64_t allocatedBytes;
+    int64_t reuseCount;
+    int64_t pooledBytes;
+};
+
+#endif // BUFFERARENA_H
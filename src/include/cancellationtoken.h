@@ -0,0 +1,47 @@
+#ifndef CANCELLATIONTOKEN_H
+#define CANCELLATIONTOKEN_H
+
+#include <QElapsedTimer>
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Cooperative cancellation flag shared between the master
+ * render thread and its workers
+ *
+ * Workers poll it per pixel line, per pixel and every
+ * (POLL_INTERVAL_IN_ITERATIONS) kernel iterations, and record how long
+ * it took them to stop after cancel() was called
+ */
+
+class CancellationToken
+{
+public:
+    CancellationToken() = default;
+    ~CancellationToken() = default;
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken(CancellationToken&&) = delete;
+    CancellationToken& operator=(const CancellationToken&) = delete;
+    CancellationToken& operator=(CancellationToken&&) = delete;
+
+    void cancel();
+    void reset();
+    bool isCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+
+    void recordWorkerStopped() const;
+    int64_t getMaxStopLatencyInUs() const { return maxStopLatencyInUs.load(); }
+
+    //must be a power of 2, the kernel performs two iterations per loop
+    static constexpr uint POLL_INTERVAL_IN_ITERATIONS = 1024;
+    static constexpr uint POLL_INTERVAL_MASK = POLL_INTERVAL_IN_ITERATIONS - 1;
+
+private:
+    std::atomic<bool> cancelled {false};
+    QElapsedTimer cancelTimer;
+    mutable std::atomic<int64_t> maxStopLatencyInUs {0};
+
+    static constexpr int64_t NS_IN_ONE_US = 1000;
+};
+
+#endif // CANCELLATIONTOKEN_H
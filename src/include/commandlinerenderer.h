@@ -0,0 +1,122 @@
+#ifndef COMMANDLINERENDERER_H
+#define COMMANDLINERENDERER_H
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#include "processrenderpool.h"
+#include "renderjobpool.h"
+#include "tilecoordinator.h"
+
+/*
+ * Renders one region without a display server (the mandelbrot-cli executable),
+ * e.g. for benchmarks, batch renders and regression checks against the GUI
+ *
+ * mandelbrot-cli [--origin x,y] [--scale s] [--size WxH] [--type t] [--passes n]
+ *                [--threads n] [--processes n | --tile-workers n] [--verify] [-o out.png]
+ *                [--coordinator address:port [--min-workers n]] [--cancel-after ms]
+ *                [--segment-benchmark]
+ *
+ * The region is rendered by the job pool, with the kernel of the interactive
+ * renderer, then the time spent and the checksum of the image are written
+ * to stdout, and the image is saved when an output file is given. The render
+ * path of the GUI (RenderThread, with the thread mediator, the line cost
+ * partitioning, the progressive passes and focused tiles) is not used, so its
+ * timings are not those of the GUI
+ *
+ * With --processes the region is rendered by helper processes sharing the frame
+ * buffer instead, with --tile-workers by worker processes leasing its tiles from
+ * a tile coordinator (over the loopback interface). With --coordinator the
+ * coordinator listens on the given address instead, and the render starts once
+ * --min-workers workers (e.g. of other machines) connected. With --verify it is then
+ * rendered again by the job pool, and the exit code tells whether both checksums
+ * are the same
+ *
+ * With --cancel-after the render is cancelled after the given time instead,
+ * and the time from the cancellation until all workers left the job is written
+ *
+ * With --segment-benchmark nothing is rendered, the segment hand-offs of --threads
+ * threads are timed with and without a global lock (see runSegmentBenchmark)
+ */
+
+class CommandLineRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    CommandLineRenderer(RenderJobPool& jobPool, const RenderJobRequest& request,
+                        const QString& outputFile, QObject *parent = nullptr);
+    ~CommandLineRenderer() override;
+    CommandLineRenderer(const CommandLineRenderer&) = delete;
+    CommandLineRenderer(CommandLineRenderer&&) = delete;
+    CommandLineRenderer& operator=(const CommandLineRenderer&) = delete;
+    CommandLineRenderer& operator=(CommandLineRenderer&&) = delete;
+
+    void start();
+    void setCancelAfter(int milliseconds) { cancelAfterInMs = milliseconds; }
+    //renders in the helper processes of the pool rather than in the job pool
+    void setProcessPool(ProcessRenderPool* pool) { processPool = pool; }
+    //renders in the workers of the coordinator rather than in the job pool
+    void setTileCoordinator(TileCoordinator* coordinator) { tileCoordinator = coordinator; }
+    //the render starts once this number of workers connected to the coordinator
+    void setMinTileWorkers(int value) { minTileWorkers = value; }
+    void setVerified(bool value) { verified = value; }
+    int getExitCode() const { return exitCode; }
+
+    static int run(const QStringList& arguments);
+
+    static constexpr int DEFAULT_WIDTH = 800;
+    static constexpr int DEFAULT_HEIGHT = 600;
+    //the initial view of the GUI
+    static const char DEFAULT_ORIGIN_X[];
+    static const char DEFAULT_ORIGIN_Y[];
+    static constexpr double DEFAULT_SCALE = 0.00403897;
+    //per run of the segment benchmark
+    static constexpr qint64 SEGMENT_BENCHMARK_DURATION_IN_MS = 2000;
+
+    static constexpr int EXIT_SUCCESS_CODE = 0;
+    static constexpr int EXIT_BAD_ARGUMENTS = 2;
+    static constexpr int EXIT_RENDER_FAILED = 3;
+    static constexpr int EXIT_SAVE_FAILED = 4;
+    static constexpr int EXIT_CHECKSUM_MISMATCH = 5;
+
+private slots:
+    void tileWorkersChanged(int numWorkers);
+    void cancelRender();
+    void renderDone(int jobId, const QImage& image);
+    void renderCancelled(int jobId);
+    void offloadedRenderDone(const QImage& image);
+    void offloadedRenderCancelled();
+    void offloadedRenderFailed(const QString& reason);
+
+private:
+    static void runSegmentBenchmark(int numThreads);
+    void startRender();
+    bool renderIsOffloaded() const { return processPool != nullptr || tileCoordinator != nullptr; }
+    void printRenderPath() const;
+    void finishRender(const QImage& image);
+    void reportCancellation();
+    void verifyChecksum(const QImage& referenceImage);
+
+    RenderJobPool& jobPool;
+    ProcessRenderPool* processPool;
+    TileCoordinator* tileCoordinator;
+    const RenderJobRequest request;
+    const QString outputFile;
+    int jobId;
+    //the job pool render the image of another render path is compared with
+    int referenceJobId;
+    bool verified;
+    qint64 checksum;
+    int exitCode;
+    //no cancellation when negative
+    int cancelAfterInMs;
+    int minTileWorkers;
+    QElapsedTimer clock;
+    QElapsedTimer cancelClock;
+};
+
+#endif // COMMANDLINERENDERER_H
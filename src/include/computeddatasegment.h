@@ -1,7 +1,7 @@
 #ifndef COMPUTEDDATASEGMENT_H
 #define COMPUTEDDATASEGMENT_H
 
-#include <QVector>
+#include <atomic>
 #include "mandelbrotrenderer.h"
 #include "regionattributes.h"
 
@@ -9,11 +9,27 @@ QT_BEGIN_NAMESPACE
 class QImage;
 QT_END_NAMESPACE
 
-class QMutex;
+/*
+ * The parameters shared by all the tasks of a render job, owned by
+ * whoever launches the tasks and kept alive until all of them are done
+ */
+struct SharedTaskParameters
+{
+    int jobId;
+    RegionAttributes attributes;    // the complete region of the job
+    QImage *image;
+    MandelBrotRenderer::FrameBuffer frameBuffer;
+    MandelBrotRenderer::SampleGrid reusedSamples;   // not computed again by the tasks
+    MandelBrotRenderer::SampleGrid previewSamples;  // when set, the only pixels computed (each filling its block)
+};
 
 /*
  *A data object class containing compute task parameters
- * and containers for computed results
+ * and the frame buffer the computed results are written to
+ *
+ * Only the task and its results belong to the segment, the job parameters
+ * are referenced (they must not be accessed once the job is over, e.g. by
+ * the receiver of a queued copy of the segment)
 */
 
 class ComputedDataSegment
@@ -21,11 +37,9 @@ class ComputedDataSegment
 public:
     ComputedDataSegment();
 
-    explicit ComputedDataSegment(RegionAttributes attributes,
-                        QImage *image,
-                        int segmentIndex,
-                        MandelBrotRenderer::MQuintVector& bufferedResultData,
-                        const RegionAttributes& bufferedAttributes);
+    explicit ComputedDataSegment(const SharedTaskParameters& parameters,
+                        const MandelBrotRenderer::RenderTask& task,
+                        int segmentIndex);
 
     virtual ~ComputedDataSegment();
 
@@ -37,45 +51,53 @@ public:
 
     ComputedDataSegment& operator=(ComputedDataSegment&& other) noexcept;
 
-    double getScaleFactor() const { return attributes.getScaleFactor(); }
-    double getOriginX() const { return attributes.getOriginX(); }
-    double getOriginY() const { return attributes.getOriginY(); }
+    double getScaleFactor() const { return parameters->attributes.getScaleFactor(); }
+    double getOriginX() const { return parameters->attributes.getOriginX(); }
+    double getOriginY() const { return parameters->attributes.getOriginY(); }
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
-    QString getPreciseOriginX() const { return attributes.getPreciseOriginX(); }
-    QString getPreciseOriginY() const { return attributes.getPreciseOriginY(); }
+    const QString& getPreciseOriginX() const { return parameters->attributes.getPreciseOriginX(); }
+    const QString& getPreciseOriginY() const { return parameters->attributes.getPreciseOriginY(); }
 #endif
-    int getMinX() const { return attributes.getMinX(); }
-    int getMaxX() const { return attributes.getMaxX(); }
-    int getMinY() const { return attributes.getMinY(); }
-    int getMaxY() const { return attributes.getMaxY(); }
-    QImage * getImage() const { return image; }
-    int getFullHeight() const { return attributes.getFullHeight(); }
+    int getMinX() const { return task.minX; }
+    int getMaxX() const { return task.maxX; }
+    int getMinY() const { return task.minY; }
+    int getMaxY() const { return task.maxY; }
+    QImage * getImage() const { return parameters->image; }
+    int getFullHeight() const { return parameters->attributes.getFullHeight(); }
+    const MandelBrotRenderer::FrameBuffer& getFrameBuffer() const { return parameters->frameBuffer; }
     MandelBrotRenderer::ComputeTaskResults& getFullResultData() { return taskResults; }
-    MandelBrotRenderer::MQuintVector& getRawResultData() { return rawResultData; }
-    MandelBrotRenderer::MQuintVector&& extractRawResultData() { consumed = true; return std::move(rawResultData); }
-    void clearRawData();
+    void markConsumed() { consumed = true; }
+    void clearResults();
 
     int getSegmentIndex() const { return segmentIndex; }
     bool hasBeenUsed() const { return consumed; }
-    void clearSegmentIndex() { segmentIndex = MandelBrotRenderer::nonExistentThreadIndex; }
 
-    const RegionAttributes& getAttributes() const;
+    const SharedTaskParameters& getParameters() const { return *parameters; }
+    const MandelBrotRenderer::RenderTask& getTask() const { return task; }
+
+    void setTask(const MandelBrotRenderer::RenderTask& newTask);
 
-    void ChangeRegionAttributes(const RegionAttributes& newRegionAttributes);
+    static int getCopyCount();
+    static void resetCounters();
 
 private:
-    static QMutex* getMutex();
 
-    QImage *image;
-    int rawDataSize;
-    MandelBrotRenderer::MQuintVector rawResultData;
+    const SharedTaskParameters *parameters;
+    MandelBrotRenderer::RenderTask task;
     MandelBrotRenderer::ComputeTaskResults taskResults;
     int segmentIndex;
     bool consumed;
 
-    RegionAttributes attributes;
-
-    static int count;
+    static std::atomic<int> count;
+    static std::atomic<int> copyCount;
 };
 
+class CancellationToken;
+
+namespace MandelBrotRenderer
+{
+    //the kernel, as generated for a numeric type: computes one line of a segment
+    using computeFunction = std::function<void (const ComputedDataSegment &, const CancellationToken &, ComputeTaskResults &, int)>;
+}
+
 #endif // COMPUTEDDATASEGMENT_H
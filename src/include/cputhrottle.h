@@ -0,0 +1,80 @@
+#ifndef CPUTHROTTLE_H
+#define CPUTHROTTLE_H
+
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <thread>
+
+#include "pausegate.h"
+
+/*
+ * Keeps the renderer within a share of the machine's CPU time (background mode)
+ *
+ * The share is first met by capping the number of workers, the rest by a duty
+ * cycle: the gate is closed for part of every period, the workers check it
+ * alongside the pause gate and park while it's closed.
+ * Workers also run at the lowest scheduling priority (see BackgroundThreadPriority)
+ */
+
+class CpuThrottle
+{
+public:
+    CpuThrottle();
+    ~CpuThrottle();
+
+    CpuThrottle(const CpuThrottle&) = delete;
+    CpuThrottle& operator=(const CpuThrottle&) = delete;
+
+    void setLimit(bool enabled, int cpuSharePercent);
+    void setWorkerCount(int numWorkers);
+
+    bool isEnabled() const;
+    int getCpuSharePercent() const;
+    int limitWorkerCount(int numWorkers) const;
+    double getDutyCycle() const;
+
+    PauseGate& getGate() { return gate; }
+
+    static constexpr int DEFAULT_CPU_SHARE_PERCENT = 25;
+    static constexpr int DUTY_CYCLE_PERIOD_IN_MS = 100;
+
+private:
+    void run();
+    void updateDutyCycle();
+
+    PauseGate gate;
+
+    //the limit is set by the GUI thread, the duty cycle runs in its own thread
+    mutable QMutex mutex;
+    QWaitCondition changed;
+    bool enabled;
+    int cpuSharePercent;
+    int numWorkers;
+    double dutyCycle;
+    bool stopping;
+    std::thread cycleThread;
+};
+
+/*
+ * Lowers the scheduling priority of the calling thread for the lifetime
+ * of the object (SCHED_IDLE or the highest nice value on Linux, idle priority on Windows),
+ * the previous priority is restored on destruction on Windows only (see the destructor)
+ */
+
+class BackgroundThreadPriority
+{
+public:
+    explicit BackgroundThreadPriority(bool enabled);
+    ~BackgroundThreadPriority();
+
+    BackgroundThreadPriority(const BackgroundThreadPriority&) = delete;
+    BackgroundThreadPriority& operator=(const BackgroundThreadPriority&) = delete;
+
+private:
+    bool lowered;
+    //the thread priority before the idle priority (Windows)
+    int previousPriority;
+};
+
+#endif // CPUTHROTTLE_H
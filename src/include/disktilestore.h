@@ -0,0 +1,126 @@
+#ifndef DISKTILESTORE_H
+#define DISKTILESTORE_H
+
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tilecache.h"
+
+/*
+ * Persistent store of completely rendered tiles, kept across sessions
+ *
+ * Tiles are written in packs (one file per completed render, holding the
+ * tiles which were not stored yet), each pack starts with a compact index of
+ * the keys of its tiles. Packs are written to a temporary file which replaces
+ * the final file in one step (QSaveFile), so a crash while writing never leaves
+ * a partial pack behind (temporary files left by a crash are removed by the next
+ * writable open()). Packs are memory mapped read only, several processes
+ * can share a store, a store opened read only is never written to or trimmed.
+ *
+ * Once the packs exceed the size limit the least recently used ones are removed,
+ * the last use of a pack is kept as its modification time.
+ * Only used by the master render thread, so no locking
+ */
+
+class DiskTileStore
+{
+public:
+    DiskTileStore();
+    ~DiskTileStore();
+
+    DiskTileStore(const DiskTileStore&) = delete;
+    DiskTileStore& operator=(const DiskTileStore&) = delete;
+
+    bool open(const QString& directory, bool readOnly);
+    void close();
+    bool isOpen() const { return !directory.isEmpty(); }
+    bool isReadOnly() const { return readOnly; }
+    const QString& getDirectory() const { return directory; }
+
+    const uint* find(const TileKey& key);
+    bool contains(const TileKey& key) const;
+    bool storeTiles(const std::vector<std::pair<TileKey, const uint*>>& newTiles);
+
+    void setSizeLimit(qint64 bytes);
+    qint64 getSizeLimit() const { return sizeLimit; }
+    qint64 getUsedSize() const { return usedSize; }
+
+    static QString defaultDirectory();
+
+    static constexpr quint32 PACK_MAGIC = 0x3154434d;      // "MCT1"
+    static constexpr quint32 PACK_VERSION = 1;
+    static constexpr qint64 DEFAULT_SIZE_LIMIT_IN_BYTES = 1024LL * 1024 * 1024;
+    //older temporary pack files are left over by a crashed writer
+    static constexpr qint64 STALE_TEMPORARY_FILE_AGE_IN_MS = 10 * 60 * 1000;
+
+private:
+    struct PackHeader
+    {
+        quint32 magic;
+        quint32 version;
+        quint32 tileSizeInPixels;
+        quint32 tileCount;
+    };
+
+    //fixed size record of the pack index, followed by the pixels of all its tiles
+    struct TileRecord
+    {
+        double scaleFactor;
+        qint64 tileX;
+        qint64 tileY;
+        qint32 phaseX;
+        qint32 phaseY;
+        qint32 numericType;
+        quint32 maxIterations;
+        qint32 set;
+        qint32 colorMapSize;
+        quint64 offset;
+    };
+
+    struct Pack
+    {
+        std::unique_ptr<QFile> file;
+        const uchar* data;
+        qint64 size;
+        qint64 lastUsed;
+    };
+
+    using PackList = std::list<Pack>;
+
+    struct Location
+    {
+        PackList::iterator pack;
+        quint64 offset;
+    };
+
+    static void removeStaleTemporaryFiles(const QDir& storeDirectory);
+    bool loadPack(const QString& path, qint64 lastUsed);
+    void removePack(PackList::iterator pack);
+    void evictPacks();
+
+    static TileRecord toRecord(const TileKey& key, quint64 offset);
+    static TileKey fromRecord(const TileRecord& record);
+
+    QString directory;
+    bool readOnly;
+    qint64 sizeLimit;
+    qint64 usedSize;
+    quint32 packCount;
+
+    PackList packs;
+    std::unordered_map<TileKey, Location, TileKeyHash> index;
+
+    static constexpr qint64 PIXEL_DATA_ALIGNMENT = 64;
+    //the modification time of a pack is updated at most this often
+    static constexpr qint64 ACCESS_TIME_RESOLUTION_IN_MS = 60 * 1000;
+};
+
+#endif // DISKTILESTORE_H
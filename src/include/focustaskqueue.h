@@ -0,0 +1,53 @@
+#ifndef FOCUSTASKQUEUE_H
+#define FOCUSTASKQUEUE_H
+
+#include <QMutex>
+#include <QPoint>
+#include <QRect>
+
+#include <atomic>
+#include <vector>
+
+/*
+ * Tile queue for focused ("foveated") rendering
+ *
+ * The image area of a pass is cut into square tiles, which workers
+ * take in order of distance from a focus point (the mouse cursor, or the
+ * view centre). The focus point can be moved while the pass is running,
+ * the tiles still queued are then taken in the new order
+ *
+ * Coordinates are centred on the view, as used by RegionAttributes
+ */
+
+class FocusTaskQueue
+{
+public:
+    FocusTaskQueue() = default;
+    ~FocusTaskQueue() = default;
+    FocusTaskQueue(const FocusTaskQueue&) = delete;
+    FocusTaskQueue(FocusTaskQueue&&) = delete;
+    FocusTaskQueue& operator=(const FocusTaskQueue&) = delete;
+    FocusTaskQueue& operator=(FocusTaskQueue&&) = delete;
+
+    void prepare(const QRect& area);
+    void prepare(const std::vector<QRect>& areas);
+    void deactivate();
+    bool isActive() const { return active.load(); }
+
+    void setFocusPoint(const QPoint& point);
+    void resetFocusPoint() { setFocusPoint(QPoint(0, 0)); }
+
+    bool takeNextTile(QRect& tile);
+
+    static constexpr int TILE_SIZE_IN_PIXELS = 32;
+
+private:
+    void queueTiles(const QRect& area);
+
+    mutable QMutex mutex;
+    std::vector<QRect> queuedTiles;
+    QPoint focusPoint;
+    std::atomic<bool> active {false};
+};
+
+#endif // FOCUSTASKQUEUE_H
@@ -0,0 +1,57 @@
+#ifndef FRAMEBUDGET_H
+#define FRAMEBUDGET_H
+
+#include <QSize>
+
+#include <cstdint>
+#include <vector>
+
+#include "mandelbrotrenderer.h"
+
+/*
+ * Plans the preview of an interactive render so that it is shown within a
+ * frame time budget, using the cost per computed pixel measured for each
+ * pass during recent renders (of the same numeric type)
+ *
+ * The preview is made of the first passes of the render, computed on a
+ * coarser grid (one pixel out of sampleStride in each direction) when even
+ * the first pass wouldn't fit the budget at full resolution. The final pass
+ * follows straight away at full resolution.
+ * Only used by the master render thread, so no locking
+ */
+
+class FrameBudget
+{
+public:
+    struct Plan
+    {
+        int sampleStride;
+        int lastPreviewPass;    // -1 when the render isn't worth previewing
+    };
+
+    FrameBudget();
+
+    Plan plan(const QSize& size, int numPasses, MandelBrotRenderer::internalDataType numericType, int budgetInMs) const;
+    void recordPass(int pass, int sampleStride, const QSize& size, MandelBrotRenderer::internalDataType numericType,
+                    int64_t elapsedTimeInUs);
+    void reset();
+
+    static MandelBrotRenderer::SampleGrid createSampleGrid(const QSize& size, int sampleStride);
+
+    static constexpr Plan noPreview { 1, -1 };
+    static constexpr int DEFAULT_BUDGET_IN_MS = 33;
+    static constexpr int MAX_SAMPLE_STRIDE = 8;
+
+private:
+    double estimateCostInUs(int pass, int64_t computedPixels) const;
+    static int64_t countComputedPixels(const QSize& size, int sampleStride);
+
+    //mean cost per computed pixel of each pass (in ns), a negative value when not measured yet
+    std::vector<double> pixelCostsInNs;
+    MandelBrotRenderer::internalDataType measuredType;
+
+    //weight of the latest measurement in the running mean
+    static constexpr double MEASUREMENT_WEIGHT = 0.5;
+};
+
+#endif // FRAMEBUDGET_H
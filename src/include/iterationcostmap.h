@@ -0,0 +1,43 @@
+#ifndef ITERATIONCOSTMAP_H
+#define ITERATIONCOSTMAP_H
+
+#include <cstdint>
+#include <vector>
+
+/*
+ * Per pixel line record of the number of iterations spent
+ * by the kernel, used to estimate the cost of computing a range
+ * of pixel lines during the next pass
+ *
+ * Lines are addressed with the same (centred) y coordinates as
+ * used by RegionAttributes; lines which have not been measured
+ * are estimated using the mean cost of the measured lines
+ */
+
+class IterationCostMap
+{
+public:
+    IterationCostMap() = default;
+
+    void reset(int firstLine, int lastLine);
+    void recordLineCost(int y, int64_t iterations);
+    void finalizeMeasurements();
+
+    bool isUsable() const;
+    int64_t estimateCost(int fromY, int toY) const;
+    int findCostMidpoint(int fromY, int toY) const;
+    void balanceBoundaries(std::vector<int>& boundaries) const;
+
+    void swap(IterationCostMap& other) noexcept;
+
+private:
+    int64_t getLineCost(int y) const;
+
+    int firstLine {0};
+    std::vector<int64_t> lineCosts {};
+    int64_t meanLineCost {0};
+
+    static constexpr int64_t minimumLineCost = 1;
+};
+
+#endif // ITERATIONCOSTMAP_H
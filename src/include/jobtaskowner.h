@@ -0,0 +1,36 @@
+#ifndef JOBTASKOWNER_H
+#define JOBTASKOWNER_H
+
+#include <algorithm>
+
+#include "mandelbrotrenderer.h"
+
+/*
+ * The task owner of the kernel for a job rendered outside of the master
+ * render thread (the job pool, helper and tile worker processes): the final
+ * pass of the job's pass count is computed directly
+ */
+
+class JobTaskOwner
+{
+public:
+    JobTaskOwner(int numPasses, const MandelBrotRenderer::colorMapStore& colormap)
+        : pass(static_cast<uint>(std::max(numPasses, 1) - 1)),
+          colormap(colormap),
+          iterationColourScale(static_cast<double>(MandelBrotRenderer::calcMaxIterations(static_cast<uint>(std::max(numPasses, 1)))) /
+                               static_cast<double>(colormap.size()))
+    {
+    }
+
+    uint getPassValue() const { return pass; }
+    MandelBrotRenderer::setType getSetToGenerate() const { return MandelBrotRenderer::setType::mandelbrot; }
+    const MandelBrotRenderer::colorMapStore& getColormap() const { return colormap; }
+    double getIterationColourScale() const { return iterationColourScale; }
+
+private:
+    const uint pass;
+    const MandelBrotRenderer::colorMapStore colormap;
+    const double iterationColourScale;
+};
+
+#endif // JOBTASKOWNER_H
@@ -10,6 +10,8 @@
 
 #include <vector>
 #include <map>
+#include <atomic>
+#include <type_traits>
 
 #ifdef __GNUC__
 #include <quadmath.h>
@@ -27,7 +29,9 @@
 #include <boost/multiprecision/cpp_bin_float.hpp>
 #endif
 
-
+QT_BEGIN_NAMESPACE
+class QImage;
+QT_END_NAMESPACE
 
 namespace MandelBrotRenderer
 {
@@ -45,6 +49,9 @@ namespace MandelBrotRenderer
 
     enum class setType { mandelbrot = 0, julia = 1 };
 
+    //interactive renders pre-empt final quality ones, which are resumed later
+    enum class renderServiceClass { interactive = 0, final = 1 };
+
     using haltChecker   = std::function<bool(void)>;
     using atomicInt     = std::atomic<uint>;
     using MQuintVector  = QVector<uint>;
@@ -112,6 +119,20 @@ using PreciseFloatResult = std::pair<Float128, bool>;
     //using colorMapStore = MQuintVector;
     using colorMapStore = std::vector<uint>;
 
+    colorMapStore createColormap(int size);
+
+    //false for the types of the selector which are missing from this build
+    bool typeIsCompiledIn(internalDataType numericType);
+
+    //the iteration limit of the kernel in the given pass
+    inline uint calcMaxIterations(uint pass) { return ((1 << (2 * pass + 6)) + 32); }
+
+    //the default number of workers, leaving some hardware threads to the rest of the system
+    int calculateInitialNumThreads();
+
+    //compares the renders of the different render paths (and of different builds)
+    qint64 computeChecksum(const QImage& image);
+
 #ifdef _WIN32
     using std::enable_if_t;
 #else
@@ -125,6 +146,14 @@ using PreciseFloatResult = std::pair<Float128, bool>;
         return static_cast<std::underlying_type_t<E>>(enumerator);
     }
 
+    //atomically raise a recorded maximum (e.g. a worst case latency) to the given value
+    inline void storeMaximum(std::atomic<int64_t>& maximum, int64_t value)
+    {
+        int64_t currentMaximum = maximum.load();
+        while (value > currentMaximum && !maximum.compare_exchange_weak(currentMaximum, value)) {
+        }
+    }
+
     enum class boolDescriptionMode { on_off = 0, true_false = 1 };
 
     const QString& getBoolValueAsString(bool value, boolDescriptionMode mode = boolDescriptionMode::on_off);
@@ -138,6 +167,11 @@ using PreciseFloatResult = std::pair<Float128, bool>;
         int colorMapSize;
         internalDataType numericType;
         int64_t iterationSumCount;
+        bool focusedRenderingEnabled;
+        bool speculativeRenderingEnabled;
+        bool snappedZoomEnabled;
+        bool frameBudgetEnabled;
+        int frameBudgetInMs;
     };
 
     struct RenderState
@@ -161,9 +195,84 @@ using PreciseFloatResult = std::pair<Float128, bool>;
             internalDataType numericType;
     };
 
+    /*
+     * The pixel memory of a rendered image, resolved once by the owner of the image
+     * so that workers can write their (disjoint) pixel lines directly, using
+     * the same centred coordinates as RegionAttributes
+     */
+    struct FrameBuffer
+    {
+        uchar*  bits;
+        int     bytesPerLine;
+        int     originX;        // column of x == 0
+        int     originY;        // line of y == 0
+
+        uint* pixelAt(int x, int y) const
+        {
+            return reinterpret_cast<uint *>(bits + static_cast<std::ptrdiff_t>(y + originY) * bytesPerLine) + (x + originX);
+        }
+    };
+
+    FrameBuffer createFrameBuffer(QImage& image, int originX, int originY);
+
+    /*
+     * The pixel lines (or tile) a task computes for a render job, the parameters
+     * of the job are shared by all of its tasks, so splitting or handing over
+     * work only copies these few values (upper bounds are exclusive)
+     */
+    struct RenderTask
+    {
+        int minX;
+        int maxX;
+        int minY;
+        int maxY;
+        int jobId;
+
+        RenderTask linesBefore(int y) const
+        {
+            Q_ASSERT(y > minY && y < maxY);
+            return RenderTask { minX, maxX, minY, y, jobId };
+        }
+
+        RenderTask linesFrom(int y) const
+        {
+            Q_ASSERT(y > minY && y < maxY);
+            return RenderTask { minX, maxX, y, maxY, jobId };
+        }
+    };
+
+    static_assert(std::is_trivially_copyable<RenderTask>::value, "render tasks are copied between workers");
+
+    /*
+     * Pixels of a render which already hold their final value (taken over from a
+     * cached view), every step-th pixel of every step-th line of the area starting
+     * at (minX, minY), a step of 0 means there are none (upper bounds are exclusive)
+     */
+    struct SampleGrid
+    {
+        int step;
+        int minX;
+        int maxX;
+        int minY;
+        int maxY;
+
+        bool containsLine(int y) const
+        {
+            return step > 0 && y >= minY && y < maxY && (y - minY) % step == 0;
+        }
+
+        bool containsColumn(int x) const
+        {
+            return x >= minX && x < maxX && (x - minX) % step == 0;
+        }
+    };
+
+    static constexpr SampleGrid noReusedSamples { 0, 0, 0, 0, 0 };
+    static constexpr SampleGrid noPreviewSamples { 0, 0, 0, 0, 0 };
+
     struct ComputeTaskResults
     {
-        MQuintVector*   rawResultData;
+        FrameBuffer     frameBuffer;
         int64_t         iterationSum;
     };
 
@@ -60,6 +60,8 @@
 #include <QToolBar>
 
 #include <QPixmap>
+#include <QElapsedTimer>
+#include <QTimer>
 #include <QMainWindow>
 
 #include "mandelbrotrenderer.h"
@@ -68,6 +70,7 @@
 #include "settingshandler.h"
 #include "settingsuser.h"
 #include "RendererConfig.h"
+#include "pausegate.h"
 #include "RenderHistory.h"
 
 
@@ -102,16 +105,25 @@ public:
     const QPixmap& getPixmap() {return pixmap; }
 
     RendererConfig generateConfigData();
-    void enforceConfigData(RendererConfig& newConfigData);
+    void enforceConfigData(RendererConfig& newConfigData, bool refreshIfChanged = true);
+    void presentHistoryFrame(const QImage& frame, int numPasses, MandelBrotRenderer::internalDataType numericType, int colorMapSize);
 
-    QMutex* getMutex(std::size_t index) { return pauseMutexes[index]; }
+    PauseGate& getPauseGate() { return pauseGate; }
+    RenderThread& getRenderThread() { return thread; }
     bool getUnsavedChangesExist() const { return unsavedChangesExist; }
 
     void setUnsavedChangesExist(bool value) { unsavedChangesExist = value; }
 
     MandelBrotRenderer::internalDataType getNumericType() const { return numericType; }
 
-    QString computeDeltaWithHigherPrecision(QString& value, int deltaPixels, double currentScale);
+    static QString computeDeltaWithHigherPrecision(QString& value, int deltaPixels, double currentScale);
+
+    //the view changes performed by the keyboard and mouse wheel, also used to predict the next view
+    static constexpr double ZoomInFactor = 0.8;
+    static constexpr double ZoomOutFactor = 1 / ZoomInFactor;
+    static constexpr int ScrollStep = 20;
+
+    static double snapZoomFactor(double zoomFactor);
 
     /*
      * Get the edge values of the permitted region for manually entered parameters
@@ -169,6 +181,7 @@ private:
     void mousePressEvent(QMouseEvent *event) override;
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
+    void leaveEvent(QEvent *event) override;
 
     void processSettingUpdate(QSettings& settings) override;
     bool confirmOperation(const QString& message, const QString& informative, bool suggestSave = false);
@@ -180,10 +193,11 @@ private slots:
     void disableOptions();
     void showProgress();
     void hideProgress();
+    void submitRenderRequest();
 
 private:
     void setInternalDataType(MandelBrotRenderer::internalDataType);
-    void scroll(int deltaX, int deltaY);
+    void scroll(int deltaX, int deltaY, bool previewShown = false);
     void adjustProgressBar();
     void writeSettings();
     void closeEvent(QCloseEvent* event) override;
@@ -227,20 +241,32 @@ private:
     double curScale;
     double perPixelCoeff;
     void prepareProgressBar();
-    bool scaleHasChanged;
     bool renderInProgress;
     bool usingUndoRedo;
+    bool pendingRequestFromUndoRedo;
     MandelBrotRenderer::internalDataType numericType;
     MandelBrotRenderer::ListenerGroup coordinateUsers;
 
-    std::vector<QMutex*> pauseMutexes;
+    PauseGate pauseGate;
     std::atomic<bool> paused;
 
     std::unique_ptr<RenderHistory> historyLog;
     bool unsavedChangesExist;
 
+    //render requests arriving in a burst are coalesced, only the latest one is submitted
+    //(as an interactive render, the final render follows once the burst is over)
+    QTimer* renderRequestTimer;
+    QElapsedTimer lastRenderRequest;
+    QElapsedTimer lastRenderSubmission;
+    MandelBrotRenderer::renderServiceClass pendingServiceClass;
+    quint64 renderRequestsIssued;
+    quint64 renderRequestsExecuted;
+
     const MandelBrotRenderer::RegionLimits parameterSpace;
 
+    static const int kMinQuietPeriodInMs = 15;
+    static const int kMaxQuietPeriodInMs = 120;
+
     static const int kInitialWidth = 550;
     static const int kInitialHeight = 500;
     static const int kInitialPosCoord = 400;
@@ -254,8 +280,6 @@ private:
     void setupLayout();
     void setupLoggers();
 
-    void preparePauseLocks();
-
 public:
     static QString undefinedFloatString;
     static QString unInitializedFloatString;
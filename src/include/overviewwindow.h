@@ -0,0 +1,52 @@
+#ifndef OVERVIEWWINDOW_H
+#define OVERVIEWWINDOW_H
+
+#include <QImage>
+#include <QLabel>
+#include <QSize>
+#include <QString>
+
+class QShowEvent;
+class RenderThread;
+
+/*
+ * Shows the surroundings of the last completed view, OVERVIEW_ZOOM_FACTOR times
+ * zoomed out, with the view marked
+ *
+ * The overview is a job of the job pool of the render thread, with a weight of
+ * OVERVIEW_JOB_WEIGHT, so it takes a small share of the workers while the view
+ * is rendered (and all of them once it is done); it is only rendered while shown
+ */
+
+class OverviewWindow : public QLabel
+{
+    Q_OBJECT
+public:
+    explicit OverviewWindow(RenderThread* masterThread);
+
+public slots:
+    void setView(const QImage& image, const QString& originX, const QString& originY, double scaleFactor, int numPasses);
+
+private slots:
+    void overviewDone(int doneJobId, const QImage& image);
+
+private:
+    void showEvent(QShowEvent* event) override;
+    void renderOverview();
+
+    RenderThread* masterThread;
+    //the job of the overview being rendered, if any
+    int jobId;
+
+    QSize viewSize;
+    QString originX;
+    QString originY;
+    double scaleFactor;
+    int numPasses;
+
+    static constexpr int OVERVIEW_WIDTH = 320;
+    static constexpr int OVERVIEW_ZOOM_FACTOR = 8;
+    static constexpr uint OVERVIEW_JOB_WEIGHT = 1;
+};
+
+#endif // OVERVIEWWINDOW_H
@@ -0,0 +1,57 @@
+#ifndef PAUSEGATE_H
+#define PAUSEGATE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <cstdint>
+
+/*
+ * Pause/resume control shared by all worker threads
+ *
+ * Workers only perform an atomic load per pixel line to check
+ * whether the gate is closed, and only then park on a wait
+ * condition until the gate is opened again
+ *
+ * The worst case latency (over all workers) between closing the gate
+ * and a worker parking, and between opening it and a worker running
+ * again, is kept for reporting
+ */
+
+class PauseGate
+{
+public:
+    PauseGate() = default;
+    ~PauseGate() = default;
+    PauseGate(const PauseGate&) = delete;
+    PauseGate(PauseGate&&) = delete;
+    PauseGate& operator=(const PauseGate&) = delete;
+    PauseGate& operator=(PauseGate&&) = delete;
+
+    void close();
+    void open();
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+    void waitWhileClosed();
+
+    void recordChecks(int64_t numChecks) { checkCount += numChecks; }
+    void resetStatistics();
+    int64_t getMaxPauseLatencyInUs() const { return maxPauseLatencyInUs.load(); }
+    int64_t getMaxResumeLatencyInUs() const { return maxResumeLatencyInUs.load(); }
+    int64_t getCheckCount() const { return checkCount.load(); }
+
+private:
+    std::atomic<bool> closed {false};
+    QMutex mutex;
+    QWaitCondition opened;
+    QElapsedTimer transitionTimer;
+
+    std::atomic<int64_t> maxPauseLatencyInUs {0};
+    std::atomic<int64_t> maxResumeLatencyInUs {0};
+    std::atomic<int64_t> checkCount {0};
+
+    static constexpr int64_t NS_IN_ONE_US = 1000;
+};
+
+#endif // PAUSEGATE_H
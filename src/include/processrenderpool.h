@@ -0,0 +1,128 @@
+#ifndef PROCESSRENDERPOOL_H
+#define PROCESSRENDERPOOL_H
+
+#include <QImage>
+#include <QObject>
+#include <QProcess>
+#include <QSharedMemory>
+#include <QStringList>
+
+#include <atomic>
+#include <map>
+
+#include "renderjobpool.h"
+
+/*
+ * Renders a job in helper processes (this executable started with
+ * HELPER_ARGUMENT) cooperating on one frame buffer in shared memory
+ *
+ * The shared memory holds the job, the colormap, the frame buffer and a band
+ * table: a helper claims the next band of pixel lines by atomically advancing
+ * a counter, then marks the band as its own, and as done once written. No lock
+ * is taken, the atomics are lock free and so usable across processes.
+ *
+ * A helper crashing (e.g. with an experimental numeric type) only loses the bands
+ * it had claimed, they are handed out again to a replacement helper. The kernel
+ * and colouring are those of the job pool, so the image (and its checksum) is the
+ * same as rendered in process
+ */
+
+class ProcessRenderPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProcessRenderPool(int numHelperProcesses, QObject *parent = nullptr);
+    ~ProcessRenderPool() override;
+    ProcessRenderPool(const ProcessRenderPool&) = delete;
+    ProcessRenderPool(ProcessRenderPool&&) = delete;
+    ProcessRenderPool& operator=(const ProcessRenderPool&) = delete;
+    ProcessRenderPool& operator=(ProcessRenderPool&&) = delete;
+
+    bool render(const RenderJobRequest& request);
+    void cancel();
+    bool isBusy() const { return !helpers.empty(); }
+
+    int getNumHelperProcesses() const { return numHelperProcesses; }
+    int getHelperRestartCount() const { return helperRestartCount; }
+
+    static bool isHelperInvocation(int argc, char *argv[]);
+    static int runHelper(const QStringList& arguments);
+
+    static constexpr int LINES_PER_BAND = 8;
+    //replacements started for crashed helpers, per job
+    static constexpr int MAX_HELPER_RESTARTS = 4;
+    static constexpr int MAX_ORIGIN_LENGTH = 256;
+    static const char HELPER_ARGUMENT[];
+
+signals:
+    void jobDone(const QImage& image);
+    void jobCancelled();
+    void jobFailed(const QString& reason);
+
+private slots:
+    void helperFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void helperError(QProcess::ProcessError error);
+
+private:
+    struct SharedJobHeader
+    {
+        quint32 magic;
+        quint32 version;
+        std::atomic<int> nextBand;
+        std::atomic<int> cancelled;
+        qint32 minX;
+        qint32 maxX;
+        qint32 minY;
+        qint32 maxY;
+        qint32 fullHeight;
+        qint32 numPasses;
+        qint32 numericType;
+        qint32 colorMapSize;
+        qint32 numBands;
+        qint32 bytesPerLine;
+        double scaleFactor;
+        double originX;
+        double originY;
+        char preciseOriginX[MAX_ORIGIN_LENGTH];
+        char preciseOriginY[MAX_ORIGIN_LENGTH];
+    };
+
+    //owners in the band table
+    static constexpr qint32 BAND_FREE = 0;
+    static constexpr qint32 BAND_DONE = -1;
+
+    struct SharedJobLayout
+    {
+        SharedJobHeader* header;
+        std::atomic<qint32>* bandOwners;
+        uint* colormap;
+        uchar* pixels;
+    };
+
+    static int computeSharedSize(int numBands, int colorMapSize, int bytesPerLine, int height);
+    static SharedJobLayout mapLayout(void* data, int numBands, int colorMapSize);
+    static bool claimBand(const SharedJobLayout& layout, qint32 owner, int& band);
+
+    void startHelper();
+    void helperStopped(QProcess* helper, bool crashed, bool replaceable);
+    void releaseBands(qint32 owner);
+    void finishJob();
+
+    const int numHelperProcesses;
+    QSharedMemory sharedJob;
+    SharedJobLayout layout;
+    //helper processes of the running job, with their owner id in the band table
+    std::map<QProcess*, qint32> helpers;
+    qint32 nextOwnerId;
+    int jobCount;
+    int helperRestartCount;
+    int restartsLeft;
+    bool failed;
+
+    static constexpr quint32 JOB_MAGIC = 0x314a504d;      // "MPJ1"
+    static constexpr quint32 JOB_VERSION = 1;
+    static constexpr int PIXEL_DATA_ALIGNMENT = 64;
+};
+
+#endif // PROCESSRENDERPOOL_H
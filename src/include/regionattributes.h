@@ -36,8 +36,8 @@ public:
     double getOriginX() const;
     double getOriginY() const;
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
-    QString getPreciseOriginX() const;
-    QString getPreciseOriginY() const;
+    const QString& getPreciseOriginX() const;
+    const QString& getPreciseOriginY() const;
 #endif
     int getMinX() const;
     int getMaxX() const;
@@ -45,7 +45,7 @@ public:
     int getMaxY() const;
     int getFullHeight() const;
     int computeRawDataSize() const;
-    void adjustYValues(int currentYPos, bool isLowerHalf);
+    void splitYValuesAt(int newYBoundary, bool isLowerHalf);
 
 private:
     double scaleFactor;
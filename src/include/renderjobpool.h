@@ -0,0 +1,102 @@
+#ifndef RENDERJOBPOOL_H
+#define RENDERJOBPOOL_H
+
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "mandelbrotrenderer.h"
+#include "regionattributes.h"
+
+/*
+ * A region to be rendered by the job pool, with its own settings
+ */
+struct RenderJobRequest
+{
+    RegionAttributes attributes;
+    MandelBrotRenderer::internalDataType numericType;
+    int numPasses;
+    MandelBrotRenderer::colorMapStore colormap;
+    //relative share of the workers while other jobs are pending
+    uint weight;
+};
+
+/*
+ * Renders any number of jobs concurrently on one shared set of worker threads
+ * (e.g. an overview map or batch exports alongside the interactive view)
+ *
+ * Jobs are cut into bands of pixel lines; an idle worker takes the next band
+ * of the job with the lowest virtual time, which advances by the iterations
+ * spent on the job divided by its weight (weighted fair queueing), so every
+ * pending job progresses at a rate proportional to its weight
+ *
+ * Jobs compute the final pass of their pass count directly, the result is
+ * delivered with jobDone(), from a worker thread
+ *
+ * The interactive renderer (which keeps its own workers for its progressive
+ * passes) takes part in the queueing as the foreground work: its workers charge
+ * the iterations they spend, and while the foreground work is behind its share
+ * the jobs wait, so side jobs of the GUI (e.g. the overview map) take only
+ * their weighted share of the workers during a render and all of them otherwise
+ */
+
+class RenderJobPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit RenderJobPool(int numWorkerThreads, QObject *parent = nullptr);
+    ~RenderJobPool() override;
+    RenderJobPool(const RenderJobPool&) = delete;
+    RenderJobPool(RenderJobPool&&) = delete;
+    RenderJobPool& operator=(const RenderJobPool&) = delete;
+    RenderJobPool& operator=(RenderJobPool&&) = delete;
+
+    int submit(const RenderJobRequest& request);
+    void cancel(int jobId);
+
+    int getNumWorkerThreads() const { return numWorkerThreads; }
+    int getNumPendingJobs() const;
+
+    void beginForegroundWork(uint weight);
+    //called by the workers of the foreground work, without locking
+    void chargeForegroundWork(int64_t iterations) { foregroundVirtualTime += iterations / foregroundWeight.load(); }
+    void endForegroundWork();
+
+    static constexpr int LINES_PER_TASK = 8;
+    //the jobs waiting for the foreground work to take its share check again after this time
+    static constexpr int FOREGROUND_POLL_INTERVAL_IN_MS = 2;
+
+signals:
+    void jobDone(int jobId, const QImage& image);
+    void jobCancelled(int jobId);
+
+private:
+    class RenderJob;
+
+    void processTasks();
+    RenderJob* selectNextJob() const;
+    std::unique_ptr<RenderJob> removeJobIfFinished(RenderJob* job);
+    void publishFinishedJob(std::unique_ptr<RenderJob> job);
+
+    mutable QMutex mutex;
+    QWaitCondition taskAvailable;
+    std::map<int, std::unique_ptr<RenderJob>> jobs;
+    std::vector<std::thread> workers;
+    const int numWorkerThreads;
+    int nextJobId;
+    bool shuttingDown;
+    bool foregroundActive;
+    std::atomic<uint> foregroundWeight;
+    std::atomic<int64_t> foregroundVirtualTime;
+};
+
+#endif // RENDERJOBPOOL_H
@@ -62,6 +62,7 @@
 #include <QWaitCondition>
 
 #include <memory>
+#include <deque>
 #include <map>
 #include <array>
 #include <utility>
@@ -70,11 +71,21 @@ QT_BEGIN_NAMESPACE
 class QImage;
 QT_END_NAMESPACE
 
+#include "bufferarena.h"
 #include "computeddatasegment.h"
+#include "cputhrottle.h"
 #include "informationdisplay.h"
+#include "iterationcostmap.h"
+#include "cancellationtoken.h"
+#include "focustaskqueue.h"
+#include "framebudget.h"
+#include "viewcache.h"
 #include "mandelbrotrenderer.h"
 #include "regionattributes.h"
+#include "renderjobpool.h"
 #include "renderthreadmediator.h"
+#include "disktilestore.h"
+#include "tilecache.h"
 #include "settingsuser.h"
 #include "buttonuser.h"
 
@@ -108,10 +119,14 @@ public:
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
               const QString& preciseOriginX, const QString& preciseOriginY,
 #endif
-                double scaleFactor, QSize resultSize);
+                double scaleFactor, QSize resultSize,
+                MandelBrotRenderer::renderServiceClass serviceClass = MandelBrotRenderer::renderServiceClass::final);
+    void provideCachedView(const ViewCacheKey& key, const QImage& image);
 
     qint64      getElapsedTimeLastRun() const { return elapsedTimeLastRun; }
     int         getPassesDone() const { return passesDone; }
+    //time from the last cancellation until all workers were idle
+    int64_t     getCancelLatencyInUs() const { return cancellationToken.getMaxStopLatencyInUs(); }
     int         getNumWorkerThreads() const { return numWorkerThreads; }
     MandelBrotRenderer::internalDataType getInternalDataType() const;
 
@@ -129,12 +144,31 @@ public:
 
     RenderThreadMediator& getThreadMediator() { return threadMediator; }
 
+    const IterationCostMap& getLineCostEstimate() const { return lineCostEstimate; }
+    IterationCostMap& getLineCostRecorder() { return lineCostRecorder; }
+    FocusTaskQueue& getFocusTaskQueue() { return focusTaskQueue; }
+    CpuThrottle& getCpuThrottle() { return cpuThrottle; }
+    RenderJobPool& getJobPool() { return jobPool; }
+    const MandelBrotRenderer::colorMapStore& getColormap() const { return colormap; }
+    bool backgroundModeEnabled() const { return cpuThrottle.isEnabled(); }
+    bool speculativeRenderIsActive() const { return speculativeRenderActive; }
+    int getBackgroundCpuShare() const { return cpuThrottle.getCpuSharePercent(); }
+
+    bool claimWorkerRetirement();
+    void releaseWorkerSlot() { --activeWorkers; }
+    void returnUnfinishedLines(const MandelBrotRenderer::RenderTask& task);
+    bool takeReturnedLines(MandelBrotRenderer::RenderTask& task);
+    bool completedAreasRecorded() const { return recordingCompletedAreas; }
+    void recordCompletedArea(const QRect& area);
+    bool focusedRenderingEnabled() const { return rendererData.focusedRenderingEnabled; }
+    bool speculativeRenderingEnabled() const { return rendererData.speculativeRenderingEnabled; }
+    bool snappedZoomEnabled() const { return rendererData.snappedZoomEnabled; }
+    bool frameBudgetEnabled() const { return rendererData.frameBudgetEnabled; }
+
     SettingsHandler& getApplicationSettings() const { return applicationSettingsHandler; }
 
     void processIntegerValueFromButtonPress(int value) override;
 
-    static int calculateInitialNumThreads();
-
     const MandelBrotRenderer::RendererData& getRendererData() const;
 
     using typeNameUser = std::function<void (const QString&, bool) >;
@@ -142,13 +176,18 @@ public:
 public slots:
     void publishCoordinates() const;
     void cleanup();
-    void drawPreComputedData(ComputedDataSegment& data);
+    void acceptComputedSegment(ComputedDataSegment& data);
     void markThreadProgressComplete();
     void quitApplication();
     void haltComputations();
-    void clearBuffers();
     void setNumberOfPasses(int value);
     void publishDynamicTasksEnabled();
+    void setFocusedRenderingByState(int state);
+    void setSpeculativeRenderingByState(int state);
+    void setSnappedZoomByState(int state);
+    void setFrameBudgetByState(int state);
+    void setBackgroundModeByState(int state);
+    void setBackgroundCpuShare(int percent);
     void writeSettings();
     void pauseTimer();
     void stopTimer();
@@ -172,6 +211,7 @@ signals:
     void renderStarting();
     void chunkDone(int passesDone);
     void allDone();
+    void frameCompleted(const QImage& image, const QString& originX, const QString& originY, double scaleFactor, int numPasses);
     void numThreadsUpdate();
     void numPassesUpdate();
     void sendStatusMessage(const QString& message, bool isWarning = false, int timeout = 0);
@@ -183,6 +223,14 @@ private slots:
     void startTimer();
     void setNumberOfThreads(int value);
 private:
+    struct PassContext
+    {
+        ViewParameters view;
+        int pass;
+        int numPasses;
+        SharedTaskParameters parameters;
+    };
+
     void run() override;
     void connectUpOwner();
     void halt(bool quitApplication);
@@ -190,6 +238,30 @@ private:
     void adjustWorkerThreadCount();
     int adjustNumPasses();
     void releaseHelpers(std::vector<RenderWorker *>& helpers);
+    void prepareLineCostEstimate(int pass, int firstLine, int lastLine);
+    ViewParameters getRequestedView() const;
+    void acceptProvidedViews();
+    ViewCacheKey createViewCacheKey(const ViewParameters& view, int numPasses) const;
+    bool presentCachedView(const ViewParameters& view);
+    void queueSpeculativeViews(const ViewParameters& view);
+    void waitForNextRequest();
+    int takeFreeWorkerIndex();
+    bool launchWorker(std::vector<RenderWorker *>& helpers, PassContext& context, int minY, int maxY);
+    void waitForPassWorkers(std::vector<RenderWorker *>& helpers, PassContext* runningPass);
+    SharedTaskParameters createTaskParameters(ViewParameters& view, QImage& image);
+    bool reuseTranslatedView(const ViewCacheKey& key, const SharedTaskParameters& parameters, std::vector<QRect>& exposedAreas);
+    bool reuseZoomedSamples(const ViewCacheKey& key, SharedTaskParameters& parameters);
+    bool resumeSuspendedRender(const ViewCacheKey& key, const SharedTaskParameters& parameters,
+                               std::vector<QRect>& remainingAreas);
+    void suspendRender(const ViewCacheKey& key, const QImage& image);
+    bool reuseInteractivePreview(const ViewCacheKey& key, const SharedTaskParameters& parameters);
+    TileRenderSettings createTileRenderSettings(int numPasses) const;
+    bool restoreCachedTiles(const ViewParameters& view, int numPasses, const SharedTaskParameters& parameters,
+                            std::vector<QRect>& remainingAreas);
+    void storeCompletedTiles(const ViewParameters& view, int numPasses, const SharedTaskParameters& parameters);
+    void applyTileCacheSettings();
+    void addWorkersToRunningPass(std::vector<RenderWorker *>& helpers, PassContext& runningPass);
+    bool returnedLinesExist();
 
     void AddNumericTypeToSelector(const QString& description, MandelBrotRenderer::internalDataType dataType,
                                   typeNameUser& nameUser, bool enabled = true);
@@ -211,9 +283,6 @@ private:
     QButtonGroup* numPassesConfigurer;
     SettingsHandler& applicationSettingsHandler;
 
-    std::vector<MandelBrotRenderer::MQuintVector> bufferedResults;
-    std::vector<RegionAttributes> bufferedAttributes;
-
     struct supportedType
     {
         MandelBrotRenderer::internalDataType type;
@@ -248,8 +317,10 @@ private:
     double scaleFactor;
 
     QSize resultSize;
+    MandelBrotRenderer::renderServiceClass requestedServiceClass;
     bool restart;
     bool abort;
+    CancellationToken cancellationToken;
     const QImage * currentImage;
     int computationChunksDone;
     int colorMapSize;
@@ -259,16 +330,107 @@ private:
     int numWorkerThreads;
     QSemaphore* sem;
 
+    //a permit of sem is held by each worker launched for the current pass until it finishes
+    std::atomic<int> launchedWorkers;
+    std::atomic<int> activeWorkers;
+    //follows the thread slider immediately, the running pass grows or shrinks to match it
+    std::atomic<int> targetNumWorkerThreads;
+    int appliedNumWorkerThreads;
+    //indices held by launched workers until they are cleaned up
+    std::array<bool, MandelBrotRenderer::MAX_NUM_WORKER_THREADS> workerIndexInUse {};
+    int progressChunkLimit;
+    //identifies the shared task parameters of each render
+    int renderJobCount;
+
+    //lines handed back by workers retired during a pass
+    QMutex returnedLinesMutex;
+    std::vector<MandelBrotRenderer::RenderTask> returnedLines;
+
+    //areas of the final pass completed so far, kept when the render is pre-empted
+    QMutex completedAreasMutex;
+    std::vector<QRect> completedAreas;
+    std::atomic<bool> recordingCompletedAreas;
+
     MandelBrotRenderer::RendererData rendererData;
     RenderThreadMediator threadMediator;
 
+    //iteration costs measured during the previous pass (read only while workers run) and the current pass
+    IterationCostMap lineCostEstimate;
+    IterationCostMap lineCostRecorder;
+
+    FocusTaskQueue focusTaskQueue;
+
+    //pixel buffers of the rendered images, declared before any member holding such an image
+    BufferArena frameArena;
+
+    //background mode: limits the share of the CPU used by the workers
+    CpuThrottle cpuThrottle;
+
+    //measured pass costs, which decide how interactive renders are previewed within the frame time budget
+    FrameBudget frameBudget;
+
+    //completed renders, and the views likely to be requested next which are rendered while idle
+    ViewCache viewCache;
+    //completed tiles of the plane, reused by any render covering them (also across sessions when stored on disk)
+    DiskTileStore diskTileStore;
+    TileCache tileCache;
+
+    struct TileCacheSettings
+    {
+        int memorySizeInMB;
+        bool diskStoreEnabled;
+        QString diskStoreDirectory;
+        bool diskStoreReadOnly;
+        int diskStoreSizeInMB;
+    };
+
+    //written by processSettingUpdate(), applied by the master thread before a render (mutex protected)
+    TileCacheSettings tileCacheSettings;
+    bool tileCacheSettingsChanged;
+    std::deque<ViewParameters> speculativeViews;
+    //images rendered earlier (kept by the render history) for views about to be requested, mutex protected
+    std::vector<std::pair<ViewCacheKey, CachedView>> providedViews;
+    std::atomic<bool> speculativeRenderActive;
+    CachedView cachedView;
+
+    struct SuspendedRender
+    {
+        ViewCacheKey key;
+        QImage image;
+        std::vector<QRect> completedAreas;
+    };
+
+    //the final render last pre-empted (by an interactive request), and the last interactive render
+    SuspendedRender suspendedRender;
+    std::pair<ViewCacheKey, QImage> interactivePreview;
+
+    //renders the side jobs of the GUI (e.g. the overview map), sharing the workers with the view by weight
+    RenderJobPool jobPool;
+
     WindowThreadInfo* displayer;
     MandelBrotRenderer::colorMapStore colormap {};
 
     static constexpr int PROGRESS_BAR_WAIT_IN_MS = 200;
+    static constexpr int WORKER_COUNT_POLL_INTERVAL_IN_MS = 20;
     static constexpr int REQUESTED_TIMER_TICKS_PER_SECOND = InformationDisplay::getRequiredTimerTicksPerSecond();
     static constexpr int MS_IN_ONE_SEC = 1000;
     static constexpr bool threadReallocationDefaultEnabled = true;
+    static constexpr bool focusedRenderingDefaultEnabled = false;
+    static constexpr bool speculativeRenderingDefaultEnabled = false;
+    //speculative renders are idle work, they run at background priority on at most this many workers
+    static constexpr int MAX_SPECULATIVE_WORKER_THREADS = 2;
+    //shares of the view renders when competing with the jobs of the job pool
+    static constexpr uint VIEW_RENDER_WEIGHT = 4;
+    static constexpr uint SPECULATIVE_RENDER_WEIGHT = 1;
+    static constexpr bool hugePageBuffersDefaultEnabled = false;
+    static constexpr bool snappedZoomDefaultEnabled = false;
+    static constexpr bool frameBudgetDefaultEnabled = false;
+    static constexpr bool backgroundModeDefaultEnabled = false;
+    //interactive renders compute one pixel of each block of INTERACTIVE_SAMPLE_STRIDE x INTERACTIVE_SAMPLE_STRIDE
+    static constexpr int INTERACTIVE_SAMPLE_STRIDE = 4;
+    static constexpr int tileCacheDefaultSizeInMB = static_cast<int>(TileCache::DEFAULT_MEMORY_BUDGET_IN_BYTES / (1024 * 1024));
+    static constexpr bool diskTileCacheDefaultEnabled = false;
+    static constexpr int diskTileCacheDefaultSizeInMB = static_cast<int>(DiskTileStore::DEFAULT_SIZE_LIMIT_IN_BYTES / (1024 * 1024));
 
     static int count;
     void populateColorMap();
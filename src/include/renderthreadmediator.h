@@ -3,6 +3,7 @@
 
 #include <QMutex>
 #include <QObject>
+#include <QWaitCondition>
 
 #include "computeddatasegment.h"
 #include "mandelbrotrenderer.h"
@@ -42,21 +43,17 @@ public:
     void processThreadGoesIdle(int threadIndex);
     bool performDynamicThreadOperation(RenderWorker* workerThread, MandelBrotRenderer::dynamicThreadAction taskType);
 
-    void cacheComputeSegmentForSharing(const ComputedDataSegment& newTaskSegment);
+    void cacheTaskForSharing(const MandelBrotRenderer::RenderTask& newTask);
     bool computeSegmentsAreReadyForSharing() const;
 
-    ComputedDataSegment& getNewTaskSegment();
-    void clearNewTaskSegment();
+    MandelBrotRenderer::RenderTask takeNewTask();
+    void clearNewTask();
 
     void incrementBusyThreadCount() {
         ++busyThreadCount;
         //std::cout << "threadCount++ ->  " << busyThreadCount << std::endl;
     }
-    void decrementBusyThreadCount() {
-        --busyThreadCount;
-        //std::cout << "threadCount-- ->  " << busyThreadCount << std::endl;
-        Q_ASSERT(busyThreadCount.load() >= 0);
-    }
+    void decrementBusyThreadCount();
     bool BusyThreadsExist() const { return busyThreadCount.load() > 0; }
     int getBusyThreadCount() const { return busyThreadCount.load(); }
 
@@ -68,6 +65,10 @@ public:
 
     void setThreadDone(uint threadIndex);
 
+    void resetWaitStatistics();
+    int64_t getWakeupCount() const { return wakeupCount.load(); }
+    int64_t getWaitTimeInMs() const { return waitTimeInNs.load() / NS_IN_ONE_MS; }
+
 public slots:
     void setEnabledByState(int state);
 
@@ -82,6 +83,8 @@ private:
     std::atomic<bool> requestUnderway;
 
     mutable QMutex mutex;
+    //idle threads waiting for a shared task are parked here (using the above mutex)
+    QWaitCondition taskAvailable;
 
     std::atomic<int> readyThreadIndex;
     std::array<int, MandelBrotRenderer::MAX_NUM_WORKER_THREADS> waitingThreads {};
@@ -90,9 +93,15 @@ private:
     std::atomic<int> busyThreadCount;
     std::atomic<int> waitingThreadCount;
 
-    ComputedDataSegment segmentsForSharing;
+    MandelBrotRenderer::RenderTask taskForSharing;
     std::atomic<int> sharedSegmentCount;
 
+    std::atomic<int64_t> wakeupCount;
+    std::atomic<int64_t> waitTimeInNs;
+
+    //safety net only, waiting threads are normally woken explicitly
+    static constexpr unsigned long MAX_WAIT_FOR_TASK_IN_MS = 50;
+    static constexpr int64_t NS_IN_ONE_MS = 1000000;
 };
 
 #endif // RENDERTHREADMEDIATOR_H
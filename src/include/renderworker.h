@@ -8,6 +8,8 @@
 #include "computeddatasegment.h"
 #include "workerthreaddata.h"
 #include "mandelbrotrenderer.h"
+#include "pausegate.h"
+#include "cancellationtoken.h"
 
 
 QT_BEGIN_NAMESPACE
@@ -30,11 +32,11 @@ public:
                        uint finalPassValue,
                        MandelBrotRenderer::colorMapStore& colormap,
                        bool restart,
-                       const bool& abort,
+                       const CancellationToken& cancellation,
                        int threadIndex,
                        ComputedDataSegment&& segment,
                        MandelBrotRenderer::haltChecker abortChecker,
-                       QMutex&  pauseMutex);
+                       PauseGate& pauseGate);
 
     ~RenderWorker() override = default;
     RenderWorker(const RenderWorker&) = delete;
@@ -42,7 +44,7 @@ public:
     RenderWorker& operator=(const RenderWorker&) = delete;
     RenderWorker& operator=(RenderWorker&&) = delete;
 
-    using computeFunction = std::function<void (const ComputedDataSegment &, const bool &, int &, MandelBrotRenderer::ComputeTaskResults &, int)>;
+    using computeFunction = MandelBrotRenderer::computeFunction;
 
     uint getPassValue() const { return pass; }
 
@@ -54,12 +56,10 @@ public:
 
     int getThreadIndex() const;
 
-    void setSegment(const ComputedDataSegment &value);
+    void setTask(const MandelBrotRenderer::RenderTask& task);
     void publishState(MandelBrotRenderer::threadState state);
     void shareTask();
 
-    static uint calcMaxIterations(uint pass) { return ((1 << (2 * pass + 6)) + 32); }
-
     MandelBrotRenderer::setType getSetToGenerate() const;
 
     MandelBrotRenderer::colorMapStore &getColormap() const;
@@ -83,11 +83,13 @@ private:
     std::future<bool> result;
 
     bool execute(const computeFunction& computeTask);
+    bool executeFocusedTasks(const computeFunction& computeTask);
 
     bool getComputeResult() ;
 
-    template <typename T>
-    bool executeTask();
+    bool retireIfRequested();
+    void handBackRemainingLines(int y);
+    bool takeReturnedLines();
 
     uint pass;
     const uint finalPassValue;
@@ -97,7 +99,7 @@ private:
     MandelBrotRenderer::colorMapStore& colormap;
 
     bool restart;
-    const bool& abort;
+    const CancellationToken& cancellation;
     int threadIndex;
     ComputedDataSegment segment;
 
@@ -105,11 +107,14 @@ private:
 
     QMutex mutex;
     QMutex GUImutex;
-    QMutex& pauseMutex;
+    PauseGate& pauseGate;
+    //closed for part of each period in background mode
+    PauseGate& throttleGate;
 
     int pointsDone;
     bool cleanedUp;
     bool computationCompleted;
+    bool retired;
 
     MandelBrotRenderer::setType setToGenerate;
 
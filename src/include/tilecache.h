@@ -0,0 +1,113 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QRect>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "focustaskqueue.h"
+#include "mandelbrotrenderer.h"
+#include "viewcache.h"
+
+/*
+ * Position of a view on the pixel grid of its scale: the centred pixel (0, 0)
+ * of the view is the pixel (indexX, indexY) of a grid covering the whole plane,
+ * the phase is the (quantized) offset of the view's samples from that grid
+ */
+struct TileGrid
+{
+    double scaleFactor;
+    int64_t indexX;
+    int64_t indexY;
+    int phaseX;
+    int phaseY;
+};
+
+/*
+ * The render settings which affect the pixel values of a tile
+ */
+struct TileRenderSettings
+{
+    MandelBrotRenderer::internalDataType numericType;
+    uint maxIterations;
+    MandelBrotRenderer::setType set;
+    int colorMapSize;
+};
+
+struct TileKey
+{
+    double scaleFactor;
+    int phaseX;
+    int phaseY;
+    int64_t tileX;
+    int64_t tileY;
+    TileRenderSettings settings;
+
+    bool operator==(const TileKey& other) const;
+};
+
+struct TileKeyHash
+{
+    std::size_t operator()(const TileKey& key) const noexcept;
+};
+
+class DiskTileStore;
+
+/*
+ * Cache of completely rendered square tiles of the plane (least recently used
+ * tiles are dropped first once the memory budget is exceeded)
+ *
+ * The tiles are aligned on the pixel grid of the scale rather than on the views,
+ * so any later render at the same scale and phase reuses the tiles it covers,
+ * whatever its size and however its work is split among the workers.
+ * Tiles missing from memory are looked up in the backing store (when set),
+ * which receives all the new tiles.
+ * Only used by the master render thread, so no locking
+ */
+
+class TileCache
+{
+public:
+    explicit TileCache(std::size_t memoryBudgetInBytes = DEFAULT_MEMORY_BUDGET_IN_BYTES);
+
+    static bool locateGrid(const ViewParameters& view, TileGrid& grid);
+
+    int restoreTiles(const TileGrid& grid, const TileRenderSettings& settings, const QRect& area,
+                     const MandelBrotRenderer::FrameBuffer& frameBuffer, std::vector<QRect>& remainingAreas);
+    int storeTiles(const TileGrid& grid, const TileRenderSettings& settings, const QRect& area,
+                   const MandelBrotRenderer::FrameBuffer& frameBuffer);
+
+    void setBackingStore(DiskTileStore* store) { backingStore = store; }
+
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t getMemoryBudget() const { return memoryBudget; }
+    std::size_t getUsedMemory() const { return usedMemory; }
+    void clear();
+
+    static constexpr int TILE_SIZE_IN_PIXELS = FocusTaskQueue::TILE_SIZE_IN_PIXELS;
+    static constexpr std::size_t TILE_SIZE_IN_BYTES = TILE_SIZE_IN_PIXELS * TILE_SIZE_IN_PIXELS * sizeof(uint);
+    static constexpr std::size_t DEFAULT_MEMORY_BUDGET_IN_BYTES = 64 * 1024 * 1024;
+    //samples closer than this to those of a cached tile are considered the same
+    static constexpr int PHASES_PER_PIXEL = 100;
+
+private:
+    using TilePixels = std::vector<uint>;
+    using TileList = std::list<std::pair<TileKey, TilePixels>>;
+
+    template <typename Function> static void forEachTile(const TileGrid& grid, const QRect& area, Function function);
+    TilePixels& insertTile(const TileKey& key);
+    void evictTiles();
+
+    TileList tiles;
+    std::unordered_map<TileKey, TileList::iterator, TileKeyHash> index;
+    std::size_t memoryBudget;
+    std::size_t usedMemory;
+    DiskTileStore* backingStore;
+};
+
+#endif // TILECACHE_H
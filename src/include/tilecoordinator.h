@@ -0,0 +1,142 @@
+#ifndef TILECOORDINATOR_H
+#define TILECOORDINATOR_H
+
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QImage>
+#include <QObject>
+#include <QProcess>
+#include <QTcpServer>
+#include <QTimer>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "renderjobpool.h"
+#include "tileprotocol.h"
+
+QT_BEGIN_NAMESPACE
+class QTcpSocket;
+QT_END_NAMESPACE
+
+/*
+ * Spreads the tiles of a job over worker processes, possibly on other machines
+ * (this executable started with TileWorker::WORKER_ARGUMENT), over TCP
+ *
+ * Each tile is handed out as a lease, a worker holds up to LEASES_PER_WORKER
+ * leases at a time so it always has the next tile at hand. The worker computes
+ * its leases in order, the clock of a lease starts once the previous one is
+ * returned. A lease not returned within LEASE_DURATION_IN_MS from then, or held
+ * by a worker which disconnects, expires and its tile is handed out again; the
+ * first result received for a tile is kept.
+ *
+ * The coordinator listens on the loopback interface unless another address
+ * is given, e.g. QHostAddress::Any for the workers of other machines, which
+ * connect whenever they are started (see workersChanged()). Local workers may
+ * be started as well, e.g. to compare the image with the one rendered in process
+ *
+ * A job fails once all local workers stopped with no other worker connected,
+ * or when no worker is connected for NO_WORKER_TIMEOUT_IN_MS
+ */
+
+class TileCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TileCoordinator(QObject *parent = nullptr);
+    ~TileCoordinator() override;
+    TileCoordinator(const TileCoordinator&) = delete;
+    TileCoordinator(TileCoordinator&&) = delete;
+    TileCoordinator& operator=(const TileCoordinator&) = delete;
+    TileCoordinator& operator=(TileCoordinator&&) = delete;
+
+    bool listen(const QHostAddress& address = QHostAddress::LocalHost, quint16 port = 0);
+    quint16 getPort() const { return server.serverPort(); }
+    int startLocalWorkers(int count);
+
+    bool render(const RenderJobRequest& request);
+    void cancel();
+    bool isBusy() const { return jobActive; }
+
+    int getNumWorkers() const { return static_cast<int>(workers.size()); }
+    int getReissuedLeaseCount() const { return reissuedLeaseCount; }
+
+    static constexpr int TILE_SIZE_IN_PIXELS = 128;
+    static constexpr int LEASES_PER_WORKER = 2;
+    static constexpr int LEASE_DURATION_IN_MS = 10000;
+    static constexpr int LEASE_CHECK_INTERVAL_IN_MS = 500;
+    static constexpr int NO_WORKER_TIMEOUT_IN_MS = 30000;
+    static constexpr int WORKER_START_TIMEOUT_IN_MS = 5000;
+
+signals:
+    void jobDone(const QImage& image);
+    void jobCancelled();
+    void jobFailed(const QString& reason);
+    //a worker said hello or disconnected
+    void workersChanged(int numWorkers);
+
+private slots:
+    void acceptWorkers();
+    void readFromWorker();
+    void workerDisconnected();
+    void localWorkerFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void localWorkerError(QProcess::ProcessError error);
+    void expireLeases();
+
+private:
+    struct Tile
+    {
+        MandelBrotRenderer::RenderTask area;
+        bool done;
+    };
+
+    struct Lease
+    {
+        int tile;
+        QTcpSocket* worker;
+        //negative while queued behind another lease of the worker
+        qint64 expiresAt;
+    };
+
+    void processMessage(QTcpSocket* worker, TileProtocol::messageType type, const QByteArray& payload);
+    void grantLeases(QTcpSocket* worker);
+    void grantLeasesToAll();
+    void startNextLease(QTcpSocket* worker);
+    void storeTile(const TileProtocol::TileResult& tile);
+    void revokeLease(std::map<quint32, Lease>::iterator lease);
+    void localWorkerStopped(QProcess* worker);
+    void failJobWithoutWorkers();
+    void endJob();
+
+    QTcpServer server;
+    //connected sockets, those which said hello are workers
+    std::vector<QTcpSocket*> connections;
+    std::vector<QTcpSocket*> workers;
+    //the local workers still running
+    std::vector<QProcess*> localWorkers;
+    bool localWorkersStarted;
+
+    bool jobActive;
+    quint32 jobId;
+    QByteArray jobMessage;
+    QImage image;
+    int imageMinX;
+    int imageMinY;
+    int tileColumns;
+    std::vector<Tile> tiles;
+    //tiles not leased, expired leases are handed out first
+    std::deque<int> pendingTiles;
+    std::map<quint32, Lease> leases;
+    quint32 nextLeaseId;
+    int tilesDone;
+    int reissuedLeaseCount;
+    //negative while a worker is connected
+    qint64 noWorkerSince;
+
+    QTimer leaseTimer;
+    QElapsedTimer clock;
+};
+
+#endif // TILECOORDINATOR_H
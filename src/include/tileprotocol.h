@@ -0,0 +1,61 @@
+#ifndef TILEPROTOCOL_H
+#define TILEPROTOCOL_H
+
+#include <QByteArray>
+#include <QIODevice>
+
+#include "mandelbrotrenderer.h"
+#include "renderjobpool.h"
+
+/*
+ * Messages exchanged between a tile coordinator and its worker processes
+ *
+ * Each message is framed by its length (quint32, not counting itself) and
+ * its type (quint8), the rest is a QDataStream payload:
+ *  - hello (worker): protocol version
+ *  - job (coordinator): job id and the job to render
+ *  - lease (coordinator): job id, lease id and the tile (pixel area) to render
+ *  - tile (worker): job id, lease id, the tile and its pixels
+ */
+
+namespace TileProtocol
+{
+    enum class messageType : quint8 { hello = 1, job = 2, lease = 3, tile = 4 };
+
+    struct Lease
+    {
+        quint32 jobId;
+        quint32 leaseId;
+        MandelBrotRenderer::RenderTask area;
+    };
+
+    struct TileResult
+    {
+        quint32 jobId;
+        quint32 leaseId;
+        MandelBrotRenderer::RenderTask area;
+        QByteArray pixels;      // the lines of the tile, RGB32
+    };
+
+    void sendMessage(QIODevice& device, messageType type, const QByteArray& payload);
+    bool receiveMessage(QIODevice& device, messageType& type, QByteArray& payload, bool& invalid);
+
+    QByteArray encodeHello();
+    bool decodeHello(const QByteArray& payload);
+
+    QByteArray encodeJob(quint32 jobId, const RenderJobRequest& request);
+    bool decodeJob(const QByteArray& payload, quint32& jobId, RenderJobRequest& request);
+
+    QByteArray encodeLease(const Lease& lease);
+    bool decodeLease(const QByteArray& payload, Lease& lease);
+
+    QByteArray encodeTile(const TileResult& tile);
+    bool decodeTile(const QByteArray& payload, TileResult& tile);
+
+    constexpr quint32 PROTOCOL_VERSION = 1;
+    //larger messages are a protocol error, a tile of MAX_TILE_SIZE_IN_PIXELS fits
+    constexpr quint32 MAX_MESSAGE_SIZE = 16 * 1024 * 1024;
+    constexpr int MAX_TILE_SIZE_IN_PIXELS = 1024;
+}
+
+#endif // TILEPROTOCOL_H
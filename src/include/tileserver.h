@@ -0,0 +1,125 @@
+#ifndef TILESERVER_H
+#define TILESERVER_H
+
+#include <QByteArray>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "mandelbrotrenderer.h"
+
+class RenderJobPool;
+
+QT_BEGIN_NAMESPACE
+class QTcpSocket;
+QT_END_NAMESPACE
+
+/*
+ * Serves rendered tiles over HTTP on localhost, for slippy map viewers
+ * (a minimal one, without external scripts, is served at /) and other tools
+ *
+ * GET /tiles/{z}/{x}/{y}.png[?type={numeric type}&passes={pass count}]
+ * At zoom z the plane square [PLANE_MIN_X, PLANE_MIN_X + PLANE_SIZE] x
+ * [PLANE_MIN_Y, PLANE_MIN_Y + PLANE_SIZE] is split in 2^z x 2^z tiles,
+ * x grows with the real part and y with the imaginary part.
+ *
+ * Tiles are rendered by the job pool, so requests in flight share its workers;
+ * identical requests share one job, which is cancelled once all of its clients
+ * have disconnected. Encoded tiles are kept in a least recently used cache.
+ * Each connection carries one request
+ */
+
+class TileServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TileServer(RenderJobPool& jobPool, QObject *parent = nullptr);
+    ~TileServer() override;
+    TileServer(const TileServer&) = delete;
+    TileServer(TileServer&&) = delete;
+    TileServer& operator=(const TileServer&) = delete;
+    TileServer& operator=(TileServer&&) = delete;
+
+    bool listen(quint16 port = DEFAULT_PORT);
+    quint16 getPort() const { return server.serverPort(); }
+
+    void setCacheSize(std::size_t bytes);
+    std::size_t getCachedBytes() const { return cachedBytes; }
+
+    static bool isServerInvocation(int argc, char *argv[]);
+    static int runServer(const QStringList& arguments);
+
+    static const char SERVER_ARGUMENT[];
+    static constexpr quint16 DEFAULT_PORT = 8765;
+    static constexpr int TILE_SIZE_IN_PIXELS = 256;
+    static constexpr int MAX_ZOOM = 40;
+    static constexpr double PLANE_MIN_X = -2.5;
+    static constexpr double PLANE_MIN_Y = -2.0;
+    static constexpr double PLANE_SIZE = 4.0;
+    static constexpr std::size_t DEFAULT_CACHE_SIZE_IN_BYTES = 64 * 1024 * 1024;
+
+private slots:
+    void acceptConnections();
+    void readRequest();
+    void connectionClosed();
+    void tileRendered(int jobId, const QImage& image);
+    void tileCancelled(int jobId);
+
+private:
+    struct TileRequest
+    {
+        int zoom;
+        qint64 x;
+        qint64 y;
+        MandelBrotRenderer::internalDataType numericType;
+        int numPasses;
+
+        QString toKey() const;
+    };
+
+    //the clients waiting for a tile being rendered
+    struct PendingTile
+    {
+        QString key;
+        std::vector<QTcpSocket*> clients;
+    };
+
+    using CachedTile = std::pair<QString, QByteArray>;
+    using CachedTileList = std::list<CachedTile>;
+
+    void processRequest(QTcpSocket* client, const QByteArray& requestLine);
+    bool parseTileRequest(const QString& path, const QString& query, TileRequest& request) const;
+    void requestTile(QTcpSocket* client, const TileRequest& request);
+    void respond(QTcpSocket* client, int status, const QByteArray& reason,
+                 const QByteArray& contentType, const QByteArray& body);
+    void storeInCache(const QString& key, const QByteArray& tile);
+    void evictTiles();
+
+    static QByteArray viewerPage();
+
+    RenderJobPool& jobPool;
+    QTcpServer server;
+    const MandelBrotRenderer::colorMapStore colormap;
+
+    std::map<QTcpSocket*, QByteArray> requestBuffers;
+    std::map<int, PendingTile> pendingTiles;
+    std::map<QString, int> pendingJobs;
+    std::map<QTcpSocket*, int> clientJobs;
+
+    CachedTileList cachedTiles;
+    std::map<QString, CachedTileList::iterator> cacheIndex;
+    std::size_t cacheSize;
+    std::size_t cachedBytes;
+
+    static constexpr int MAX_REQUEST_HEADER_SIZE = 8192;
+};
+
+#endif // TILESERVER_H
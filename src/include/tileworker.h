@@ -0,0 +1,61 @@
+#ifndef TILEWORKER_H
+#define TILEWORKER_H
+
+#include <QObject>
+#include <QTcpSocket>
+
+#include <deque>
+#include <memory>
+
+#include "computeddatasegment.h"
+#include "tileprotocol.h"
+
+class JobTaskOwner;
+
+/*
+ * Headless worker rendering the tiles leased by a tile coordinator
+ * (this executable started with WORKER_ARGUMENT, the address and the port
+ * of the coordinator), with the same kernel as the in process renderers
+ *
+ * One tile is computed at a time, between tiles the connection is served;
+ * the process ends when the connection is closed
+ */
+
+class TileWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit TileWorker(QObject *parent = nullptr);
+    ~TileWorker() override;
+    TileWorker(const TileWorker&) = delete;
+    TileWorker(TileWorker&&) = delete;
+    TileWorker& operator=(const TileWorker&) = delete;
+    TileWorker& operator=(TileWorker&&) = delete;
+
+    void connectToCoordinator(const QString& host, quint16 port);
+
+    static bool isWorkerInvocation(int argc, char *argv[]);
+    static int runWorker(const QStringList& arguments);
+
+    static const char WORKER_ARGUMENT[];
+
+private slots:
+    void sayHello();
+    void readFromCoordinator();
+    void computeNextTile();
+
+private:
+    void processMessage(TileProtocol::messageType type, const QByteArray& payload);
+    void scheduleNextTile();
+
+    QTcpSocket socket;
+    quint32 jobId;
+    RenderJobRequest job;
+    std::unique_ptr<JobTaskOwner> taskOwner;
+    MandelBrotRenderer::computeFunction computeTask;
+    std::deque<TileProtocol::Lease> leases;
+    bool tileScheduled;
+};
+
+#endif // TILEWORKER_H
@@ -40,6 +40,11 @@ private:
     void addColorMapSizeField();
     void addNumericTypeSelector();
     void addInfoControlButton();
+    void addFocusedRenderingButton();
+    void addSpeculativeRenderingButton();
+    void addSnappedZoomButton();
+    void addFrameBudgetButton();
+    void addBackgroundModeControls();
     void updateFromSettings();
 
     void initializeChosenDataType();
@@ -61,6 +66,12 @@ signals:
     QLabel* numericTypeTitle;
     QComboBox* numericTypeSelection;
     QCheckBox* showInfoButton;
+    QCheckBox* focusedRenderingButton;
+    QCheckBox* speculativeRenderingButton;
+    QCheckBox* snappedZoomButton;
+    QCheckBox* frameBudgetButton;
+    QCheckBox* backgroundModeButton;
+    QSpinBox* backgroundCpuShareSetting;
     QDialogButtonBox* okOrCancelBox;
     RenderThread *masterThread;
     MandelbrotWidget* mainWidget;
@@ -74,6 +85,12 @@ signals:
     bool threadMediatorEnabled;
     int colorMapSize;
     bool displayDetailedInfo;
+    bool focusedRenderingEnabled;
+    bool speculativeRenderingEnabled;
+    bool snappedZoomEnabled;
+    bool frameBudgetEnabled;
+    bool backgroundModeEnabled;
+    int backgroundCpuShare;
 
     static constexpr int UNSELECTED_BUTTON = -1;
     static constexpr int NUM_THREAD_ALGORITHMS = 2;
@@ -85,6 +102,11 @@ signals:
     void setNumPassesInGUI();
     void setColorMapSizeinGUI();
     void setDetailedInfoInGUI();
+    void setFocusedRenderingInGUI();
+    void setSpeculativeRenderingInGUI();
+    void setSnappedZoomInGUI();
+    void setFrameBudgetInGUI();
+    void setBackgroundModeInGUI();
     void setNumericTypeInGUI();
 
     int findSelectedNumPassesButton();
@@ -0,0 +1,78 @@
+#ifndef VIEWCACHE_H
+#define VIEWCACHE_H
+
+#include <QImage>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+
+#include <cstdint>
+#include <list>
+#include <utility>
+
+#include "mandelbrotrenderer.h"
+
+/*
+ * The parameters defining a view to be rendered
+ */
+struct ViewParameters
+{
+    MandelBrotRenderer::CoordValue originX;
+    MandelBrotRenderer::CoordValue originY;
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+    QString preciseOriginX;
+    QString preciseOriginY;
+#endif
+    double scaleFactor;
+    QSize size;
+};
+
+/*
+ * A view together with all the render settings which affect the resulting image
+ */
+struct ViewCacheKey
+{
+    ViewParameters view;
+    int numPasses;
+    MandelBrotRenderer::internalDataType numericType;
+    int colorMapSize;
+
+    bool operator==(const ViewCacheKey& other) const;
+};
+
+/*
+ * A completely rendered view
+ */
+struct CachedView
+{
+    QImage image;
+    int64_t iterationSumCount;
+};
+
+/*
+ * Small cache of completely rendered images (most recently used first),
+ * filled by the master render thread with the results of normal and
+ * speculative renders. Only used by the master render thread, so no locking
+ */
+
+class ViewCache
+{
+public:
+    ViewCache() = default;
+
+    bool find(const ViewCacheKey& key, CachedView& view);
+    bool contains(const ViewCacheKey& key) const;
+    bool findTranslatedView(const ViewCacheKey& key, QPoint& offset, CachedView& view);
+    bool findZoomedView(const ViewCacheKey& key, QPoint& offset, bool& zoomedIn, CachedView& view);
+    void insert(const ViewCacheKey& key, const CachedView& view);
+    void clear() { cachedViews.clear(); }
+
+    static constexpr std::size_t MAX_CACHED_VIEWS = 16;
+    //views further apart than a whole number of pixels can't be reused by translation
+    static constexpr double MAX_TRANSLATION_ERROR_IN_PIXELS = 0.01;
+
+private:
+    std::list<std::pair<ViewCacheKey, CachedView>> cachedViews;
+};
+
+#endif // VIEWCACHE_H
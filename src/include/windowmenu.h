@@ -7,6 +7,7 @@ class WindowThreadInfo;
 class RenderThread;
 class ThreadIconMap;
 class WindowThreadInfoKey;
+class OverviewWindow;
 class QSize;
 class QPoint;
 
@@ -24,12 +25,14 @@ public:
 public slots:
     void showInfo();
     void showKey();
+    void showOverview();
 
 private:
     WindowThreadInfo* threadInfo;
     RenderThread* masterThread;
     const ThreadIconMap* threadIcons;
     WindowThreadInfoKey* threadStateKey;
+    OverviewWindow* overview;
 };
 
 #endif // WINDOWMENU_H
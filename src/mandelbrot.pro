@@ -1,4 +1,4 @@
-QT += widgets
+QT += widgets network
 
 HEADERS += \
     include/buttonuser.h \
@@ -30,7 +30,26 @@ HEADERS += \
     include/windowmenu.h \
     include/windowthreadinfo.h \
     include/windowthreadinfokey.h \
-    include/workerthreaddata.h
+    include/workerthreaddata.h \
+    include/iterationcostmap.h \
+    include/pausegate.h \
+    include/cancellationtoken.h \
+    include/focustaskqueue.h \
+    include/viewcache.h \
+    include/renderjobpool.h \
+    include/bufferarena.h \
+    include/tilecache.h \
+    include/disktilestore.h \
+    include/framebudget.h \
+    include/cputhrottle.h \
+    include/processrenderpool.h \
+    include/jobtaskowner.h \
+    include/tileprotocol.h \
+    include/tilecoordinator.h \
+    include/tileworker.h \
+    include/tileserver.h \
+    include/commandlinerenderer.h \
+    include/overviewwindow.h
 
 SOURCES       = src/main.cpp \
     src/computeddatasegment.cpp \
@@ -58,7 +77,25 @@ SOURCES       = src/main.cpp \
     src/windowmenu.cpp \
     src/windowthreadinfo.cpp \
     src/windowthreadinfokey.cpp \
-    src/workerthreaddata.cpp
+    src/workerthreaddata.cpp \
+    src/iterationcostmap.cpp \
+    src/pausegate.cpp \
+    src/cancellationtoken.cpp \
+    src/focustaskqueue.cpp \
+    src/viewcache.cpp \
+    src/renderjobpool.cpp \
+    src/bufferarena.cpp \
+    src/tilecache.cpp \
+    src/disktilestore.cpp \
+    src/framebudget.cpp \
+    src/cputhrottle.cpp \
+    src/processrenderpool.cpp \
+    src/tileprotocol.cpp \
+    src/tilecoordinator.cpp \
+    src/tileworker.cpp \
+    src/tileserver.cpp \
+    src/commandlinerenderer.cpp \
+    src/overviewwindow.cpp
 
 OTHER_FILES +=  src/ComputeTaskGenerator.cpp
 
@@ -1,6 +1,8 @@
 #include "ComputeTaskGenerator.h"
 #include "ParameterMaker.h"
-#include "renderworker.h"
+#include <QColor>
+
+#include <algorithm>
 
 
 /**********************************************
@@ -28,44 +30,44 @@ template <typename T, MandelBrotRenderer::enable_if_t<std::is_integral<T>::value
         void normalize(T& t, const int64_t& scalingShift) noexcept { t = static_cast<T>(t >> scalingShift); }
 
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
-bool checkEndCondition(const MandelBrotRenderer::Int128& value,
+inline bool checkEndCondition(const MandelBrotRenderer::Int128& value,
     const MandelBrotRenderer::Int128& limit) noexcept { return value > limit || value < 0; }
 
-void normalize(MandelBrotRenderer::Int128& t, const int64_t& scalingShift) noexcept
+inline void normalize(MandelBrotRenderer::Int128& t, const int64_t& scalingShift) noexcept
                         { t = static_cast<MandelBrotRenderer::Int128>(t >> scalingShift); }
 
-bool checkEndCondition(const MandelBrotRenderer::Float128& value,
+inline bool checkEndCondition(const MandelBrotRenderer::Float128& value,
     const MandelBrotRenderer::Float128& limit) noexcept { return value > limit; }
 
-void normalize(const MandelBrotRenderer::Float128&, const int64_t&) noexcept {}
+inline void normalize(const MandelBrotRenderer::Float128&, const int64_t&) noexcept {}
 
-bool checkEndCondition(const MandelBrotRenderer::Float80& value,
+inline bool checkEndCondition(const MandelBrotRenderer::Float80& value,
     const MandelBrotRenderer::Float80& limit) noexcept { return value > limit; }
 
-void normalize(const MandelBrotRenderer::Float80&, const int64_t&) noexcept {}
+inline void normalize(const MandelBrotRenderer::Float80&, const int64_t&) noexcept {}
 #endif //(USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
 
 #if (USE_BOOST_MULTIPRECISION == 1)
-bool checkEndCondition(const MandelBrotRenderer::CustomFloat& value,
+inline bool checkEndCondition(const MandelBrotRenderer::CustomFloat& value,
     const MandelBrotRenderer::CustomFloat& limit) noexcept { return value > limit; }
 
-void normalize(const MandelBrotRenderer::CustomFloat&, const int64_t&) noexcept {}
+inline void normalize(const MandelBrotRenderer::CustomFloat&, const int64_t&) noexcept {}
 
 
-bool checkEndCondition(const MandelBrotRenderer::Float20dd& value,
+inline bool checkEndCondition(const MandelBrotRenderer::Float20dd& value,
     const MandelBrotRenderer::Float20dd& limit) noexcept { return value > limit; }
 
-void normalize(const MandelBrotRenderer::Float20dd&, const int64_t&) noexcept {}
+inline void normalize(const MandelBrotRenderer::Float20dd&, const int64_t&) noexcept {}
 
-bool checkEndCondition(const MandelBrotRenderer::Float30dd& value,
+inline bool checkEndCondition(const MandelBrotRenderer::Float30dd& value,
     const MandelBrotRenderer::Float30dd& limit) noexcept { return value > limit; }
 
-void normalize(const MandelBrotRenderer::Float30dd&, const int64_t&) noexcept {}
+inline void normalize(const MandelBrotRenderer::Float30dd&, const int64_t&) noexcept {}
 
-bool checkEndCondition(const MandelBrotRenderer::Float50dd& value,
+inline bool checkEndCondition(const MandelBrotRenderer::Float50dd& value,
     const MandelBrotRenderer::Float50dd& limit) noexcept { return value > limit; }
 
-void normalize(const MandelBrotRenderer::Float50dd&, const int64_t&) noexcept {}
+inline void normalize(const MandelBrotRenderer::Float50dd&, const int64_t&) noexcept {}
 #endif //(USE_BOOST_MULTIPRECISION == 1)
 
 /*
@@ -78,33 +80,63 @@ void normalize(const MandelBrotRenderer::Float50dd&, const int64_t&) noexcept {}
  *
  */
 
-template <typename T>
-ComputeTaskGenerator<T>::ComputeTaskGenerator(RenderWorker& workerOwner) : workerOwner(workerOwner){}
+template <typename T, typename TaskOwner>
+ComputeTaskGenerator<T, TaskOwner>::ComputeTaskGenerator(TaskOwner& workerOwner) : workerOwner(workerOwner){}
 
-template <typename T>
-RenderWorker::computeFunction ComputeTaskGenerator<T>::generateComputeTask()
+template <typename T, typename TaskOwner>
+MandelBrotRenderer::computeFunction ComputeTaskGenerator<T, TaskOwner>::generateComputeTask()
 {
-        return ([&] (const ComputedDataSegment& segment, const bool& abort, int& currentPixelIndex, MandelBrotRenderer::ComputeTaskResults& resultData, int y)
+        //the task may outlive this generator, only the task owner is referenced
+        return ([&taskOwner = workerOwner] (const ComputedDataSegment& segment, const CancellationToken& cancellation, MandelBrotRenderer::ComputeTaskResults& resultData, int y)
                 {
-                    const uint pass = workerOwner.getPassValue();
-                    const uint MaxIterations = RenderWorker::calcMaxIterations(pass);
+                    const uint pass = taskOwner.getPassValue();
+                    const uint MaxIterations = MandelBrotRenderer::calcMaxIterations(pass);
 
                     const T limit = 4;
 
                     //generate parameters appropriate to the task and chosen numeric type
                     const ParameterMaker<T> newParams(segment, limit);
 
-                    const MandelBrotRenderer::setType setToGenerate =  workerOwner.getSetToGenerate();
+                    const MandelBrotRenderer::setType setToGenerate =  taskOwner.getSetToGenerate();
                     const T ay = static_cast<T>((setToGenerate == MandelBrotRenderer::setType::mandelbrot) ? newParams.originY + (y * newParams.scaleFactor) :
                                                                          newParams.originY);
 
-                    const MandelBrotRenderer::colorMapStore& colormap = workerOwner.getColormap();
-                    const T iterationColourScale =  static_cast<T>(workerOwner.getIterationColourScale());
+                    const MandelBrotRenderer::colorMapStore& colormap = taskOwner.getColormap();
+                    const T iterationColourScale =  static_cast<T>(taskOwner.getIterationColourScale());
+
+                    //the line is owned by this task, pixels are written straight into the frame buffer
+                    uint* pixel = resultData.frameBuffer.pixelAt(newParams.minX, y);
+
+                    const MandelBrotRenderer::SampleGrid& reusedSamples = segment.getParameters().reusedSamples;
+                    const bool lineHasReusedSamples = reusedSamples.containsLine(y);
+
+                    //a preview only computes the first pixel of each block, the rest of the block is a copy
+                    const MandelBrotRenderer::SampleGrid& previewSamples = segment.getParameters().previewSamples;
+                    const bool previewing = (previewSamples.step > 0);
+                    if (previewing && !previewSamples.containsLine(y)) {
+                        //filled in by the first line of its block
+                        return;
+                    }
+
+                for (int x = newParams.minX; x < newParams.maxX && !cancellation.isCancelled(); ++x) {
+                    if (lineHasReusedSamples && reusedSamples.containsColumn(x)) {
+                        //the final value was copied from a cached view
+                        ++pixel;
+                        continue;
+                    }
 
-                for (int x = newParams.minX; x < newParams.maxX && !abort; ++x) {
-                    const T ax = static_cast<T>((setToGenerate == MandelBrotRenderer::setType::mandelbrot) ? newParams.originX + (x * newParams.scaleFactor):
+                    if (previewing && x != newParams.minX && !previewSamples.containsColumn(x)) {
+                        *pixel = *(pixel - 1);
+                        ++pixel;
+                        continue;
+                    }
+
+                    //the first pixel of a task may lie within a block
+                    const int sampleX = previewing ? previewSamples.minX + ((x - previewSamples.minX) / previewSamples.step) * previewSamples.step : x;
+
+                    const T ax = static_cast<T>((setToGenerate == MandelBrotRenderer::setType::mandelbrot) ? newParams.originX + (sampleX * newParams.scaleFactor):
                                                                    newParams.originX);
-                    T a1 = static_cast<T>((setToGenerate == MandelBrotRenderer::setType::mandelbrot) ? ax : newParams.originX + (x * newParams.scaleFactor));
+                    T a1 = static_cast<T>((setToGenerate == MandelBrotRenderer::setType::mandelbrot) ? ax : newParams.originX + (sampleX * newParams.scaleFactor));
                     T b1 = static_cast<T>((setToGenerate == MandelBrotRenderer::setType::mandelbrot) ? ay : newParams.originY + (y * newParams.scaleFactor));
                     uint numIterations = 0;
 
@@ -142,16 +174,74 @@ RenderWorker::computeFunction ComputeTaskGenerator<T>::generateComputeTask()
                         if (checkEndCondition(mod1Sq, newParams.limit))
                             break;
 
+                        //numIterations is even here, poll for cancellation every POLL_INTERVAL_IN_ITERATIONS
+                        if ((numIterations & CancellationToken::POLL_INTERVAL_MASK) == 0 && cancellation.isCancelled())
+                            break;
+
                     } while (numIterations < MaxIterations);
 
+                    if (cancellation.isCancelled()) {
+                        //the pixel value is incomplete
+                        break;
+                    }
+
                     if (numIterations < MaxIterations) {
-                        (*(resultData.rawResultData))[currentPixelIndex] = colormap[static_cast<uint>(static_cast<T>(numIterations) * iterationColourScale)
+                        *pixel = colormap[static_cast<uint>(static_cast<T>(numIterations) * iterationColourScale)
                                                                        % colormap.size()];
 
                         //TODO : maintain a raw numIterations result for filter use (if filtering is enabled)
+                    } else {
+                        *pixel = qRgb(0, 0, 0);
                     }
                     resultData.iterationSum += numIterations;
-                    ++currentPixelIndex;
+                    ++pixel;
+                }
+
+                if (previewing && !cancellation.isCancelled()) {
+                    //the lines below belong to the block, no other task writes to them during a preview pass
+                    const uint* line = resultData.frameBuffer.pixelAt(newParams.minX, y);
+                    const int lastBlockLine = std::min(y + previewSamples.step, previewSamples.maxY);
+                    for (int blockLine = y + 1; blockLine < lastBlockLine; ++blockLine) {
+                        std::copy(line, line + (newParams.maxX - newParams.minX), resultData.frameBuffer.pixelAt(newParams.minX, blockLine));
+                    }
                 }
         });
 }
+
+/*
+ * Generate the compute task for the numeric type chosen at runtime
+ */
+template <typename TaskOwner>
+MandelBrotRenderer::computeFunction generateComputeTaskForType(TaskOwner& taskOwner, MandelBrotRenderer::internalDataType numericType)
+{
+    using MandelBrotRenderer::internalDataType;
+
+    if (numericType == internalDataType::singlePrecisionFloat) {
+        return ComputeTaskGenerator<float, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::int32) {
+        return ComputeTaskGenerator<int32_t, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::int64) {
+        return ComputeTaskGenerator<int64_t, TaskOwner>(taskOwner).generateComputeTask();
+#if (USE_BOOST_MULTIPRECISION == 1)
+    } else if (numericType == internalDataType::customFloat20) {
+        return ComputeTaskGenerator<MandelBrotRenderer::CustomFloat, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::float20dd) {
+        return ComputeTaskGenerator<MandelBrotRenderer::Float20dd, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::float30dd) {
+        return ComputeTaskGenerator<MandelBrotRenderer::Float30dd, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::float50dd) {
+        return ComputeTaskGenerator<MandelBrotRenderer::Float50dd, TaskOwner>(taskOwner).generateComputeTask();
+#endif
+
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+    } else if (numericType == internalDataType::float80) {
+        return ComputeTaskGenerator<MandelBrotRenderer::Float80, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::float128) {
+        return ComputeTaskGenerator<MandelBrotRenderer::Float128, TaskOwner>(taskOwner).generateComputeTask();
+    } else if (numericType == internalDataType::int128) {
+        return ComputeTaskGenerator<MandelBrotRenderer::Int128, TaskOwner>(taskOwner).generateComputeTask();
+#endif
+    }
+
+    return ComputeTaskGenerator<double, TaskOwner>(taskOwner).generateComputeTask();
+}
@@ -2,6 +2,9 @@
 #include "mandelbrotwidget.h"
 #include "PrecisionHandler.h"
 
+#include <cstdlib>
+#include <cstring>
+
 /*
  *
  * This class is responsible for managing the undo/redo flow.
@@ -11,7 +14,8 @@
  *
  */
 
-RenderHistory::RenderHistory(MandelbrotWidget* stateHolder) : stateHolder(stateHolder), currentPos(historyLog.begin())
+RenderHistory::RenderHistory(MandelbrotWidget* stateHolder) : stateHolder(stateHolder), currentPos(historyLog.begin()),
+    frameMemoryBudget(DEFAULT_FRAME_MEMORY_BUDGET_IN_BYTES), frameMemoryUsed(0)
 {
     connect(this, SIGNAL(undoIsAvailable(bool)), stateHolder, SLOT(setUndoEnabled(bool)));
     connect(this, SIGNAL(redoIsAvailable(bool)), stateHolder, SLOT(setRedoEnabled(bool)));
@@ -44,8 +48,8 @@ bool RenderHistory::saveState()
         removeTailEntries();
     }
     const MandelBrotRenderer::RenderState newState = stateHolder->generateConfigData().getState();
-    if (currentPos == historyLog.end() || newState != *currentPos) {
-        historyLog.push_back(newState);
+    if (currentPos == historyLog.end() || newState != currentPos->state) {
+        historyLog.push_back(HistoryEntry { newState, HistoryFrame { QByteArray(), QSize(), 0 } });
         novelStateGenerated = true;
     }
     
@@ -60,9 +64,104 @@ void RenderHistory::removeTailEntries()
     Q_ASSERT(currentPos != getLastEntryPos());
     auto firstToGo = currentPos;
     firstToGo++;
+    for (auto i = firstToGo; i != historyLog.end(); ++i) {
+        dropFrame(i->frame);
+    }
     historyLog.erase(firstToGo, historyLog.end());
 }
 
+/*
+ * Keep the completed image of the current entry, provided it still shows
+ * the view of the entry (the image arrives after the render has completed)
+ */
+void RenderHistory::storeFrame(const QImage& image, const QString& originX, const QString& originY, double scaleFactor, int numPasses)
+{
+    if (currentPos == historyLog.end() || frameMemoryBudget == 0 || image.isNull()) {
+        return;
+    }
+
+    const MandelBrotRenderer::RenderState& state = currentPos->state;
+    if (state.originX != originX || state.originY != originY || state.curScale != scaleFactor || state.size != image.size()) {
+        return;
+    }
+
+    HistoryFrame& frame = currentPos->frame;
+    if (!frame.pixels.isEmpty() && frame.numPasses == numPasses) {
+        return;
+    }
+
+    dropFrame(frame);
+    frame = HistoryFrame { compressFrame(image), image.size(), numPasses };
+    frameMemoryUsed += static_cast<std::size_t>(frame.pixels.size());
+    trimFrames();
+}
+
+void RenderHistory::setFrameMemoryBudget(std::size_t bytes)
+{
+    frameMemoryBudget = bytes;
+    trimFrames();
+}
+
+void RenderHistory::dropFrame(HistoryFrame& frame)
+{
+    frameMemoryUsed -= static_cast<std::size_t>(frame.pixels.size());
+    frame = HistoryFrame { QByteArray(), QSize(), 0 };
+}
+
+/*
+ * Drop the frames of the entries furthest from the current one until the budget is met
+ */
+void RenderHistory::trimFrames()
+{
+    while (frameMemoryUsed > frameMemoryBudget) {
+        const auto currentIndex = std::distance(historyLog.begin(), currentPos);
+        auto furthest = historyLog.end();
+        long furthestDistance = -1;
+        long index = 0;
+        for (auto i = historyLog.begin(); i != historyLog.end(); ++i, ++index) {
+            const long distance = std::labs(index - static_cast<long>(currentIndex));
+            if (!i->frame.pixels.isEmpty() && distance > furthestDistance) {
+                furthest = i;
+                furthestDistance = distance;
+            }
+        }
+
+        if (furthest == historyLog.end()) {
+            break;
+        }
+        dropFrame(furthest->frame);
+    }
+}
+
+QByteArray RenderHistory::compressFrame(const QImage& image)
+{
+    const QImage frameImage = (image.format() == QImage::Format_RGB32) ? image : image.convertToFormat(QImage::Format_RGB32);
+    const int lineSize = frameImage.width() * static_cast<int>(sizeof(uint));
+
+    //the lines are stored without their padding
+    QByteArray lines(lineSize * frameImage.height(), '\0');
+    for (int y = 0; y < frameImage.height(); ++y) {
+        std::memcpy(lines.data() + y * lineSize, frameImage.constScanLine(y), static_cast<std::size_t>(lineSize));
+    }
+
+    return qCompress(lines, FRAME_COMPRESSION_LEVEL);
+}
+
+QImage RenderHistory::decompressFrame(const HistoryFrame& frame)
+{
+    const QByteArray lines = qUncompress(frame.pixels);
+    const int lineSize = frame.size.width() * static_cast<int>(sizeof(uint));
+    if (lines.size() != lineSize * frame.size.height()) {
+        return QImage();
+    }
+
+    QImage image(frame.size, QImage::Format_RGB32);
+    for (int y = 0; y < frame.size.height(); ++y) {
+        std::memcpy(image.scanLine(y), lines.constData() + y * lineSize, static_cast<std::size_t>(lineSize));
+    }
+    return image;
+}
+
 void RenderHistory::undo()
 {
     Q_ASSERT(undoIsPossible());
@@ -103,9 +202,19 @@ void RenderHistory::setNewState(Direction moveDirection)
         ++currentPos;
     }
     checkAvailability();
-    RendererConfig newConfig((MandelBrotRenderer::RenderState(*currentPos)));
+    RendererConfig newConfig((MandelBrotRenderer::RenderState(currentPos->state)));
     stateHolder->setUsingUndoRedo();
-    stateHolder->enforceConfigData(newConfig);
+
+    const QImage frame = currentPos->frame.pixels.isEmpty() ? QImage() : decompressFrame(currentPos->frame);
+    if (frame.isNull()) {
+        stateHolder->enforceConfigData(newConfig);
+    } else {
+        //the frame is shown straight away, it is only rendered again if settings affecting it have changed since
+        stateHolder->enforceConfigData(newConfig, false);
+        stateHolder->presentHistoryFrame(frame, currentPos->frame.numPasses,
+                                         currentPos->state.numericType, currentPos->state.colorMapSize);
+    }
+
     stateHolder->clearUsingUndoRedo();
 }
 
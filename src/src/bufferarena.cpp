@@ -0,0 +1,157 @@
+#include "bufferarena.h"
+
+#include <QtGlobal>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+BufferArena::BufferArena(bool useHugePages)
+    : useHugePages(useHugePages),
+      allocationCount(0),
+      allocatedBytes(0),
+      reuseCount(0),
+      pooledBytes(0)
+{
+}
+
+BufferArena::~BufferArena()
+{
+    QMutexLocker locker(&mutex);
+    Q_ASSERT(allocatedBytes == pooledBytes);
+
+    for (auto& i : pool) {
+        deallocate(i.buffer, i.size);
+    }
+    pool.clear();
+}
+
+/*
+ * Create an RGB32 image whose lines are padded to whole cache lines,
+ * the buffer returns to the pool when the last copy of the image goes away
+ */
+QImage BufferArena::createImage(const QSize& size)
+{
+    if (size.width() <= 0 || size.height() <= 0) {
+        return QImage();
+    }
+
+    const std::size_t lineSize = static_cast<std::size_t>(size.width()) * sizeof(uint);
+    const std::size_t bytesPerLine = ((lineSize + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE) * CACHE_LINE_SIZE;
+    const std::size_t bufferSize = bytesPerLine * static_cast<std::size_t>(size.height());
+
+    uchar* buffer = acquire(bufferSize);
+    auto info = new ImageBuffer { this, buffer, bufferSize };
+
+    return QImage(buffer, size.width(), size.height(), static_cast<int>(bytesPerLine),
+                  QImage::Format_RGB32, releaseImageBuffer, info);
+}
+
+/*
+ * Hand out a buffer of the given size, a released buffer of the same size is reused if available
+ */
+uchar* BufferArena::acquire(std::size_t size)
+{
+    QMutexLocker locker(&mutex);
+
+    for (auto i = pool.begin(); i != pool.end(); ++i) {
+        if (i->size == size) {
+            uchar* buffer = i->buffer;
+            pool.erase(i);
+            pooledBytes -= static_cast<int64_t>(size);
+            ++reuseCount;
+            return buffer;
+        }
+    }
+
+    return allocate(size);
+}
+
+/*
+ * Give a buffer back to the pool, the oldest pooled buffer is freed when the pool is full
+ */
+void BufferArena::release(uchar* buffer, std::size_t size)
+{
+    if (buffer == nullptr) {
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+
+    if (pool.size() >= MAX_POOLED_BUFFERS) {
+        deallocate(pool.front().buffer, pool.front().size);
+        pooledBytes -= static_cast<int64_t>(pool.front().size);
+        pool.pop_front();
+    }
+
+    pool.push_back(PooledBuffer { buffer, size });
+    pooledBytes += static_cast<int64_t>(size);
+}
+
+BufferArena::Statistics BufferArena::getStatistics() const
+{
+    QMutexLocker locker(&mutex);
+    return Statistics { allocationCount, allocatedBytes, reuseCount, pooledBytes };
+}
+
+void BufferArena::resetCounters()
+{
+    QMutexLocker locker(&mutex);
+    allocationCount = 0;
+    reuseCount = 0;
+}
+
+bool BufferArena::getUseHugePages() const
+{
+    QMutexLocker locker(&mutex);
+    return useHugePages;
+}
+
+/*
+ * Only affects buffers allocated from now on
+ */
+void BufferArena::setUseHugePages(bool value)
+{
+    QMutexLocker locker(&mutex);
+    useHugePages = value;
+}
+
+/*
+ * Cleanup function of the images created by the arena
+ */
+void BufferArena::releaseImageBuffer(void* info)
+{
+    auto imageBuffer = static_cast<ImageBuffer*>(info);
+    imageBuffer->arena->release(imageBuffer->buffer, imageBuffer->size);
+    delete imageBuffer;
+}
+
+/*
+ * Called with the mutex held
+ */
+uchar* BufferArena::allocate(std::size_t size)
+{
+    const bool hugePages = useHugePages && size >= HUGE_PAGE_SIZE;
+    auto buffer = static_cast<uchar*>(qMallocAligned(size, hugePages ? HUGE_PAGE_SIZE : CACHE_LINE_SIZE));
+    Q_CHECK_PTR(buffer);
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (hugePages) {
+        //only a hint, the buffer is still usable if the kernel refuses
+        madvise(buffer, (size / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE, MADV_HUGEPAGE);
+    }
+#endif
+
+    ++allocationCount;
+    allocatedBytes += static_cast<int64_t>(size);
+    return buffer;
+}
+
+/*
+ * Called with the mutex held
+ */
+void BufferArena::deallocate(uchar* buffer, std::size_t size)
+{
+    qFreeAligned(buffer);
+    allocatedBytes -= static_cast<int64_t>(size);
+}
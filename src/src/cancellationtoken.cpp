@@ -0,0 +1,31 @@
+#include "cancellationtoken.h"
+
+#include "mandelbrotrenderer.h"
+
+void CancellationToken::cancel()
+{
+    if (!cancelled.load()) {
+        cancelTimer.start();
+        cancelled.store(true, std::memory_order_release);
+    }
+}
+
+/*
+ * Only to be called when no workers are using the token
+ */
+void CancellationToken::reset()
+{
+    cancelled.store(false);
+    maxStopLatencyInUs.store(0);
+}
+
+/*
+ * Called by each worker as it stops, the largest value is
+ * the time from cancellation until all workers were idle
+ */
+void CancellationToken::recordWorkerStopped() const
+{
+    if (cancelled.load(std::memory_order_acquire)) {
+        MandelBrotRenderer::storeMaximum(maxStopLatencyInUs, cancelTimer.nsecsElapsed() / NS_IN_ONE_US);
+    }
+}
@@ -0,0 +1,23 @@
+#include "commandlinerenderer.h"
+#include "processrenderpool.h"
+#include "tileworker.h"
+
+#include <QCoreApplication>
+
+//headless renderer, no display server required
+int main(int argc, char *argv[])
+{
+    //the helper processes of --processes and the workers of --tile-workers are started from this executable
+    if (ProcessRenderPool::isHelperInvocation(argc, argv)) {
+        QCoreApplication helperApp(argc, argv);
+        return ProcessRenderPool::runHelper(QCoreApplication::arguments());
+    }
+    if (TileWorker::isWorkerInvocation(argc, argv)) {
+        QCoreApplication workerApp(argc, argv);
+        return TileWorker::runWorker(QCoreApplication::arguments());
+    }
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("mandelbrot-cli");
+    return CommandLineRenderer::run(QCoreApplication::arguments());
+}
@@ -0,0 +1,537 @@
+#include "commandlinerenderer.h"
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QTimer>
+
+#include <atomic>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "PrecisionHandler.h"
+#include "computeddatasegment.h"
+#include "regionattributes.h"
+
+const char CommandLineRenderer::DEFAULT_ORIGIN_X[] = "-0.637011";
+const char CommandLineRenderer::DEFAULT_ORIGIN_Y[] = "-0.0395159";
+
+namespace {
+    struct SegmentBenchmarkCounters
+    {
+        qint64 handOffs;
+        qint64 lockAcquisitions;
+        qint64 contendedAcquisitions;
+        qint64 lockWaitTimeInNs;
+    };
+
+    /*
+     * Hands segments off the way a worker, the mediator and the render thread do
+     * (the segment built for another thread, its queued copy, the move to the
+     * taker and the cleared results) until the time is up
+     *
+     * With a global mutex every operation takes it, as the process-wide instance
+     * counter lock of the segments used to
+     */
+    SegmentBenchmarkCounters handOffSegments(const SharedTaskParameters& parameters, int threadIndex,
+                                             QMutex* globalMutex, const std::atomic<bool>& started, qint64 durationInMs)
+    {
+        constexpr int HAND_OFFS_PER_CLOCK_CHECK = 256;
+        SegmentBenchmarkCounters counters { 0, 0, 0, 0 };
+        const auto serialized = [globalMutex, &counters](const auto& operation) {
+            if (globalMutex == nullptr) {
+                operation();
+                return;
+            }
+            ++counters.lockAcquisitions;
+            if (!globalMutex->tryLock()) {
+                QElapsedTimer waitClock;
+                waitClock.start();
+                globalMutex->lock();
+                ++counters.contendedAcquisitions;
+                counters.lockWaitTimeInNs += waitClock.nsecsElapsed();
+            }
+            operation();
+            globalMutex->unlock();
+        };
+
+        while (!started.load()) {
+            std::this_thread::yield();
+        }
+
+        ComputedDataSegment built;
+        ComputedDataSegment queued;
+        ComputedDataSegment taken;
+        QElapsedTimer clock;
+        clock.start();
+        while (clock.elapsed() < durationInMs) {
+            for (int i = 0; i < HAND_OFFS_PER_CLOCK_CHECK; ++i) {
+                const MandelBrotRenderer::RenderTask task { 0, 1, i, i + 1, parameters.jobId };
+                serialized([&] { built = ComputedDataSegment(parameters, task, threadIndex); });
+                serialized([&] { queued = built; });
+                serialized([&] { taken = std::move(built); });
+                serialized([&] { taken.clearResults(); });
+            }
+            counters.handOffs += HAND_OFFS_PER_CLOCK_CHECK;
+        }
+        return counters;
+    }
+
+    SegmentBenchmarkCounters runSegmentHandOffs(const SharedTaskParameters& parameters, int numThreads,
+                                                QMutex* globalMutex, qint64 durationInMs)
+    {
+        std::atomic<bool> started(false);
+        std::vector<SegmentBenchmarkCounters> threadCounters(static_cast<std::size_t>(numThreads));
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numThreads; ++i) {
+            threads.emplace_back([&, i] {
+                threadCounters[static_cast<std::size_t>(i)] =
+                        handOffSegments(parameters, i, globalMutex, started, durationInMs);
+            });
+        }
+        started.store(true);
+
+        SegmentBenchmarkCounters total { 0, 0, 0, 0 };
+        for (std::size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+            total.handOffs += threadCounters[i].handOffs;
+            total.lockAcquisitions += threadCounters[i].lockAcquisitions;
+            total.contendedAcquisitions += threadCounters[i].contendedAcquisitions;
+            total.lockWaitTimeInNs += threadCounters[i].lockWaitTimeInNs;
+        }
+        return total;
+    }
+}
+
+CommandLineRenderer::CommandLineRenderer(RenderJobPool& jobPool, const RenderJobRequest& request,
+                                         const QString& outputFile, QObject *parent)
+    : QObject{ parent },
+      jobPool(jobPool),
+      processPool(nullptr),
+      tileCoordinator(nullptr),
+      request(request),
+      outputFile(outputFile),
+      jobId(0),
+      referenceJobId(-1),
+      verified(false),
+      checksum(0),
+      exitCode(EXIT_RENDER_FAILED),
+      cancelAfterInMs(-1),
+      minTileWorkers(0)
+{
+    //the pool signals from its worker threads, the result is queued to this thread
+    connect(&jobPool, SIGNAL(jobDone(int,QImage)), this, SLOT(renderDone(int,QImage)));
+    connect(&jobPool, SIGNAL(jobCancelled(int)), this, SLOT(renderCancelled(int)));
+}
+
+CommandLineRenderer::~CommandLineRenderer() = default;
+
+void CommandLineRenderer::start()
+{
+    if (tileCoordinator != nullptr && tileCoordinator->getNumWorkers() < minTileWorkers) {
+        //the workers of other machines join the coordinator whenever they are started
+        std::cout << "waiting for tile workers: " << minTileWorkers << std::endl;
+        connect(tileCoordinator, SIGNAL(workersChanged(int)), this, SLOT(tileWorkersChanged(int)));
+        return;
+    }
+    startRender();
+}
+
+void CommandLineRenderer::tileWorkersChanged(int numWorkers)
+{
+    if (numWorkers >= minTileWorkers) {
+        disconnect(tileCoordinator, SIGNAL(workersChanged(int)), this, SLOT(tileWorkersChanged(int)));
+        startRender();
+    }
+}
+
+void CommandLineRenderer::startRender()
+{
+    clock.start();
+    if (processPool != nullptr) {
+        connect(processPool, SIGNAL(jobDone(QImage)), this, SLOT(offloadedRenderDone(QImage)));
+        connect(processPool, SIGNAL(jobCancelled()), this, SLOT(offloadedRenderCancelled()));
+        connect(processPool, SIGNAL(jobFailed(QString)), this, SLOT(offloadedRenderFailed(QString)));
+        if (!processPool->render(request)) {
+            //quit once the event loop runs
+            QTimer::singleShot(0, this, [this] { offloadedRenderFailed("the shared job could not be created"); });
+            return;
+        }
+    } else if (tileCoordinator != nullptr) {
+        connect(tileCoordinator, SIGNAL(jobDone(QImage)), this, SLOT(offloadedRenderDone(QImage)));
+        connect(tileCoordinator, SIGNAL(jobCancelled()), this, SLOT(offloadedRenderCancelled()));
+        connect(tileCoordinator, SIGNAL(jobFailed(QString)), this, SLOT(offloadedRenderFailed(QString)));
+        if (!tileCoordinator->render(request)) {
+            QTimer::singleShot(0, this, [this] { offloadedRenderFailed("the coordinator is busy with another job"); });
+            return;
+        }
+    } else {
+        jobId = jobPool.submit(request);
+    }
+    if (cancelAfterInMs >= 0) {
+        QTimer::singleShot(cancelAfterInMs, this, SLOT(cancelRender()));
+    }
+}
+
+void CommandLineRenderer::cancelRender()
+{
+    cancelClock.start();
+    if (processPool != nullptr) {
+        processPool->cancel();
+    } else if (tileCoordinator != nullptr) {
+        tileCoordinator->cancel();
+    } else {
+        jobPool.cancel(jobId);
+    }
+}
+
+/*
+ * Entry point of mandelbrot-cli, the options are those of the region
+ * attributes and of the renderer settings, with the GUI defaults
+ */
+int CommandLineRenderer::run(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Renders a region of the Mandelbrot set without a display.\n"
+                                     "The region is rendered in one pass by the job pool (or by helper processes or tile workers), "
+                                     "with the kernel of the GUI but not its interactive pipeline: the thread mediator, the line cost "
+                                     "partitioning, the progressive passes and focused tiles are not exercised.");
+    parser.addHelpOption();
+    const QCommandLineOption originOption("origin", "Centre of the image, as 'x,y'.", "x,y",
+                                          QString(DEFAULT_ORIGIN_X) + "," + DEFAULT_ORIGIN_Y);
+    const QCommandLineOption scaleOption("scale", "Plane units per pixel.", "scale", QString::number(DEFAULT_SCALE));
+    const QCommandLineOption sizeOption("size", "Image size in pixels, as 'WxH' (at most " +
+                                        QString::number(MandelBrotRenderer::MAX_RENDER_SIZE_X) + "x" +
+                                        QString::number(MandelBrotRenderer::MAX_RENDER_SIZE_Y) + ").", "WxH",
+                                        QString::number(DEFAULT_WIDTH) + "x" + QString::number(DEFAULT_HEIGHT));
+    const QCommandLineOption typeOption("type", "Numeric type (index of the type selector, types missing from the build are rejected).", "type",
+                                        QString::number(MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::defaultRendererType)));
+    const QCommandLineOption passesOption("passes", "Number of passes (sets the iteration count).", "passes",
+                                          QString::number(MandelBrotRenderer::defaultNumPassesValue));
+    const QCommandLineOption threadsOption("threads", "Number of worker threads (at most " +
+                                           QString::number(MandelBrotRenderer::MAX_NUM_WORKER_THREADS) + ").", "threads",
+                                           QString::number(MandelBrotRenderer::calculateInitialNumThreads()));
+    const QCommandLineOption processesOption("processes", "Render in this number of helper processes instead of worker threads.", "processes");
+    const QCommandLineOption tileWorkersOption("tile-workers", "Render in this number of local tile worker processes instead of worker threads.", "workers");
+    const QCommandLineOption coordinatorOption("coordinator", "Render in the tile workers connecting to this address and port instead of worker threads "
+                                               "(start them with --tile-worker host port, 0.0.0.0 accepts those of other machines).", "address:port");
+    const QCommandLineOption minWorkersOption("min-workers", "With --coordinator, wait for this number of tile workers before rendering.", "workers", "1");
+    const QCommandLineOption verifyOption("verify", "Render again with the worker threads and compare the checksums.");
+    const QCommandLineOption outputOption(QStringList { "o", "output" }, "Image file to write.", "file");
+    const QCommandLineOption cancelOption("cancel-after", "Cancel the render after this time, and report how long stopping took.", "ms");
+    const QCommandLineOption segmentBenchmarkOption("segment-benchmark", "Instead of rendering, compare the segment hand-off "
+                                                    "throughput of the worker threads with and without a global segment lock.");
+    parser.addOption(originOption);
+    parser.addOption(scaleOption);
+    parser.addOption(sizeOption);
+    parser.addOption(typeOption);
+    parser.addOption(passesOption);
+    parser.addOption(threadsOption);
+    parser.addOption(processesOption);
+    parser.addOption(tileWorkersOption);
+    parser.addOption(coordinatorOption);
+    parser.addOption(minWorkersOption);
+    parser.addOption(verifyOption);
+    parser.addOption(outputOption);
+    parser.addOption(cancelOption);
+    parser.addOption(segmentBenchmarkOption);
+
+    if (!parser.parse(arguments)) {
+        std::cerr << parser.errorText().toStdString() << std::endl;
+        return EXIT_BAD_ARGUMENTS;
+    }
+    if (parser.isSet("help")) {
+        std::cout << parser.helpText().toStdString();
+        return EXIT_SUCCESS_CODE;
+    }
+
+    bool originIsValid = false;
+    const QStringList origin = parser.value("origin").split(",");
+    QString preciseX;
+    QString preciseY;
+    if (origin.size() == 2) {
+        bool yIsValid = false;
+        preciseX = origin.at(0).trimmed();
+        preciseY = origin.at(1).trimmed();
+        preciseX.toDouble(&originIsValid);
+        preciseY.toDouble(&yIsValid);
+        originIsValid = originIsValid && yIsValid;
+    }
+
+    bool scaleIsValid = false;
+    const double scale = parser.value("scale").toDouble(&scaleIsValid);
+
+    bool sizeIsValid = false;
+    int width = 0;
+    int height = 0;
+    const QStringList size = parser.value("size").split("x");
+    if (size.size() == 2) {
+        bool heightIsValid = false;
+        width = size.at(0).toInt(&sizeIsValid);
+        height = size.at(1).toInt(&heightIsValid);
+        sizeIsValid = sizeIsValid && heightIsValid &&
+                      width > 0 && width <= MandelBrotRenderer::MAX_RENDER_SIZE_X &&
+                      height > 0 && height <= MandelBrotRenderer::MAX_RENDER_SIZE_Y;
+    }
+
+    bool typeIsValid = false;
+    const int numericType = parser.value("type").toInt(&typeIsValid);
+    typeIsValid = typeIsValid &&
+                  numericType >= MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::internalDataType::singlePrecisionFloat) &&
+                  numericType <= MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::internalDataType::int128);
+    //the kernel would silently render the types missing from this build as doubles
+    if (typeIsValid && !MandelBrotRenderer::typeIsCompiledIn(static_cast<MandelBrotRenderer::internalDataType>(numericType))) {
+        std::cerr << "type " << numericType << " is not supported by this build" << std::endl;
+        return EXIT_BAD_ARGUMENTS;
+    }
+
+    bool passesIsValid = false;
+    const int numPasses = parser.value("passes").toInt(&passesIsValid);
+    passesIsValid = passesIsValid && numPasses > 0 && numPasses <= MandelBrotRenderer::MAX_PASSES;
+
+    bool threadsIsValid = false;
+    const int numThreads = parser.value("threads").toInt(&threadsIsValid);
+    threadsIsValid = threadsIsValid &&
+                     numThreads >= MandelBrotRenderer::MIN_NUM_WORKER_THREADS &&
+                     numThreads <= MandelBrotRenderer::MAX_NUM_WORKER_THREADS;
+
+    if (parser.isSet("segment-benchmark")) {
+        if (!threadsIsValid) {
+            std::cerr << "invalid arguments, see --help" << std::endl;
+            return EXIT_BAD_ARGUMENTS;
+        }
+        runSegmentBenchmark(numThreads);
+        return EXIT_SUCCESS_CODE;
+    }
+
+    bool processesIsValid = true;
+    const int numProcesses = parser.isSet("processes") ? parser.value("processes").toInt(&processesIsValid) : 0;
+    processesIsValid = processesIsValid &&
+                       (!parser.isSet("processes") ||
+                        (numProcesses > 0 && numProcesses <= MandelBrotRenderer::MAX_NUM_WORKER_THREADS));
+
+    bool tileWorkersIsValid = true;
+    const int numTileWorkers = parser.isSet("tile-workers") ? parser.value("tile-workers").toInt(&tileWorkersIsValid) : 0;
+    tileWorkersIsValid = tileWorkersIsValid && !(parser.isSet("tile-workers") && parser.isSet("processes")) &&
+                         (!parser.isSet("tile-workers") ||
+                          (numTileWorkers > 0 && numTileWorkers <= MandelBrotRenderer::MAX_NUM_WORKER_THREADS));
+
+    //with --coordinator, local workers started by --tile-workers join the remote ones
+    bool coordinatorIsValid = true;
+    QHostAddress coordinatorAddress(QHostAddress::LocalHost);
+    quint16 coordinatorPort = 0;
+    if (parser.isSet("coordinator")) {
+        const QString address = parser.value("coordinator");
+        const int separator = address.lastIndexOf(':');
+        uint port = 0;
+        if (separator > 0) {
+            port = address.mid(separator + 1).toUInt(&coordinatorIsValid);
+        }
+        coordinatorIsValid = coordinatorIsValid && separator > 0 && port <= std::numeric_limits<quint16>::max() &&
+                             coordinatorAddress.setAddress(address.left(separator)) && !parser.isSet("processes");
+        //the local workers connect over the loopback interface
+        coordinatorIsValid = coordinatorIsValid &&
+                             (!parser.isSet("tile-workers") || coordinatorAddress.isLoopback() ||
+                              coordinatorAddress == QHostAddress::AnyIPv4 || coordinatorAddress == QHostAddress::Any);
+        coordinatorPort = static_cast<quint16>(port);
+    }
+
+    bool minWorkersIsValid = false;
+    const int minTileWorkers = parser.value("min-workers").toInt(&minWorkersIsValid);
+    minWorkersIsValid = minWorkersIsValid && minTileWorkers > 0 && (parser.isSet("coordinator") || !parser.isSet("min-workers"));
+
+    bool cancelIsValid = true;
+    const int cancelAfterInMs = parser.isSet("cancel-after") ? parser.value("cancel-after").toInt(&cancelIsValid) : -1;
+    cancelIsValid = cancelIsValid && (cancelAfterInMs >= 0 || !parser.isSet("cancel-after"));
+
+    if (!originIsValid || !scaleIsValid || scale <= 0.0 || !sizeIsValid ||
+        !typeIsValid || !passesIsValid || !threadsIsValid || !processesIsValid || !tileWorkersIsValid ||
+        !coordinatorIsValid || !minWorkersIsValid || !cancelIsValid) {
+        std::cerr << "invalid arguments, see --help" << std::endl;
+        return EXIT_BAD_ARGUMENTS;
+    }
+
+    MandelBrotRenderer::CoordValue originX = MandelBrotRenderer::generateDoubleAsString(preciseX.toDouble());
+    MandelBrotRenderer::CoordValue originY = MandelBrotRenderer::generateDoubleAsString(preciseY.toDouble());
+    const int halfWidth = width / 2;
+    const int halfHeight = height / 2;
+    const RenderJobRequest request { RegionAttributes(scale, originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                                      preciseX, preciseY,
+#endif
+                                                      -halfWidth, width - halfWidth, -halfHeight, height - halfHeight, height),
+                                     static_cast<MandelBrotRenderer::internalDataType>(numericType),
+                                     numPasses,
+                                     MandelBrotRenderer::createColormap(MandelBrotRenderer::DefaultColormapSize),
+                                     1 };
+
+    //the pool only starts its threads once a job is submitted
+    RenderJobPool jobPool(numThreads);
+    std::unique_ptr<ProcessRenderPool> processPool;
+    if (numProcesses > 0) {
+        processPool = std::make_unique<ProcessRenderPool>(numProcesses);
+    }
+    std::unique_ptr<TileCoordinator> tileCoordinator;
+    if (parser.isSet("coordinator")) {
+        tileCoordinator = std::make_unique<TileCoordinator>();
+        if (!tileCoordinator->listen(coordinatorAddress, coordinatorPort)) {
+            std::cerr << "the tile coordinator could not listen on " << parser.value("coordinator").toStdString() << std::endl;
+            return EXIT_RENDER_FAILED;
+        }
+        //the port is chosen by the system when 0 is given
+        std::cout << "coordinator: " << coordinatorAddress.toString().toStdString() << ":" << tileCoordinator->getPort() << std::endl;
+    }
+    if (numTileWorkers > 0) {
+        if (!tileCoordinator) {
+            tileCoordinator = std::make_unique<TileCoordinator>();
+        }
+        if (tileCoordinator->startLocalWorkers(numTileWorkers) == 0) {
+            std::cerr << "the tile coordinator could not start its local workers" << std::endl;
+            return EXIT_RENDER_FAILED;
+        }
+    }
+    CommandLineRenderer renderer(jobPool, request, parser.value("output"));
+    renderer.setProcessPool(processPool.get());
+    renderer.setTileCoordinator(tileCoordinator.get());
+    if (parser.isSet("coordinator")) {
+        renderer.setMinTileWorkers(minTileWorkers);
+    }
+    renderer.setVerified(parser.isSet("verify"));
+    renderer.setCancelAfter(cancelAfterInMs);
+    renderer.start();
+    QCoreApplication::exec();
+    return renderer.getExitCode();
+}
+
+/*
+ * The throughput of the segment hand-offs with the global lock the segments
+ * used to take in every constructor, copy, move and clear (before), then
+ * with their atomic counters alone (after), and the contention on that lock
+ */
+void CommandLineRenderer::runSegmentBenchmark(int numThreads)
+{
+    const SharedTaskParameters parameters { 0, RegionAttributes(), nullptr,
+                                            MandelBrotRenderer::FrameBuffer { nullptr, 0, 0, 0 },
+                                            MandelBrotRenderer::noReusedSamples, MandelBrotRenderer::noPreviewSamples };
+    QMutex globalMutex;
+    const SegmentBenchmarkCounters locked =
+            runSegmentHandOffs(parameters, numThreads, &globalMutex, SEGMENT_BENCHMARK_DURATION_IN_MS);
+    const SegmentBenchmarkCounters unlocked =
+            runSegmentHandOffs(parameters, numThreads, nullptr, SEGMENT_BENCHMARK_DURATION_IN_MS);
+
+    const auto perSecond = [](qint64 handOffs) { return handOffs * 1000 / SEGMENT_BENCHMARK_DURATION_IN_MS; };
+    std::cout << "threads: " << numThreads << std::endl;
+    std::cout << "hand-offs per second, global lock: " << perSecond(locked.handOffs)
+              << ", atomic counters: " << perSecond(unlocked.handOffs) << std::endl;
+    std::cout << "global lock acquisitions: " << locked.lockAcquisitions
+              << ", contended: " << locked.contendedAcquisitions
+              << ", wait time (ms): " << locked.lockWaitTimeInNs / 1000000 << std::endl;
+}
+
+void CommandLineRenderer::renderDone(int doneJobId, const QImage& image)
+{
+    if (doneJobId == referenceJobId) {
+        verifyChecksum(image);
+    } else if (doneJobId == jobId && !renderIsOffloaded()) {
+        finishRender(image);
+    }
+}
+
+void CommandLineRenderer::renderCancelled(int cancelledJobId)
+{
+    if (cancelledJobId == referenceJobId) {
+        exitCode = EXIT_RENDER_FAILED;
+        QCoreApplication::quit();
+    } else if (cancelledJobId == jobId && !renderIsOffloaded()) {
+        reportCancellation();
+    }
+}
+
+void CommandLineRenderer::offloadedRenderDone(const QImage& image)
+{
+    finishRender(image);
+}
+
+void CommandLineRenderer::offloadedRenderCancelled()
+{
+    reportCancellation();
+}
+
+void CommandLineRenderer::offloadedRenderFailed(const QString& reason)
+{
+    std::cerr << "render failed: " << reason.toStdString() << std::endl;
+    exitCode = EXIT_RENDER_FAILED;
+    QCoreApplication::quit();
+}
+
+void CommandLineRenderer::finishRender(const QImage& image)
+{
+    const qint64 elapsed = clock.elapsed();
+    checksum = MandelBrotRenderer::computeChecksum(image);
+    std::cout << "size: " << image.width() << "x" << image.height() << std::endl;
+    std::cout << "type: " << MandelBrotRenderer::toUnderlyingType(request.numericType) << std::endl;
+    std::cout << "passes: " << request.numPasses << std::endl;
+    printRenderPath();
+    if (processPool != nullptr) {
+        std::cout << "helper restarts: " << processPool->getHelperRestartCount() << std::endl;
+    } else if (tileCoordinator != nullptr) {
+        std::cout << "reissued leases: " << tileCoordinator->getReissuedLeaseCount() << std::endl;
+    }
+    std::cout << "time (ms): " << elapsed << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+
+    exitCode = EXIT_SUCCESS_CODE;
+    if (!outputFile.isEmpty() && !image.save(outputFile)) {
+        std::cerr << "could not write " << outputFile.toStdString() << std::endl;
+        exitCode = EXIT_SAVE_FAILED;
+    }
+
+    //an image of the job pool is its own reference
+    if (verified && renderIsOffloaded() && exitCode == EXIT_SUCCESS_CODE) {
+        referenceJobId = jobPool.submit(request);
+        return;
+    }
+    QCoreApplication::quit();
+}
+
+void CommandLineRenderer::reportCancellation()
+{
+    if (cancelClock.isValid()) {
+        constexpr double NS_IN_ONE_MS = 1000000.0;
+        std::cout << "type: " << MandelBrotRenderer::toUnderlyingType(request.numericType) << std::endl;
+        std::cout << "passes: " << request.numPasses << std::endl;
+        printRenderPath();
+        std::cout << "cancelled after (ms): " << clock.elapsed() << std::endl;
+        std::cout << "cancel latency (ms): " << static_cast<double>(cancelClock.nsecsElapsed()) / NS_IN_ONE_MS << std::endl;
+        exitCode = EXIT_SUCCESS_CODE;
+    } else {
+        exitCode = EXIT_RENDER_FAILED;
+    }
+    QCoreApplication::quit();
+}
+
+void CommandLineRenderer::printRenderPath() const
+{
+    if (processPool != nullptr) {
+        std::cout << "processes: " << processPool->getNumHelperProcesses() << std::endl;
+    } else if (tileCoordinator != nullptr) {
+        std::cout << "tile workers: " << tileCoordinator->getNumWorkers() << std::endl;
+    } else {
+        std::cout << "threads: " << jobPool.getNumWorkerThreads() << std::endl;
+    }
+}
+
+void CommandLineRenderer::verifyChecksum(const QImage& referenceImage)
+{
+    const qint64 referenceChecksum = MandelBrotRenderer::computeChecksum(referenceImage);
+    std::cout << "reference checksum: " << referenceChecksum << std::endl;
+    if (referenceChecksum != checksum) {
+        std::cerr << "the checksum differs from the one rendered by the worker threads" << std::endl;
+        exitCode = EXIT_CHECKSUM_MISMATCH;
+    }
+    QCoreApplication::quit();
+}
@@ -1,144 +1,108 @@
 #include "computeddatasegment.h"
 #include <QImage>
 #include <iostream>
-#include <QMutex>
-
-using MandelBrotRenderer::notYetInitializedValue;
 
 ComputedDataSegment::ComputedDataSegment() :
-        image(nullptr), rawDataSize(notYetInitializedValue), taskResults {nullptr, 0 },
+        parameters(nullptr), task { 0, 0, 0, 0, MandelBrotRenderer::nonExistentThreadIndex },
+        taskResults { MandelBrotRenderer::FrameBuffer { nullptr, 0, 0, 0 }, 0 },
         segmentIndex(MandelBrotRenderer::nonExistentThreadIndex), consumed(false)
 {
-    QMutexLocker locker(getMutex());
     ++count;
 }
 
-int ComputedDataSegment::count = 0;
-
-ComputedDataSegment::ComputedDataSegment(RegionAttributes attributes,
-                    QImage *image,
-                    int segmentIndex,
-                    MandelBrotRenderer::MQuintVector& bufferedResultData,
-                    const RegionAttributes& bufferedAttributes)
-    :    image(image),
-
-         rawDataSize(attributes.computeRawDataSize()),
-         taskResults {nullptr, 0},
+std::atomic<int> ComputedDataSegment::count {0};
+std::atomic<int> ComputedDataSegment::copyCount {0};
+
+/*
+ * Results are written straight into the frame buffer,
+ * the segment only describes which part of it is computed
+ */
+ComputedDataSegment::ComputedDataSegment(const SharedTaskParameters& parameters,
+                    const MandelBrotRenderer::RenderTask& task,
+                    int segmentIndex)
+    :    parameters(&parameters),
+         task(task),
+         taskResults {parameters.frameBuffer, 0},
          segmentIndex(segmentIndex),
-         consumed(false),
-         attributes(attributes)
+         consumed(false)
 {
-    QMutexLocker locker(getMutex());
+    Q_ASSERT(task.jobId == parameters.jobId);
     ++count;
-
-    //TODO : check this for efficiency / memory leaks
-    if (bufferedResultData.size() == rawDataSize &&
-        attributes == bufferedAttributes)
-    {
-        //std::cout << "reusing raw results!" << std::endl;
-        rawResultData =  bufferedResultData;
-    }
-    else
-    {
-        //std::cout << "cannot reuse raw results!" << std::endl;
-        rawResultData = MandelBrotRenderer::MQuintVector(rawDataSize, qRgb(0, 0, 0));
-    }
-
-    taskResults.rawResultData = &rawResultData;
 }
 
 ComputedDataSegment::~ComputedDataSegment()
 {
-    QMutexLocker locker(getMutex());
     if (count-- == 0)
     {
         std::cout << "data segment delete error!" << std::endl;
     }
-    rawResultData.clear();
 }
 
 ComputedDataSegment::ComputedDataSegment(ComputedDataSegment&& other) noexcept
-    : image{ other.image },
-    rawDataSize{ other.rawDataSize },
-      rawResultData {std::move(other.rawResultData)},
-      taskResults { &rawResultData, other.taskResults.iterationSum},
+    : parameters{ other.parameters },
+      task(other.task),
+      taskResults { other.taskResults },
       segmentIndex(other.segmentIndex),
-
-      consumed(other.consumed),
-      attributes(std::move(other.attributes))
+      consumed(other.consumed)
 {
-    QMutexLocker locker(getMutex());
     ++count;
 }
 
 ComputedDataSegment::ComputedDataSegment(const ComputedDataSegment& other)
-    : image{ other.image },
-    rawDataSize{ other.rawDataSize },
-      rawResultData(other.rawResultData),
-      taskResults { &rawResultData, other.taskResults.iterationSum},
+    : parameters{ other.parameters },
+      task(other.task),
+      taskResults { other.taskResults },
       segmentIndex(other.segmentIndex),
-      consumed(other.consumed),
-      attributes(other.attributes)
+      consumed(other.consumed)
 {
-    QMutexLocker locker(getMutex());
     ++count;
+    ++copyCount;
 }
 
 ComputedDataSegment& ComputedDataSegment::operator=(const ComputedDataSegment& other)
 {
-    QMutexLocker locker(getMutex());
-    image = other.image;
-    rawDataSize = other.rawDataSize;
-    rawResultData = other.rawResultData;
-    taskResults.rawResultData = &rawResultData;
-    taskResults.iterationSum = other.taskResults.iterationSum;
+    ++copyCount;
+    parameters = other.parameters;
+    task = other.task;
+    taskResults = other.taskResults;
     segmentIndex = other.segmentIndex;
     consumed = other.consumed;
-    attributes = other.attributes;
 
     return *this;
 }
 
 ComputedDataSegment& ComputedDataSegment::operator=(ComputedDataSegment&& other) noexcept
 {
-    QMutexLocker locker(getMutex());
-    image = other.image;
-    rawDataSize = other.rawDataSize;
-    rawResultData = MandelBrotRenderer::MQuintVector(std::move(other.rawResultData));
-    taskResults.rawResultData = &rawResultData;
-    taskResults.iterationSum = other.taskResults.iterationSum;
+    parameters = other.parameters;
+    task = other.task;
+    taskResults = other.taskResults;
     segmentIndex = other.segmentIndex;
     consumed = other.consumed;
-    attributes = other.attributes;
 
     return *this;
 }
 
-QMutex* ComputedDataSegment::getMutex()
+/*
+ * Counter used to measure how often segments are duplicated
+ * rather than moved between workers, the mediator and the render thread
+ */
+int ComputedDataSegment::getCopyCount()
 {
-    static QMutex mutex;
-
-    return &mutex;
+    return copyCount.load();
 }
 
-void ComputedDataSegment::clearRawData()
+void ComputedDataSegment::resetCounters()
 {
-   QMutexLocker locker(getMutex());
-   rawResultData.fill(qRgb(0, 0, 0));
-   taskResults.iterationSum = 0;
+    copyCount.store(0);
 }
 
-const RegionAttributes& ComputedDataSegment::getAttributes() const
+void ComputedDataSegment::clearResults()
 {
-    return attributes;
+   taskResults.iterationSum = 0;
 }
 
-void ComputedDataSegment::ChangeRegionAttributes(const RegionAttributes& newRegionAttributes)
+void ComputedDataSegment::setTask(const MandelBrotRenderer::RenderTask& newTask)
 {
-    QMutexLocker locker(getMutex());
-    attributes = newRegionAttributes;
-    rawDataSize =  newRegionAttributes.computeRawDataSize();
-    rawResultData.resize(rawDataSize);
-    taskResults.rawResultData = &rawResultData;
+    Q_ASSERT(parameters != nullptr && newTask.jobId == parameters->jobId);
+    task = newTask;
 }
-
@@ -0,0 +1,178 @@
+#include "cputhrottle.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+CpuThrottle::CpuThrottle()
+    : enabled(false),
+      cpuSharePercent(DEFAULT_CPU_SHARE_PERCENT),
+      numWorkers(1),
+      dutyCycle(1.0),
+      stopping(false)
+{
+}
+
+CpuThrottle::~CpuThrottle()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopping = true;
+        changed.wakeAll();
+    }
+    if (cycleThread.joinable()) {
+        cycleThread.join();
+    }
+    gate.open();
+}
+
+void CpuThrottle::setLimit(bool enabled, int cpuSharePercent)
+{
+    QMutexLocker locker(&mutex);
+    this->enabled = enabled;
+    this->cpuSharePercent = std::max(1, std::min(100, cpuSharePercent));
+    updateDutyCycle();
+
+    //the duty cycle thread only exists once background mode has been used
+    if (enabled && !cycleThread.joinable()) {
+        cycleThread = std::thread(&CpuThrottle::run, this);
+    }
+    changed.wakeAll();
+}
+
+/*
+ * Called by the master render thread when the number of workers of a pass is decided
+ */
+void CpuThrottle::setWorkerCount(int numWorkers)
+{
+    QMutexLocker locker(&mutex);
+    this->numWorkers = std::max(1, numWorkers);
+    updateDutyCycle();
+    changed.wakeAll();
+}
+
+bool CpuThrottle::isEnabled() const
+{
+    QMutexLocker locker(&mutex);
+    return enabled;
+}
+
+int CpuThrottle::getCpuSharePercent() const
+{
+    QMutexLocker locker(&mutex);
+    return cpuSharePercent;
+}
+
+/*
+ * The number of workers which can run without exceeding the share (at least one)
+ */
+int CpuThrottle::limitWorkerCount(int numWorkers) const
+{
+    QMutexLocker locker(&mutex);
+    if (!enabled) {
+        return numWorkers;
+    }
+
+    const double cpus = QThread::idealThreadCount() * cpuSharePercent / 100.0;
+    return std::max(1, std::min(numWorkers, static_cast<int>(std::floor(cpus))));
+}
+
+double CpuThrottle::getDutyCycle() const
+{
+    QMutexLocker locker(&mutex);
+    return dutyCycle;
+}
+
+/*
+ * Called with the mutex held
+ */
+void CpuThrottle::updateDutyCycle()
+{
+    if (!enabled) {
+        dutyCycle = 1.0;
+        return;
+    }
+
+    const double cpus = QThread::idealThreadCount() * cpuSharePercent / 100.0;
+    dutyCycle = std::min(1.0, cpus / numWorkers);
+}
+
+void CpuThrottle::run()
+{
+    QMutexLocker locker(&mutex);
+    while (!stopping) {
+        if (dutyCycle >= 1.0) {
+            gate.open();
+            changed.wait(&mutex);
+            continue;
+        }
+
+        //a change of the limit ends the current period early
+        const auto runTime = static_cast<unsigned long>(std::lround(DUTY_CYCLE_PERIOD_IN_MS * dutyCycle));
+        gate.open();
+        if (changed.wait(&mutex, runTime) || stopping || dutyCycle >= 1.0) {
+            continue;
+        }
+        gate.close();
+        changed.wait(&mutex, DUTY_CYCLE_PERIOD_IN_MS - runTime);
+    }
+    gate.open();
+}
+
+BackgroundThreadPriority::BackgroundThreadPriority(bool enabled)
+    : lowered(false),
+      previousPriority(0)
+{
+    if (!enabled) {
+        return;
+    }
+
+#if defined(__linux__)
+    //only affects the calling thread, workers run in threads of their own
+#if defined(SCHED_IDLE)
+    sched_param parameters {};
+    if (pthread_setschedparam(pthread_self(), SCHED_IDLE, &parameters) == 0) {
+        lowered = true;
+        return;
+    }
+#endif
+    lowered = (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19) == 0);
+#elif defined(_WIN32)
+    //std::async may run the worker on a pooled thread, so its priority is restored afterwards
+    previousPriority = GetThreadPriority(GetCurrentThread());
+    lowered = (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_IDLE) != 0);
+#endif
+}
+
+/*
+ * Nothing is restored on Linux: an unprivileged thread can neither leave
+ * SCHED_IDLE nor lower its nice value again (RLIMIT_NICE is 0 by default),
+ * and with libstdc++ std::launch::async starts a new thread for every worker,
+ * so the lowered thread ends with it
+ */
+BackgroundThreadPriority::~BackgroundThreadPriority()
+{
+    if (!lowered) {
+        return;
+    }
+
+#if defined(_WIN32)
+    //code run later on the same pooled thread must not inherit the background priority
+    if (SetThreadPriority(GetCurrentThread(), previousPriority) == 0) {
+        std::cout << "Could not restore the priority of a worker thread: " << GetLastError() << std::endl;
+    }
+#endif
+}
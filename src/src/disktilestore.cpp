@@ -0,0 +1,261 @@
+#include "disktilestore.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+
+static const QString packFileSuffix = QStringLiteral(".tiles");
+
+DiskTileStore::DiskTileStore()
+    : readOnly(true),
+      sizeLimit(DEFAULT_SIZE_LIMIT_IN_BYTES),
+      usedSize(0),
+      packCount(0)
+{
+    static_assert(sizeof(TileRecord) == 56, "tile records have a fixed layout");
+}
+
+DiskTileStore::~DiskTileStore()
+{
+    close();
+}
+
+QString DiskTileStore::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/tiles";
+}
+
+/*
+ * Index the packs found in the directory (created if needed), packs which can't be
+ * used are skipped (and removed unless the store is read only)
+ */
+bool DiskTileStore::open(const QString& directory, bool readOnly)
+{
+    close();
+
+    QDir storeDirectory(directory);
+    if (!storeDirectory.exists() && (readOnly || !storeDirectory.mkpath("."))) {
+        return false;
+    }
+
+    this->directory = directory;
+    this->readOnly = readOnly;
+
+    if (!readOnly) {
+        removeStaleTemporaryFiles(storeDirectory);
+    }
+
+    const QFileInfoList packFiles = storeDirectory.entryInfoList(QStringList("*" + packFileSuffix), QDir::Files, QDir::Time);
+    for (const auto& i : packFiles) {
+        if (!loadPack(i.absoluteFilePath(), i.lastModified().toMSecsSinceEpoch()) && !readOnly) {
+            QFile::remove(i.absoluteFilePath());
+        }
+    }
+
+    evictPacks();
+    return true;
+}
+
+/*
+ * The temporary files of packs whose writer crashed (QSaveFile adds a random suffix
+ * to the pack name), those of other processes sharing the store are still recent
+ */
+void DiskTileStore::removeStaleTemporaryFiles(const QDir& storeDirectory)
+{
+    const qint64 staleBefore = QDateTime::currentMSecsSinceEpoch() - STALE_TEMPORARY_FILE_AGE_IN_MS;
+    const QFileInfoList temporaryFiles = storeDirectory.entryInfoList(QStringList("*" + packFileSuffix + ".*"), QDir::Files);
+    for (const auto& i : temporaryFiles) {
+        if (i.lastModified().toMSecsSinceEpoch() < staleBefore) {
+            QFile::remove(i.absoluteFilePath());
+        }
+    }
+}
+
+void DiskTileStore::close()
+{
+    index.clear();
+    for (auto& i : packs) {
+        i.file->unmap(const_cast<uchar *>(i.data));
+        i.file->close();
+    }
+    packs.clear();
+    usedSize = 0;
+    directory.clear();
+}
+
+/*
+ * The pixels of a stored tile, valid until the store is closed or trimmed
+ */
+const uint* DiskTileStore::find(const TileKey& key)
+{
+    auto found = index.find(key);
+    if (found == index.end()) {
+        return nullptr;
+    }
+
+    Pack& pack = *found->second.pack;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    //the modification time of the pack is its last use in the next session (see open())
+    if (!readOnly && now - pack.lastUsed >= ACCESS_TIME_RESOLUTION_IN_MS) {
+        pack.file->setFileTime(QDateTime::fromMSecsSinceEpoch(now), QFileDevice::FileModificationTime);
+    }
+    pack.lastUsed = now;
+    return reinterpret_cast<const uint *>(pack.data + found->second.offset);
+}
+
+bool DiskTileStore::contains(const TileKey& key) const
+{
+    return (index.find(key) != index.end());
+}
+
+/*
+ * Write the tiles into a new pack, only tiles not stored yet should be given
+ */
+bool DiskTileStore::storeTiles(const std::vector<std::pair<TileKey, const uint*>>& newTiles)
+{
+    if (!isOpen() || readOnly || newTiles.empty()) {
+        return false;
+    }
+
+    const auto tileCount = static_cast<quint32>(newTiles.size());
+    const qint64 indexSize = static_cast<qint64>(sizeof(PackHeader) + tileCount * sizeof(TileRecord));
+    const qint64 pixelDataStart = ((indexSize + PIXEL_DATA_ALIGNMENT - 1) / PIXEL_DATA_ALIGNMENT) * PIXEL_DATA_ALIGNMENT;
+
+    QByteArray packIndex(static_cast<int>(pixelDataStart), '\0');
+    const PackHeader header { PACK_MAGIC, PACK_VERSION, static_cast<quint32>(TileCache::TILE_SIZE_IN_PIXELS), tileCount };
+    std::memcpy(packIndex.data(), &header, sizeof(header));
+    for (quint32 i = 0; i < tileCount; ++i) {
+        const TileRecord record = toRecord(newTiles[i].first,
+                                           static_cast<quint64>(pixelDataStart) + i * TileCache::TILE_SIZE_IN_BYTES);
+        std::memcpy(packIndex.data() + sizeof(PackHeader) + i * sizeof(TileRecord), &record, sizeof(record));
+    }
+
+    const QString fileName = QString::number(QDateTime::currentMSecsSinceEpoch(), 16) + "-" +
+                             QString::number(QCoreApplication::applicationPid()) + "-" +
+                             QString::number(++packCount) + packFileSuffix;
+    const QString path = QDir(directory).filePath(fileName);
+
+    //the pack only appears under its name once it has been written completely
+    QSaveFile packFile(path);
+    if (!packFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    bool written = (packFile.write(packIndex) == packIndex.size());
+    for (const auto& i : newTiles) {
+        if (!written) {
+            break;
+        }
+        const auto size = static_cast<qint64>(TileCache::TILE_SIZE_IN_BYTES);
+        written = (packFile.write(reinterpret_cast<const char *>(i.second), size) == size);
+    }
+    if (!written) {
+        packFile.cancelWriting();
+        return false;
+    }
+    if (!packFile.commit() || !loadPack(path, QDateTime::currentMSecsSinceEpoch())) {
+        return false;
+    }
+
+    evictPacks();
+    return true;
+}
+
+void DiskTileStore::setSizeLimit(qint64 bytes)
+{
+    sizeLimit = bytes;
+    evictPacks();
+}
+
+/*
+ * Map a pack and add its tiles to the index, tiles also found in an earlier pack are ignored
+ */
+bool DiskTileStore::loadPack(const QString& path, qint64 lastUsed)
+{
+    std::unique_ptr<QFile> file(new QFile(path));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size = file->size();
+    const uchar* data = (size >= static_cast<qint64>(sizeof(PackHeader))) ? file->map(0, size) : nullptr;
+    if (data == nullptr) {
+        return false;
+    }
+
+    PackHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    //the pack may be corrupt, the sizes are compared without sums which could overflow
+    const quint64 fileSize = static_cast<quint64>(size);
+    const quint64 indexSize = static_cast<quint64>(sizeof(PackHeader)) + static_cast<quint64>(header.tileCount) * sizeof(TileRecord);
+    bool valid = (header.magic == PACK_MAGIC && header.version == PACK_VERSION &&
+                  header.tileSizeInPixels == static_cast<quint32>(TileCache::TILE_SIZE_IN_PIXELS) &&
+                  indexSize <= fileSize && fileSize >= TileCache::TILE_SIZE_IN_BYTES);
+
+    std::vector<TileRecord> records(valid ? header.tileCount : 0);
+    for (quint32 i = 0; valid && i < header.tileCount; ++i) {
+        std::memcpy(&records[i], data + sizeof(PackHeader) + i * sizeof(TileRecord), sizeof(TileRecord));
+        valid = (records[i].offset % sizeof(uint) == 0 &&
+                 records[i].offset <= fileSize - TileCache::TILE_SIZE_IN_BYTES);
+    }
+
+    if (!valid) {
+        file->unmap(const_cast<uchar *>(data));
+        return false;
+    }
+
+    packs.push_back(Pack { std::move(file), data, size, lastUsed });
+    auto pack = std::prev(packs.end());
+    for (const auto& i : records) {
+        index.emplace(fromRecord(i), Location { pack, i.offset });
+    }
+    usedSize += size;
+    return true;
+}
+
+void DiskTileStore::removePack(PackList::iterator pack)
+{
+    for (auto i = index.begin(); i != index.end(); ) {
+        i = (i->second.pack == pack) ? index.erase(i) : std::next(i);
+    }
+
+    usedSize -= pack->size;
+    pack->file->unmap(const_cast<uchar *>(pack->data));
+    pack->file->close();
+    //other processes sharing the store keep their mapping of the pack
+    QFile::remove(pack->file->fileName());
+    packs.erase(pack);
+}
+
+void DiskTileStore::evictPacks()
+{
+    if (readOnly) {
+        return;
+    }
+
+    while (usedSize > sizeLimit && !packs.empty()) {
+        removePack(std::min_element(packs.begin(), packs.end(),
+                                    [](const Pack& a, const Pack& b) { return a.lastUsed < b.lastUsed; }));
+    }
+}
+
+DiskTileStore::TileRecord DiskTileStore::toRecord(const TileKey& key, quint64 offset)
+{
+    return TileRecord { key.scaleFactor, key.tileX, key.tileY, key.phaseX, key.phaseY,
+                        static_cast<qint32>(key.settings.numericType), key.settings.maxIterations,
+                        static_cast<qint32>(key.settings.set), key.settings.colorMapSize, offset };
+}
+
+TileKey DiskTileStore::fromRecord(const TileRecord& record)
+{
+    return TileKey { record.scaleFactor, record.phaseX, record.phaseY, record.tileX, record.tileY,
+                     TileRenderSettings { static_cast<MandelBrotRenderer::internalDataType>(record.numericType),
+                                          record.maxIterations,
+                                          static_cast<MandelBrotRenderer::setType>(record.set),
+                                          record.colorMapSize } };
+}
@@ -0,0 +1,75 @@
+#include "focustaskqueue.h"
+
+#include <algorithm>
+
+/*
+ * Cut the area into tiles, only to be called while no workers are running
+ */
+void FocusTaskQueue::prepare(const QRect& area)
+{
+    prepare(std::vector<QRect> { area });
+}
+
+/*
+ * Several (non overlapping) areas, e.g. the strips exposed by panning
+ */
+void FocusTaskQueue::prepare(const std::vector<QRect>& areas)
+{
+    QMutexLocker locker(&mutex);
+    queuedTiles.clear();
+
+    for (const auto& i : areas) {
+        queueTiles(i);
+    }
+    active.store(true);
+}
+
+/*
+ * Called with the mutex held
+ */
+void FocusTaskQueue::queueTiles(const QRect& area)
+{
+    for (int y = area.top(); y <= area.bottom(); y += TILE_SIZE_IN_PIXELS) {
+        for (int x = area.left(); x <= area.right(); x += TILE_SIZE_IN_PIXELS) {
+            queuedTiles.emplace_back(QRect(QPoint(x, y), QPoint(std::min(x + TILE_SIZE_IN_PIXELS - 1, area.right()),
+                                                               std::min(y + TILE_SIZE_IN_PIXELS - 1, area.bottom()))));
+        }
+    }
+}
+
+void FocusTaskQueue::deactivate()
+{
+    QMutexLocker locker(&mutex);
+    queuedTiles.clear();
+    active.store(false);
+}
+
+void FocusTaskQueue::setFocusPoint(const QPoint& point)
+{
+    QMutexLocker locker(&mutex);
+    focusPoint = point;
+}
+
+/*
+ * The queue is small (a few hundred tiles at most) and the focus point can move at
+ * any time, so the nearest tile is simply searched for on each request
+ */
+bool FocusTaskQueue::takeNextTile(QRect& tile)
+{
+    QMutexLocker locker(&mutex);
+    if (queuedTiles.empty()) {
+        return false;
+    }
+
+    auto distanceToFocus = [this](const QRect& r) { return (r.center() - focusPoint).manhattanLength(); };
+
+    auto nearest = std::min_element(queuedTiles.begin(), queuedTiles.end(),
+                                    [&](const QRect& a, const QRect& b) { return distanceToFocus(a) < distanceToFocus(b); });
+    tile = *nearest;
+
+    //order doesn't matter, swap with the last tile for a cheap removal
+    std::iter_swap(nearest, queuedTiles.end() - 1);
+    queuedTiles.pop_back();
+
+    return true;
+}
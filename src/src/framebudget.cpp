@@ -0,0 +1,118 @@
+#include "framebudget.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+
+constexpr FrameBudget::Plan FrameBudget::noPreview;
+
+FrameBudget::FrameBudget()
+    : measuredType(MandelBrotRenderer::internalDataType::unknownType)
+{
+}
+
+/*
+ * Passes are run in the order used by the render thread: the first pass, then
+ * the passes from numPasses / 2 on. The preview takes the first pass at the finest
+ * grid fitting the budget, followed by the next passes as long as they fit too
+ */
+FrameBudget::Plan FrameBudget::plan(const QSize& size, int numPasses, MandelBrotRenderer::internalDataType numericType,
+                                    int budgetInMs) const
+{
+    if (numericType != measuredType || numPasses < 2 || budgetInMs <= 0) {
+        return noPreview;
+    }
+
+    const double budgetInUs = budgetInMs * 1000.0;
+    int sampleStride = 1;
+    double firstPassCost = estimateCostInUs(0, countComputedPixels(size, sampleStride));
+    if (firstPassCost < 0.0) {
+        return noPreview;
+    }
+    while (firstPassCost > budgetInUs && sampleStride < MAX_SAMPLE_STRIDE) {
+        sampleStride *= 2;
+        firstPassCost = estimateCostInUs(0, countComputedPixels(size, sampleStride));
+    }
+
+    double usedBudget = firstPassCost;
+    int lastPreviewPass = 0;
+    for (int pass = numPasses / 2; pass < numPasses; ++pass) {
+        const double passCost = estimateCostInUs(pass, countComputedPixels(size, sampleStride));
+        if (passCost < 0.0 || usedBudget + passCost > budgetInUs) {
+            break;
+        }
+        usedBudget += passCost;
+        lastPreviewPass = pass;
+    }
+
+    if (sampleStride == 1 && lastPreviewPass == numPasses - 1) {
+        //the whole render fits the budget
+        return noPreview;
+    }
+    //the final pass always computes every pixel
+    return Plan { sampleStride, std::min(lastPreviewPass, numPasses - 2) };
+}
+
+/*
+ * Called once all workers of a (complete) pass are done
+ */
+void FrameBudget::recordPass(int pass, int sampleStride, const QSize& size, MandelBrotRenderer::internalDataType numericType,
+                             int64_t elapsedTimeInUs)
+{
+    Q_ASSERT(pass >= 0);
+    if (numericType != measuredType) {
+        //costs differ widely between numeric types
+        reset();
+        measuredType = numericType;
+    }
+
+    const int64_t computedPixels = countComputedPixels(size, sampleStride);
+    if (computedPixels <= 0) {
+        return;
+    }
+
+    if (pass >= static_cast<int>(pixelCostsInNs.size())) {
+        pixelCostsInNs.resize(static_cast<std::size_t>(pass) + 1, -1.0);
+    }
+
+    const double pixelCost = (static_cast<double>(elapsedTimeInUs) * 1000.0) / static_cast<double>(computedPixels);
+    double& meanCost = pixelCostsInNs[static_cast<std::size_t>(pass)];
+    meanCost = (meanCost < 0.0) ? pixelCost : (MEASUREMENT_WEIGHT * pixelCost + (1.0 - MEASUREMENT_WEIGHT) * meanCost);
+}
+
+void FrameBudget::reset()
+{
+    pixelCostsInNs.clear();
+    measuredType = MandelBrotRenderer::internalDataType::unknownType;
+}
+
+/*
+ * The pixels computed by a preview pass (in the centred coordinates of the tasks),
+ * each one also gives its value to the rest of its sampleStride wide block
+ */
+MandelBrotRenderer::SampleGrid FrameBudget::createSampleGrid(const QSize& size, int sampleStride)
+{
+    if (sampleStride <= 1) {
+        return MandelBrotRenderer::noPreviewSamples;
+    }
+
+    const int halfWidth = size.width() / 2;
+    const int halfHeight = size.height() / 2;
+    return MandelBrotRenderer::SampleGrid { sampleStride, -halfWidth, size.width() - halfWidth,
+                                            -halfHeight, size.height() - halfHeight };
+}
+
+double FrameBudget::estimateCostInUs(int pass, int64_t computedPixels) const
+{
+    if (pass >= static_cast<int>(pixelCostsInNs.size()) || pixelCostsInNs[static_cast<std::size_t>(pass)] < 0.0) {
+        return -1.0;
+    }
+    return pixelCostsInNs[static_cast<std::size_t>(pass)] * static_cast<double>(computedPixels) / 1000.0;
+}
+
+int64_t FrameBudget::countComputedPixels(const QSize& size, int sampleStride)
+{
+    const int64_t columns = (size.width() + sampleStride - 1) / sampleStride;
+    const int64_t lines = (size.height() + sampleStride - 1) / sampleStride;
+    return columns * lines;
+}
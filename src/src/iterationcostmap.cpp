@@ -0,0 +1,134 @@
+#include "iterationcostmap.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <utility>
+
+void IterationCostMap::reset(int firstLine, int lastLine)
+{
+    Q_ASSERT(lastLine >= firstLine);
+    this->firstLine = firstLine;
+    lineCosts.assign(static_cast<std::size_t>(lastLine - firstLine), 0);
+    meanLineCost = 0;
+}
+
+/*
+ * Called by worker threads, each pixel line is only
+ * ever computed by one worker during a pass so no locking is needed
+ */
+void IterationCostMap::recordLineCost(int y, int64_t iterations)
+{
+    const int index = y - firstLine;
+    if (index >= 0 && index < static_cast<int>(lineCosts.size())) {
+        lineCosts[static_cast<std::size_t>(index)] = (iterations > minimumLineCost) ? iterations : minimumLineCost;
+    }
+}
+
+/*
+ * Called once all workers of a pass are done, before the map is used for estimates
+ */
+void IterationCostMap::finalizeMeasurements()
+{
+    int64_t total = 0;
+    int64_t measuredLines = 0;
+    for (const auto& i : lineCosts) {
+        if (i > 0) {
+            total += i;
+            ++measuredLines;
+        }
+    }
+
+    meanLineCost = (measuredLines > 0) ? (total / measuredLines) : 0;
+}
+
+bool IterationCostMap::isUsable() const
+{
+    return (meanLineCost > 0);
+}
+
+int64_t IterationCostMap::getLineCost(int y) const
+{
+    const int index = y - firstLine;
+    int64_t cost = 0;
+    if (index >= 0 && index < static_cast<int>(lineCosts.size())) {
+        cost = lineCosts[static_cast<std::size_t>(index)];
+    }
+    return (cost > 0) ? cost : meanLineCost;
+}
+
+int64_t IterationCostMap::estimateCost(int fromY, int toY) const
+{
+    int64_t cost = 0;
+    for (int y = fromY; y < toY; ++y) {
+        cost += getLineCost(y);
+    }
+    return cost;
+}
+
+/*
+ * Find the line splitting [fromY, toY) into two ranges of roughly equal estimated cost
+ * (a line is included when at least half of its cost fits),
+ * both of which contain at least one line; falls back to the geometric midpoint
+ */
+int IterationCostMap::findCostMidpoint(int fromY, int toY) const
+{
+    const int geometricMidpoint = fromY + (toY - fromY) / 2;
+    if (!isUsable() || toY - fromY < 2) {
+        return geometricMidpoint;
+    }
+
+    const int64_t halfCost = estimateCost(fromY, toY) / 2;
+    int64_t cost = 0;
+    int y = fromY;
+    while (y < toY - 1 && cost + getLineCost(y) / 2 <= halfCost) {
+        cost += getLineCost(y++);
+    }
+
+    return std::max(y, fromY + 1);
+}
+
+/*
+ * Move the inner values of a sorted list of segment boundaries so that every
+ * segment has the same estimated cost, the outer boundaries are kept as is
+ */
+void IterationCostMap::balanceBoundaries(std::vector<int>& boundaries) const
+{
+    if (!isUsable() || boundaries.size() < 3) {
+        return;
+    }
+
+    const int numSegments = static_cast<int>(boundaries.size()) - 1;
+    const int firstY = boundaries.front();
+    const int lastY = boundaries.back();
+
+    if (lastY - firstY < numSegments) {
+        return;
+    }
+
+    const int64_t totalCost = estimateCost(firstY, lastY);
+    int64_t cost = 0;
+    int y = firstY;
+
+    for (int i = 1; i < numSegments; ++i) {
+        const int64_t requiredCost = (totalCost * i) / numSegments;
+        //leave at least one line for each of the remaining segments
+        const int latestBoundary = lastY - (numSegments - i);
+
+        while (y < latestBoundary && cost + getLineCost(y) / 2 <= requiredCost) {
+            cost += getLineCost(y++);
+        }
+        if (y <= boundaries[static_cast<std::size_t>(i - 1)]) {
+            cost += getLineCost(y++);
+        }
+
+        boundaries[static_cast<std::size_t>(i)] = y;
+    }
+}
+
+void IterationCostMap::swap(IterationCostMap& other) noexcept
+{
+    std::swap(firstLine, other.firstLine);
+    lineCosts.swap(other.lineCosts);
+    std::swap(meanLineCost, other.meanLineCost);
+}
@@ -49,6 +49,9 @@
 ****************************************************************************/
 
 #include "mandelbrotwidget.h"
+#include "processrenderpool.h"
+#include "tileserver.h"
+#include "tileworker.h"
 
 #include <QApplication>
 #include <QSharedMemory>
@@ -60,6 +63,20 @@ static void restrictToOneInstance(QSharedMemory& sharedSpace);
 //! [0]
 int main(int argc, char *argv[])
 {
+    //a helper process rendering part of a shared job, no GUI and not a second instance
+    if (ProcessRenderPool::isHelperInvocation(argc, argv)) {
+        QCoreApplication helperApp(argc, argv);
+        return ProcessRenderPool::runHelper(QCoreApplication::arguments());
+    }
+    if (TileWorker::isWorkerInvocation(argc, argv)) {
+        QCoreApplication workerApp(argc, argv);
+        return TileWorker::runWorker(QCoreApplication::arguments());
+    }
+    if (TileServer::isServerInvocation(argc, argv)) {
+        QCoreApplication serverApp(argc, argv);
+        return TileServer::runServer(QCoreApplication::arguments());
+    }
+
     QApplication app(argc, argv);
 
     QApplication::setStyle(QStyleFactory::create("fusion"));
@@ -1,5 +1,9 @@
 #include <QColor>
+#include <QImage>
+#include <QThread>
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 
 #include "mandelbrotrenderer.h"
 
@@ -48,6 +52,18 @@ uint rgbFromWaveLength(double wave)
     return qRgb(int(r * 255), int(g * 255), int(b * 255));
 }
 
+/*
+ * The visible spectrum spread over the colormap
+ */
+colorMapStore createColormap(int size)
+{
+    colorMapStore colormap(static_cast<std::size_t>(size));
+    uint count = 0;
+    for (auto&  i : colormap)
+        i = rgbFromWaveLength(380.0 + ((count++) * 400.0 / size));
+    return colormap;
+}
+
 const QString & getBoolValueAsString(bool value, boolDescriptionMode mode)
 {
     static const QString onString("On");
@@ -58,6 +74,69 @@ const QString & getBoolValueAsString(bool value, boolDescriptionMode mode)
         (value ? trueString : falseString));
 }
 
+bool typeIsCompiledIn(internalDataType numericType)
+{
+    switch (numericType) {
+    case internalDataType::singlePrecisionFloat:
+    case internalDataType::doublePrecisionFloat:
+    case internalDataType::int32:
+    case internalDataType::int64:
+        return true;
+    case internalDataType::customFloat20:
+    case internalDataType::float20dd:
+    case internalDataType::float30dd:
+    case internalDataType::float50dd:
+#if (USE_BOOST_MULTIPRECISION == 1)
+        return true;
+#else
+        return false;
+#endif
+    case internalDataType::float80:
+    case internalDataType::float128:
+    case internalDataType::int128:
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+        return true;
+#else
+        return false;
+#endif
+    case internalDataType::unknownType:
+        break;
+    }
+    return false;
+}
+
+int calculateInitialNumThreads()
+{
+    return (std::min<int>(MAX_NUM_WORKER_THREADS,
+             MIN_NUM_UNUSED_THREADS < QThread::idealThreadCount() ? QThread::idealThreadCount() - MIN_NUM_UNUSED_THREADS : 1 ));
+}
+
+/*
+ * The sum of the pixel bytes of each line (the padding at the end of the lines
+ * of arena buffers holds stale bytes and is left out)
+ */
+qint64 computeChecksum(const QImage& image)
+{
+    qint64 imageChecksum = 0;
+    const int bytesPerPixelLine = image.width() * image.depth() / 8;
+
+    for (int y = 0; y < image.height(); ++y) {
+        const uchar* line = image.constScanLine(y);
+        imageChecksum = std::accumulate(line, line + bytesPerPixelLine, imageChecksum);
+    }
+    return imageChecksum;
+}
+
+/*
+ * Must be called by the thread owning the image, before any worker writes to it
+ * (bits() detaches the image from any shallow copies)
+ */
+FrameBuffer createFrameBuffer(QImage& image, int originX, int originY)
+{
+    Q_ASSERT(image.format() == QImage::Format_RGB32);
+    return FrameBuffer { image.bits(), image.bytesPerLine(), originX, originY };
+}
+
 QDataStream &operator <<(QDataStream &outputStream, const MandelBrotRenderer::RenderState& state)
 {
     outputStream << state.detailedDisplayEnabled << static_cast<qint32>(state.size.width());
@@ -57,6 +57,7 @@
 #include <QMenuBar>
 #include <QMessageBox>
 
+#include <algorithm>
 #include <cmath>
 
 #include <iostream>
@@ -77,10 +78,6 @@
 //! [0]
 const double DefaultScale = 0.00403897;
 
-const double ZoomInFactor = 0.8;
-const double ZoomOutFactor = 1 / ZoomInFactor;
-const int ScrollStep = 20;
-
 QString MandelbrotWidget::DefaultOriginX("-0.637011");
 QString MandelbrotWidget::DefaultOriginY("-0.0395159");
 
@@ -104,9 +101,12 @@ MandelbrotWidget::MandelbrotWidget(QWidget *parent)
 #endif
       pixmapScale(notYetInitializedDouble),
       curScale(notYetInitializedDouble), perPixelCoeff(notYetInitializedDouble),
-      scaleHasChanged(false), renderInProgress(false), usingUndoRedo(false), numericType(internalDataType::doublePrecisionFloat),
-      pauseMutexes(MAX_NUM_WORKER_THREADS, nullptr), paused(),
+      renderInProgress(false), usingUndoRedo(false),
+      pendingRequestFromUndoRedo(false), numericType(internalDataType::doublePrecisionFloat),
+      paused(),
       historyLog(std::make_unique<RenderHistory>(this)), unsavedChangesExist(false),
+      renderRequestTimer(new QTimer(this)), pendingServiceClass(renderServiceClass::final),
+      renderRequestsIssued(0), renderRequestsExecuted(0),
       parameterSpace(-1.5, 2.5, -2.0, 2.5)
 {
     thread.processSettingUpdate(settingsHandler.getSettings());
@@ -139,8 +139,6 @@ MandelbrotWidget::MandelbrotWidget(QWidget *parent)
 
     prepareMenuBar();
 
-    preparePauseLocks();
-
     setupLayout();
 
     setupLoggers();
@@ -160,6 +158,9 @@ void MandelbrotWidget::connectToComponents()
 
     connect(&thread, SIGNAL(renderedImage(const QImage*,double)), this, SLOT(updatePixmap(const QImage*,double)));
 
+    renderRequestTimer->setSingleShot(true);
+    connect(renderRequestTimer, SIGNAL(timeout()), this, SLOT(submitRenderRequest()));
+
     connect(this, SIGNAL(quitAll()), &thread, SLOT(quitApplication()));
     connect(this, SIGNAL(halt()), &thread, SLOT(haltComputations()));
 
@@ -179,13 +180,9 @@ void MandelbrotWidget::connectToComponents()
 
     connect(&thread, SIGNAL(renderStarting()), this, SLOT(disableFileMenu()));
     connect(&thread, SIGNAL(allDone()), this, SLOT(enableFileMenu()));
-}
 
-void MandelbrotWidget::preparePauseLocks()
-{
-    for (auto& i : pauseMutexes) {
-        i = new QMutex();
-    }
+    connect(&thread, SIGNAL(frameCompleted(QImage,QString,QString,double,int)),
+            historyLog.get(), SLOT(storeFrame(QImage,QString,QString,double,int)));
 }
 
 void MandelbrotWidget::prepareMenuBar()
@@ -229,6 +226,10 @@ void MandelbrotWidget::setupLayout()
     this->setCentralWidget(centralPlotArea);
     this->centralWidget()->setLayout(mandelbrotWidgetLayout);
 
+    //mouse move events are needed (without a button pressed) to follow the focus point of focused rendering
+    setMouseTracking(true);
+    centralPlotArea->setMouseTracking(true);
+
     mandelbrotWidgetLayout->addWidget(infoDisplayer);
 
     mandelbrotWidgetLayout->addWidget(progressBar);
@@ -274,6 +275,10 @@ void MandelbrotWidget::writeSettings()
         settingsHandler.getSettings().setValue("pixmapScale", pixmapScale);
     settingsHandler.getSettings().endGroup();
 
+    settingsHandler.getSettings().beginGroup("History");
+        settingsHandler.getSettings().setValue("frameMemoryInMB", static_cast<int>(historyLog->getFrameMemoryBudget() / (1024 * 1024)));
+    settingsHandler.getSettings().endGroup();
+
     //TODO automate this using the SettingsUser interface?
     thread.writeSettings();
     infoDisplayer->writeSettings();
@@ -308,7 +313,7 @@ RendererConfig MandelbrotWidget::generateConfigData()
     return (result);
 }
 
-void MandelbrotWidget::enforceConfigData(RendererConfig &newConfigData)
+void MandelbrotWidget::enforceConfigData(RendererConfig &newConfigData, bool refreshIfChanged)
 {
     RendererConfig originalConfig = generateConfigData();
     getInfoDisplayer()->setEnabled(newConfigData.getDetailedDisplayEnabled());
@@ -326,10 +331,33 @@ void MandelbrotWidget::enforceConfigData(RendererConfig &newConfigData)
     move(newConfigData.getPos());
     resize(newConfigData.getSize());
 
-    if (originalConfig != newConfigData) {
+    if (refreshIfChanged && originalConfig != newConfigData) {
         initiateRefresh();
     }
 }
+
+/*
+ * Show the image kept by the render history for the (just enforced) state, and let the render
+ * thread take it as the rendered view: it is only computed again if the settings it was
+ * rendered with differ from the current ones
+ */
+void MandelbrotWidget::presentHistoryFrame(const QImage& frame, int numPasses, MandelBrotRenderer::internalDataType numericType,
+                                           int colorMapSize)
+{
+    pixmap = QPixmap::fromImage(frame);
+    pixmapOffset = QPoint();
+    lastDragPos = QPoint();
+    pixmapScale = curScale;
+    update();
+
+    const ViewParameters view { originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                preciseOriginX, preciseOriginY,
+#endif
+                                curScale, size() };
+    thread.provideCachedView(ViewCacheKey { view, numPasses, numericType, colorMapSize }, frame);
+    initiateRefresh();
+}
 void MandelbrotWidget::prepareProgressBar()
 {
     progressBar->setMinimum(0);
@@ -448,7 +476,6 @@ void MandelbrotWidget::writeTransientStatusMessage(const QString& message, bool
 
 void MandelbrotWidget::pause()
 {
-    int locked = 0;
     if (paused.load())
     {
         return;
@@ -456,11 +483,7 @@ void MandelbrotWidget::pause()
     QMutexLocker locker(&mutex);
     paused.store(true);
 
-    for (auto& i : pauseMutexes)
-    {
-        i->lock();
-        ++locked;
-    }
+    pauseGate.close();
     thread.pauseTimer();
 }
 
@@ -474,12 +497,8 @@ void MandelbrotWidget::release(bool forceFlow)
     QMutexLocker locker(&mutex);
     paused.store(false);
 
-    for (auto& i : pauseMutexes) {
-        i->try_lock();
-        i->unlock();
-    }
+    pauseGate.open();
     thread.resumeTimer();
-    
 }
 
 void MandelbrotWidget::undo()
@@ -670,8 +689,8 @@ void MandelbrotWidget::paintEvent(QPaintEvent * /* event */)
 //! [4]
 
 //! [5]
-//    if (curScale == pixmapScale) {
-    if (scaleHasChanged) {
+    //until the pending render arrives, the previous image is shown scaled (and shifted) as a preview
+    if (curScale == pixmapScale) {
 //! [5] //! [6]
         painter.drawPixmap(pixmapOffset, pixmap);
 //! [6] //! [7]
@@ -690,7 +709,6 @@ void MandelbrotWidget::paintEvent(QPaintEvent * /* event */)
         painter.drawPixmap(exposed, pixmap, exposed);
         painter.restore();
     }
-    scaleHasChanged = false;
 //! [8] //! [9]
 
     QString text = tr("Use mouse wheel or the '+' and '-' keys to zoom. "
@@ -772,6 +790,13 @@ void MandelbrotWidget::mousePressEvent(QMouseEvent *event)
 //! [14]
 void MandelbrotWidget::mouseMoveEvent(QMouseEvent *event)
 {
+    if (thread.focusedRenderingEnabled()) {
+        //tiles nearest the cursor are computed first, (centred) coordinates as used by the renderer;
+        //the event may come from the central widget or its children, the rendered image spans this window
+        const QPoint focusPoint = (lastDragPos.isNull() ? mapFromGlobal(event->globalPos()) : lastDragPos);
+        thread.getFocusTaskQueue().setFocusPoint(focusPoint - QPoint(width() / 2, height() / 2));
+    }
+
     if (event->buttons() & Qt::LeftButton) {
         pixmapOffset += event->pos() - lastDragPos;
         lastDragPos = event->pos();
@@ -793,7 +818,7 @@ void MandelbrotWidget::mouseReleaseEvent(QMouseEvent *event)
 
         int deltaX = (width() - pixmap.width()) / 2 - pixmapOffset.x();
         int deltaY = (height() - pixmap.height()) / 2 - pixmapOffset.y();
-        scroll(deltaX, deltaY);
+        scroll(deltaX, deltaY, true);
         return;
     }
     
@@ -802,6 +827,13 @@ void MandelbrotWidget::mouseReleaseEvent(QMouseEvent *event)
     }
 }
 
+void MandelbrotWidget::leaveEvent(QEvent *event)
+{
+    //focus on the view centre when the cursor isn't over the image
+    thread.getFocusTaskQueue().resetFocusPoint();
+    QMainWindow::leaveEvent(event);
+}
+
 //TODO : this function needs revision to handle higher precision types properly
 void MandelbrotWidget::zoomToSelectedRectangle(QMouseEvent *event)
 {
@@ -822,7 +854,10 @@ void MandelbrotWidget::zoomToSelectedRectangle(QMouseEvent *event)
         scroll(centresTranslationX, centresTranslationY);
 
         zoom(scaleFactor);
-        resize(QSize(static_cast<int>(newWidth / scaleFactor), static_cast<int>(newHeight / scaleFactor)));
+        //a snapped zoom keeps the window size, so that the samples of the current view can be reused
+        if (!thread.snappedZoomEnabled()) {
+            resize(QSize(static_cast<int>(newWidth / scaleFactor), static_cast<int>(newHeight / scaleFactor)));
+        }
     }
 }
 
@@ -842,6 +877,12 @@ void MandelbrotWidget::processSettingUpdate(QSettings &settings)
         curScale = settings.value("curScale", DefaultScale).toDouble();
         pixmapScale = settings.value("pixmapScale", DefaultScale).toDouble();
     settings.endGroup();
+
+    settings.beginGroup("History");
+        historyLog->setFrameMemoryBudget(static_cast<std::size_t>(std::max(0, settings.value("frameMemoryInMB",
+                                         static_cast<int>(RenderHistory::DEFAULT_FRAME_MEMORY_BUDGET_IN_BYTES / (1024 * 1024))).toInt()))
+                                         * 1024 * 1024);
+    settings.endGroup();
 }
 //! [15]
 //!
@@ -1030,6 +1071,11 @@ void MandelbrotWidget::accomplishQuit()
 
 
 //! [17]
+/*
+ * The widget is updated at once, the render itself is submitted after a quiet period
+ * adapted to the pace of the requests: a request following the previous one closely
+ * is likely to be followed by another, which then replaces it before any work starts
+ */
 void MandelbrotWidget::executeRender(bool hideProgress)
 {
     getInfoDisplayer()->setRenderState(InformationDisplay::renderState::running);
@@ -1039,7 +1085,41 @@ void MandelbrotWidget::executeRender(bool hideProgress)
         toolsMenu->setEnabled(false);
         showProgress();
     }
-    if (!usingUndoRedo) {
+
+    pendingRequestFromUndoRedo = usingUndoRedo;
+    ++renderRequestsIssued;
+
+    const qint64 sinceLastRequest = lastRenderRequest.isValid() ? lastRenderRequest.restart() : kMaxQuietPeriodInMs;
+    if (!lastRenderRequest.isValid()) {
+        lastRenderRequest.start();
+    }
+
+    //requests within a burst are rendered as quick interactive previews
+    const bool interactive = (sinceLastRequest < kMaxQuietPeriodInMs);
+    int quietPeriod = 0;
+    if (interactive) {
+        quietPeriod = std::max(kMinQuietPeriodInMs, std::min(kMaxQuietPeriodInMs, static_cast<int>(sinceLastRequest * 3 / 2)));
+        if (lastRenderSubmission.isValid() && lastRenderSubmission.elapsed() >= kMaxQuietPeriodInMs) {
+            //keep the view live during a long interaction (e.g. resizing the window)
+            quietPeriod = 0;
+        }
+    }
+    pendingServiceClass = interactive ? renderServiceClass::interactive : renderServiceClass::final;
+    //a pending request is replaced by this one
+    renderRequestTimer->start(quietPeriod);
+}
+
+void MandelbrotWidget::submitRenderRequest()
+{
+    ++renderRequestsExecuted;
+    lastRenderSubmission.start();
+
+    const renderServiceClass serviceClass = pendingServiceClass;
+    if (serviceClass == renderServiceClass::interactive) {
+        //unless the interaction goes on, the final render follows
+        pendingServiceClass = renderServiceClass::final;
+        renderRequestTimer->start(kMaxQuietPeriodInMs);
+    } else if (!pendingRequestFromUndoRedo) {
         if (historyLog->saveState() && historyLog->undoIsPossible()) {
             unsavedChangesExist = true;
         }
@@ -1059,16 +1139,37 @@ void MandelbrotWidget::executeRender(bool hideProgress)
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
                 preciseOriginX, preciseOriginY,
 #endif
-                  curScale, size());
+                  curScale, size(), serviceClass);
+
+    outputToLog("Render requests issued : " + QString::number(renderRequestsIssued) +
+                ", executed : " + QString::number(renderRequestsExecuted) +
+                ((serviceClass == renderServiceClass::interactive) ? " (interactive)" : ""));
+}
+
+/*
+ * The nearest power of two zoom (at least one step in the requested direction),
+ * a view zoomed by a power of two around a whole pixel keeps some of the samples
+ * of the previous view, which the render thread then reuses
+ */
+double MandelbrotWidget::snapZoomFactor(double zoomFactor)
+{
+    if (zoomFactor <= 0.0 || zoomFactor == 1.0) {
+        return zoomFactor;
+    }
+
+    const double steps = std::max(1.0, std::round(std::abs(std::log2(zoomFactor))));
+    return std::pow((zoomFactor < 1.0) ? 0.5 : 2.0, steps);
 }
 
 void MandelbrotWidget::zoom(double zoomFactor)
 {
+    if (thread.snappedZoomEnabled()) {
+        zoomFactor = snapZoomFactor(zoomFactor);
+    }
     curScale *= zoomFactor;
     update();
     executeRender();
     outputToLog("New operation : zoom");
-    scaleHasChanged = true;
 }
 
 void MandelbrotWidget::enableOptions()
@@ -1099,8 +1200,12 @@ QString MandelbrotWidget::computeDeltaWithHigherPrecision(QString& value, int de
 }
 
 //! [18]
-void MandelbrotWidget::scroll(int deltaX, int deltaY)
+void MandelbrotWidget::scroll(int deltaX, int deltaY, bool previewShown)
 {
+    if (!previewShown) {
+        pixmapOffset -= QPoint(deltaX, deltaY);
+    }
+
 #if (USE_BOOST_MULTIPRECISION == 1 || defined(__GNUC__))
     preciseOriginX = computeDeltaWithHigherPrecision(originX, deltaX, curScale);
     preciseOriginY = computeDeltaWithHigherPrecision(originY, deltaY, curScale);
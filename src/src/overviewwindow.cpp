@@ -0,0 +1,97 @@
+#include "overviewwindow.h"
+
+#include <QPainter>
+#include <QPixmap>
+
+#include <algorithm>
+
+#include "regionattributes.h"
+#include "renderjobpool.h"
+#include "renderthread.h"
+
+OverviewWindow::OverviewWindow(RenderThread* masterThread)
+    : masterThread(masterThread),
+      jobId(-1),
+      scaleFactor(0.0),
+      numPasses(0)
+{
+    setWindowTitle("Overview Map");
+    setWindowFlags(Qt::Window | Qt::WindowTitleHint | Qt::WindowCloseButtonHint | Qt::CustomizeWindowHint);
+    setAlignment(Qt::AlignCenter);
+    setText("No view rendered yet");
+    resize(QSize(OVERVIEW_WIDTH, OVERVIEW_WIDTH * 3 / 4));
+
+    //the pool signals from its worker threads, the result is queued to this thread
+    connect(&masterThread->getJobPool(), SIGNAL(jobDone(int,QImage)), this, SLOT(overviewDone(int,QImage)));
+}
+
+/*
+ * Called for each completed view
+ */
+void OverviewWindow::setView(const QImage& image, const QString& originX, const QString& originY, double scaleFactor, int numPasses)
+{
+    viewSize = image.size();
+    this->originX = originX;
+    this->originY = originY;
+    this->scaleFactor = scaleFactor;
+    this->numPasses = numPasses;
+
+    if (isVisible()) {
+        renderOverview();
+    }
+}
+
+void OverviewWindow::showEvent(QShowEvent* event)
+{
+    QLabel::showEvent(event);
+    renderOverview();
+}
+
+void OverviewWindow::renderOverview()
+{
+    if (viewSize.isEmpty()) {
+        return;
+    }
+
+    RenderJobPool& jobPool = masterThread->getJobPool();
+    if (jobId >= 0) {
+        //the view moved on before the overview of the previous one was done
+        jobPool.cancel(jobId);
+    }
+
+    const int width = OVERVIEW_WIDTH;
+    const int height = std::max(1, OVERVIEW_WIDTH * viewSize.height() / viewSize.width());
+    const double overviewScale = scaleFactor * OVERVIEW_ZOOM_FACTOR * viewSize.width() / width;
+    MandelBrotRenderer::CoordValue overviewOriginX = originX;
+    MandelBrotRenderer::CoordValue overviewOriginY = originY;
+    const RenderJobRequest request { RegionAttributes(overviewScale, overviewOriginX, overviewOriginY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                                      originX, originY,
+#endif
+                                                      -width / 2, width - width / 2, -height / 2, height - height / 2, height),
+                                     masterThread->getRendererData().numericType,
+                                     numPasses,
+                                     masterThread->getColormap(),
+                                     OVERVIEW_JOB_WEIGHT };
+    jobId = jobPool.submit(request);
+}
+
+void OverviewWindow::overviewDone(int doneJobId, const QImage& image)
+{
+    if (doneJobId != jobId) {
+        return;
+    }
+    jobId = -1;
+
+    //the view is the centre of the overview
+    QImage overview = image;
+    QPainter painter(&overview);
+    painter.setPen(Qt::white);
+    const int viewWidth = overview.width() / OVERVIEW_ZOOM_FACTOR;
+    const int viewHeight = overview.height() / OVERVIEW_ZOOM_FACTOR;
+    painter.drawRect((overview.width() - viewWidth) / 2, (overview.height() - viewHeight) / 2,
+                     std::max(viewWidth, 1), std::max(viewHeight, 1));
+    painter.end();
+
+    setPixmap(QPixmap::fromImage(overview));
+}
@@ -0,0 +1,51 @@
+#include "pausegate.h"
+
+#include "mandelbrotrenderer.h"
+
+using MandelBrotRenderer::storeMaximum;
+
+void PauseGate::close()
+{
+    QMutexLocker locker(&mutex);
+    if (!closed.load()) {
+        transitionTimer.start();
+        closed.store(true, std::memory_order_release);
+    }
+}
+
+void PauseGate::open()
+{
+    QMutexLocker locker(&mutex);
+    if (closed.load()) {
+        transitionTimer.start();
+        closed.store(false, std::memory_order_release);
+        opened.wakeAll();
+    }
+}
+
+/*
+ * Called by a worker thread after isClosed() returned true,
+ * blocks until the gate is opened
+ */
+void PauseGate::waitWhileClosed()
+{
+    QMutexLocker locker(&mutex);
+    if (!closed.load()) {
+        return;
+    }
+
+    storeMaximum(maxPauseLatencyInUs, transitionTimer.nsecsElapsed() / NS_IN_ONE_US);
+
+    while (closed.load()) {
+        opened.wait(&mutex);
+    }
+
+    storeMaximum(maxResumeLatencyInUs, transitionTimer.nsecsElapsed() / NS_IN_ONE_US);
+}
+
+void PauseGate::resetStatistics()
+{
+    maxPauseLatencyInUs.store(0);
+    maxResumeLatencyInUs.store(0);
+    checkCount.store(0);
+}
@@ -0,0 +1,352 @@
+#include "processrenderpool.h"
+
+#include <QCoreApplication>
+#include <QSysInfo>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include "cancellationtoken.h"
+#include "computeddatasegment.h"
+#include "jobtaskowner.h"
+#include "ComputeTaskGenerator.h"
+
+const char ProcessRenderPool::HELPER_ARGUMENT[] = "--render-helper";
+
+ProcessRenderPool::ProcessRenderPool(int numHelperProcesses, QObject *parent)
+    : QObject{ parent },
+      numHelperProcesses(numHelperProcesses),
+      layout { nullptr, nullptr, nullptr, nullptr },
+      nextOwnerId(1),
+      jobCount(0),
+      helperRestartCount(0),
+      restartsLeft(0),
+      failed(false)
+{
+    Q_ASSERT(numHelperProcesses > 0);
+    //the band table is shared between processes, its atomics must not rely on a lock
+    static_assert(ATOMIC_INT_LOCK_FREE == 2, "shared atomics must be lock free");
+}
+
+ProcessRenderPool::~ProcessRenderPool()
+{
+    for (auto& i : helpers) {
+        //the helpers are killed rather than waited for, their results are not needed
+        disconnect(i.first, nullptr, this, nullptr);
+        i.first->kill();
+        i.first->waitForFinished();
+        delete i.first;
+    }
+    helpers.clear();
+    sharedJob.detach();
+}
+
+bool ProcessRenderPool::isHelperInvocation(int argc, char *argv[])
+{
+    return (argc > 1 && std::strcmp(argv[1], HELPER_ARGUMENT) == 0);
+}
+
+/*
+ * Copy the job into a new shared memory segment and start the helpers,
+ * only one job is rendered at a time
+ */
+bool ProcessRenderPool::render(const RenderJobRequest& request)
+{
+    const RegionAttributes& attributes = request.attributes;
+    if (attributes.getMaxX() <= attributes.getMinX() ||
+        attributes.getMaxY() <= attributes.getMinY() ||
+        request.colormap.empty())
+    {
+        throw std::out_of_range("Render job region or colormap is empty");
+    }
+
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+    const QByteArray preciseOriginX = attributes.getPreciseOriginX().toLatin1();
+    const QByteArray preciseOriginY = attributes.getPreciseOriginY().toLatin1();
+#else
+    const QByteArray preciseOriginX;
+    const QByteArray preciseOriginY;
+#endif
+    if (preciseOriginX.size() >= MAX_ORIGIN_LENGTH || preciseOriginY.size() >= MAX_ORIGIN_LENGTH) {
+        throw std::out_of_range("Render job origin is too long to be shared");
+    }
+
+    if (isBusy()) {
+        return false;
+    }
+
+    const int width = attributes.getMaxX() - attributes.getMinX();
+    const int height = attributes.getMaxY() - attributes.getMinY();
+    const int bytesPerLine = width * static_cast<int>(sizeof(uint));
+    const int numBands = (height + LINES_PER_BAND - 1) / LINES_PER_BAND;
+    const int colorMapSize = static_cast<int>(request.colormap.size());
+
+    //a new segment per job, helpers of an earlier job can't attach to it by mistake
+    sharedJob.detach();
+    sharedJob.setKey(QSysInfo::machineHostName() + "::MandelbrotJob::" +
+                     QString::number(QCoreApplication::applicationPid()) + "::" + QString::number(++jobCount));
+    if (!sharedJob.create(computeSharedSize(numBands, colorMapSize, bytesPerLine, height), QSharedMemory::ReadWrite)) {
+        return false;
+    }
+
+    layout = mapLayout(sharedJob.data(), numBands, colorMapSize);
+    SharedJobHeader* header = new (layout.header) SharedJobHeader;
+    header->magic = JOB_MAGIC;
+    header->version = JOB_VERSION;
+    header->nextBand.store(0);
+    header->cancelled.store(0);
+    header->minX = attributes.getMinX();
+    header->maxX = attributes.getMaxX();
+    header->minY = attributes.getMinY();
+    header->maxY = attributes.getMaxY();
+    header->fullHeight = attributes.getFullHeight();
+    header->numPasses = request.numPasses;
+    header->numericType = static_cast<qint32>(request.numericType);
+    header->colorMapSize = colorMapSize;
+    header->numBands = numBands;
+    header->bytesPerLine = bytesPerLine;
+    header->scaleFactor = attributes.getScaleFactor();
+    header->originX = attributes.getOriginX();
+    header->originY = attributes.getOriginY();
+    std::memset(header->preciseOriginX, 0, MAX_ORIGIN_LENGTH);
+    std::memset(header->preciseOriginY, 0, MAX_ORIGIN_LENGTH);
+    std::memcpy(header->preciseOriginX, preciseOriginX.constData(), static_cast<std::size_t>(preciseOriginX.size()));
+    std::memcpy(header->preciseOriginY, preciseOriginY.constData(), static_cast<std::size_t>(preciseOriginY.size()));
+
+    for (int i = 0; i < numBands; ++i) {
+        new (&layout.bandOwners[i]) std::atomic<qint32>(BAND_FREE);
+    }
+    std::copy(request.colormap.begin(), request.colormap.end(), layout.colormap);
+
+    restartsLeft = MAX_HELPER_RESTARTS;
+    failed = false;
+    for (int i = 0; i < std::min(numHelperProcesses, numBands); ++i) {
+        startHelper();
+    }
+    return true;
+}
+
+/*
+ * The helpers stop after their current pixel line, jobCancelled() follows
+ */
+void ProcessRenderPool::cancel()
+{
+    if (isBusy()) {
+        layout.header->cancelled.store(1);
+    }
+}
+
+void ProcessRenderPool::startHelper()
+{
+    const qint32 ownerId = nextOwnerId++;
+    auto helper = new QProcess(this);
+    connect(helper, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(helperFinished(int,QProcess::ExitStatus)));
+    connect(helper, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(helperError(QProcess::ProcessError)));
+    helpers.emplace(helper, ownerId);
+    helper->start(QCoreApplication::applicationFilePath(),
+                  QStringList { QString(HELPER_ARGUMENT), sharedJob.key(), QString::number(ownerId) });
+}
+
+void ProcessRenderPool::helperFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    helperStopped(qobject_cast<QProcess*>(sender()), exitStatus != QProcess::NormalExit || exitCode != 0, true);
+}
+
+/*
+ * A helper which can't be started is not replaced, the others would fail as well
+ */
+void ProcessRenderPool::helperError(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        helperStopped(qobject_cast<QProcess*>(sender()), true, false);
+    }
+}
+
+void ProcessRenderPool::helperStopped(QProcess* helper, bool crashed, bool replaceable)
+{
+    auto found = helpers.find(helper);
+    if (found == helpers.end()) {
+        return;
+    }
+
+    const qint32 ownerId = found->second;
+    helpers.erase(found);
+    helper->deleteLater();
+
+    if (crashed) {
+        //the lines claimed by the helper are handed out again
+        releaseBands(ownerId);
+        if (layout.header->cancelled.load() == 0) {
+            if (replaceable && restartsLeft > 0) {
+                --restartsLeft;
+                ++helperRestartCount;
+                startHelper();
+            } else {
+                failed = true;
+            }
+        }
+    }
+
+    if (helpers.empty()) {
+        finishJob();
+    }
+}
+
+/*
+ * Called once the helper has exited, so none of its bands can still change
+ */
+void ProcessRenderPool::releaseBands(qint32 owner)
+{
+    for (int i = 0; i < layout.header->numBands; ++i) {
+        qint32 expected = owner;
+        layout.bandOwners[i].compare_exchange_strong(expected, BAND_FREE);
+    }
+}
+
+void ProcessRenderPool::finishJob()
+{
+    const SharedJobHeader& header = *layout.header;
+    const bool complete = std::all_of(layout.bandOwners, layout.bandOwners + header.numBands,
+                                      [](const std::atomic<qint32>& owner) { return owner.load() == BAND_DONE; });
+
+    if (header.cancelled.load() != 0) {
+        emit jobCancelled();
+    } else if (failed || !complete) {
+        emit jobFailed(tr("The render helper processes stopped before completing the image"));
+    } else {
+        const int width = header.maxX - header.minX;
+        const int height = header.maxY - header.minY;
+        QImage image(width, height, QImage::Format_RGB32);
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(image.scanLine(y), layout.pixels + static_cast<std::ptrdiff_t>(y) * header.bytesPerLine,
+                        static_cast<std::size_t>(header.bytesPerLine));
+        }
+        emit jobDone(image);
+    }
+
+    layout = SharedJobLayout { nullptr, nullptr, nullptr, nullptr };
+    sharedJob.detach();
+}
+
+int ProcessRenderPool::computeSharedSize(int numBands, int colorMapSize, int bytesPerLine, int height)
+{
+    const std::size_t tableSize = sizeof(SharedJobHeader) +
+                                  static_cast<std::size_t>(numBands) * sizeof(std::atomic<qint32>) +
+                                  static_cast<std::size_t>(colorMapSize) * sizeof(uint);
+    const std::size_t pixelDataStart = ((tableSize + PIXEL_DATA_ALIGNMENT - 1) / PIXEL_DATA_ALIGNMENT) * PIXEL_DATA_ALIGNMENT;
+    return static_cast<int>(pixelDataStart + static_cast<std::size_t>(bytesPerLine) * static_cast<std::size_t>(height));
+}
+
+ProcessRenderPool::SharedJobLayout ProcessRenderPool::mapLayout(void* data, int numBands, int colorMapSize)
+{
+    auto base = static_cast<uchar*>(data);
+    std::size_t offset = sizeof(SharedJobHeader);
+    auto bandOwners = reinterpret_cast<std::atomic<qint32>*>(base + offset);
+    offset += static_cast<std::size_t>(numBands) * sizeof(std::atomic<qint32>);
+    auto colormap = reinterpret_cast<uint*>(base + offset);
+    offset += static_cast<std::size_t>(colorMapSize) * sizeof(uint);
+    offset = ((offset + PIXEL_DATA_ALIGNMENT - 1) / PIXEL_DATA_ALIGNMENT) * PIXEL_DATA_ALIGNMENT;
+
+    return SharedJobLayout { reinterpret_cast<SharedJobHeader*>(base), bandOwners, colormap, base + offset };
+}
+
+/*
+ * Take the next band never handed out, then any band released by a crashed helper
+ */
+bool ProcessRenderPool::claimBand(const SharedJobLayout& layout, qint32 owner, int& band)
+{
+    const int numBands = layout.header->numBands;
+    for (band = layout.header->nextBand.fetch_add(1); band < numBands; band = layout.header->nextBand.fetch_add(1)) {
+        qint32 expected = BAND_FREE;
+        if (layout.bandOwners[band].compare_exchange_strong(expected, owner)) {
+            return true;
+        }
+    }
+
+    for (band = 0; band < numBands; ++band) {
+        qint32 expected = BAND_FREE;
+        if (layout.bandOwners[band].compare_exchange_strong(expected, owner)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * Entry point of a helper process: arguments are HELPER_ARGUMENT, the key of
+ * the shared job and the owner id of the helper; compute bands until none is left
+ */
+int ProcessRenderPool::runHelper(const QStringList& arguments)
+{
+    constexpr int EXIT_BAD_ARGUMENTS = 2;
+    constexpr int EXIT_NO_JOB = 3;
+
+    bool ownerIsValid = false;
+    const qint32 owner = (arguments.size() > 3) ? arguments.at(3).toInt(&ownerIsValid) : BAND_FREE;
+    if (!ownerIsValid || owner <= BAND_FREE) {
+        return EXIT_BAD_ARGUMENTS;
+    }
+
+    QSharedMemory sharedJob(arguments.at(2));
+    if (!sharedJob.attach(QSharedMemory::ReadWrite) ||
+        sharedJob.size() < static_cast<int>(sizeof(SharedJobHeader)))
+    {
+        return EXIT_NO_JOB;
+    }
+
+    const auto header = static_cast<SharedJobHeader*>(sharedJob.data());
+    if (header->magic != JOB_MAGIC || header->version != JOB_VERSION ||
+        sharedJob.size() < computeSharedSize(header->numBands, header->colorMapSize, header->bytesPerLine,
+                                             header->maxY - header->minY))
+    {
+        return EXIT_NO_JOB;
+    }
+
+    const SharedJobLayout layout = mapLayout(sharedJob.data(), header->numBands, header->colorMapSize);
+    MandelBrotRenderer::CoordValue originX = QString::number(header->originX, 'g', 17);
+    MandelBrotRenderer::CoordValue originY = QString::number(header->originY, 'g', 17);
+    const RegionAttributes attributes(header->scaleFactor, originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                      QString::fromLatin1(header->preciseOriginX),
+                                      QString::fromLatin1(header->preciseOriginY),
+#endif
+                                      header->minX, header->maxX, header->minY, header->maxY, header->fullHeight);
+
+    JobTaskOwner job(header->numPasses,
+                     MandelBrotRenderer::colorMapStore(layout.colormap, layout.colormap + header->colorMapSize));
+    const SharedTaskParameters parameters { 0, attributes, nullptr,
+                                            MandelBrotRenderer::FrameBuffer { layout.pixels, header->bytesPerLine,
+                                                                              -header->minX, -header->minY },
+                                            MandelBrotRenderer::noReusedSamples, MandelBrotRenderer::noPreviewSamples };
+    const MandelBrotRenderer::computeFunction computeTask =
+            generateComputeTaskForType(job, static_cast<MandelBrotRenderer::internalDataType>(header->numericType));
+    CancellationToken cancellation;
+
+    int band = 0;
+    while (header->cancelled.load() == 0 && claimBand(layout, owner, band)) {
+        const int firstLine = header->minY + band * LINES_PER_BAND;
+        const int lastLine = std::min(firstLine + LINES_PER_BAND, static_cast<int>(header->maxY));
+
+        ComputedDataSegment segment(parameters,
+                                    MandelBrotRenderer::RenderTask { header->minX, header->maxX, firstLine, lastLine, 0 },
+                                    0);
+        MandelBrotRenderer::ComputeTaskResults& resultData = segment.getFullResultData();
+        for (int y = firstLine; y < lastLine; ++y) {
+            if (header->cancelled.load() != 0) {
+                cancellation.cancel();
+                break;
+            }
+            computeTask(segment, cancellation, resultData, y);
+        }
+
+        if (!cancellation.isCancelled()) {
+            layout.bandOwners[band].store(BAND_DONE);
+        }
+    }
+
+    sharedJob.detach();
+    return 0;
+}
@@ -94,15 +94,14 @@ int RegionAttributes::getFullHeight() const
 
 int RegionAttributes::computeRawDataSize() const
 {
- return ((maxX + 1 - minX) *
-         (maxY + 1 - minY));
+ //maxX and maxY are exclusive bounds
+ return ((maxX - minX) *
+         (maxY - minY));
 }
 
-void RegionAttributes::adjustYValues(int currentYPos, bool isLowerHalf)
+void RegionAttributes::splitYValuesAt(int newYBoundary, bool isLowerHalf)
 {
-    const int remainingPixelLines = maxY - currentYPos;
-    const int newSize = remainingPixelLines / 2;
-    const int newYBoundary =  currentYPos + newSize;
+    Q_ASSERT(newYBoundary > minY && newYBoundary < maxY);
     if (isLowerHalf)
     {
         minY = newYBoundary;
@@ -115,6 +114,7 @@ void RegionAttributes::adjustYValues(int currentYPos, bool isLowerHalf)
 
 
 
+
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
 double RegionAttributes::getOriginX() const
 {
@@ -124,12 +124,12 @@ double RegionAttributes::getOriginX() const
     return static_cast<double>(originX_float.first);
 }
 
-QString RegionAttributes::getPreciseOriginX() const
+const QString& RegionAttributes::getPreciseOriginX() const
 {
     return preciseOriginX;
 }
 
-QString RegionAttributes::getPreciseOriginY() const
+const QString& RegionAttributes::getPreciseOriginY() const
 {
     return preciseOriginY;
 }
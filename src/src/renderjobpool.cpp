@@ -0,0 +1,264 @@
+#include "renderjobpool.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "cancellationtoken.h"
+#include "computeddatasegment.h"
+#include "jobtaskowner.h"
+#include "ComputeTaskGenerator.h"
+
+/*
+ * The state of a single job
+ */
+class RenderJobPool::RenderJob
+{
+public:
+    RenderJob(int jobId, const RenderJobRequest& request, int64_t virtualTime);
+
+    bool isFinished() const { return tasksInProgress == 0 && (cancellation.isCancelled() || linesDone == totalLines); }
+
+    const int jobId;
+    const RenderJobRequest request;
+    //referenced by the kernel
+    const JobTaskOwner taskOwner;
+    const int totalLines;
+
+    QImage image;
+    const SharedTaskParameters parameters;
+    CancellationToken cancellation;
+    MandelBrotRenderer::computeFunction computeTask;
+
+    int nextLine;
+    int linesDone;
+    int tasksInProgress;
+    int64_t virtualTime;
+    int64_t meanLineCost;
+};
+
+RenderJobPool::RenderJob::RenderJob(int jobId, const RenderJobRequest& request, int64_t virtualTime)
+    : jobId(jobId),
+      request(request),
+      taskOwner(request.numPasses, request.colormap),
+      totalLines(request.attributes.getMaxY() - request.attributes.getMinY()),
+      image(request.attributes.getMaxX() - request.attributes.getMinX(), totalLines, QImage::Format_RGB32),
+      //each band is owned by a single worker, which writes its lines straight into the job image
+      parameters { jobId, request.attributes, &image,
+                   MandelBrotRenderer::createFrameBuffer(image, -request.attributes.getMinX(), -request.attributes.getMinY()),
+                   MandelBrotRenderer::noReusedSamples, MandelBrotRenderer::noPreviewSamples },
+      computeTask(generateComputeTaskForType(taskOwner, request.numericType)),
+      nextLine(request.attributes.getMinY()),
+      linesDone(0),
+      tasksInProgress(0),
+      virtualTime(virtualTime),
+      meanLineCost(request.attributes.getMaxX() - request.attributes.getMinX())
+{
+}
+
+RenderJobPool::RenderJobPool(int numWorkerThreads, QObject *parent)
+    : QObject{ parent },
+      numWorkerThreads(numWorkerThreads),
+      nextJobId(0),
+      shuttingDown(false),
+      foregroundActive(false),
+      foregroundWeight(1),
+      foregroundVirtualTime(0)
+{
+    Q_ASSERT(numWorkerThreads > 0);
+}
+
+RenderJobPool::~RenderJobPool()
+{
+    mutex.lock();
+    shuttingDown = true;
+    for (auto& i : jobs) {
+        i.second->cancellation.cancel();
+    }
+    taskAvailable.wakeAll();
+    mutex.unlock();
+
+    for (auto& i : workers) {
+        i.join();
+    }
+}
+
+/*
+ * Queue a job, the worker threads are started with the first one
+ */
+int RenderJobPool::submit(const RenderJobRequest& request)
+{
+    if (request.attributes.getMaxX() <= request.attributes.getMinX() ||
+        request.attributes.getMaxY() <= request.attributes.getMinY() ||
+        request.colormap.empty())
+    {
+        throw std::out_of_range("Render job region or colormap is empty");
+    }
+
+    QMutexLocker locker(&mutex);
+
+    //a new job starts level with the most advanced pending job, it doesn't get to catch up
+    int64_t virtualTime = foregroundActive ? foregroundVirtualTime.load() : 0;
+    for (const auto& i : jobs) {
+        virtualTime = std::max(virtualTime, i.second->virtualTime);
+    }
+
+    const int jobId = nextJobId++;
+    jobs.emplace(jobId, std::unique_ptr<RenderJob>(new RenderJob(jobId, request, virtualTime)));
+
+    if (workers.empty()) {
+        for (int i = 0; i < numWorkerThreads; ++i) {
+            workers.emplace_back(&RenderJobPool::processTasks, this);
+        }
+    }
+    taskAvailable.wakeAll();
+
+    return jobId;
+}
+
+void RenderJobPool::cancel(int jobId)
+{
+    std::unique_ptr<RenderJob> cancelledJob;
+    {
+        QMutexLocker locker(&mutex);
+        auto found = jobs.find(jobId);
+        if (found == jobs.end()) {
+            return;
+        }
+        found->second->cancellation.cancel();
+        cancelledJob = removeJobIfFinished(found->second.get());
+    }
+    publishFinishedJob(std::move(cancelledJob));
+}
+
+int RenderJobPool::getNumPendingJobs() const
+{
+    QMutexLocker locker(&mutex);
+    return static_cast<int>(jobs.size());
+}
+
+/*
+ * The foreground work starts level with the least advanced pending job,
+ * neither catching up on the time it was idle nor starving the jobs
+ */
+void RenderJobPool::beginForegroundWork(uint weight)
+{
+    QMutexLocker locker(&mutex);
+    RenderJob* job = selectNextJob();
+    if (job != nullptr) {
+        foregroundVirtualTime = job->virtualTime;
+    }
+    foregroundWeight = std::max(weight, 1u);
+    foregroundActive = true;
+}
+
+void RenderJobPool::endForegroundWork()
+{
+    QMutexLocker locker(&mutex);
+    foregroundActive = false;
+    taskAvailable.wakeAll();
+}
+
+/*
+ * The job with the lowest virtual time which still has lines to hand out,
+ * the caller must hold the mutex
+ */
+RenderJobPool::RenderJob* RenderJobPool::selectNextJob() const
+{
+    RenderJob* selectedJob = nullptr;
+    for (const auto& i : jobs) {
+        RenderJob* job = i.second.get();
+        if (job->cancellation.isCancelled() || job->nextLine >= job->request.attributes.getMaxY()) {
+            continue;
+        }
+        if (selectedJob == nullptr || job->virtualTime < selectedJob->virtualTime) {
+            selectedJob = job;
+        }
+    }
+    return selectedJob;
+}
+
+/*
+ * The caller must hold the mutex
+ */
+std::unique_ptr<RenderJobPool::RenderJob> RenderJobPool::removeJobIfFinished(RenderJob* job)
+{
+    std::unique_ptr<RenderJob> finishedJob;
+    if (job->isFinished()) {
+        auto found = jobs.find(job->jobId);
+        finishedJob = std::move(found->second);
+        jobs.erase(found);
+    }
+    return finishedJob;
+}
+
+/*
+ * Signal the end of a job, called without holding the mutex
+ */
+void RenderJobPool::publishFinishedJob(std::unique_ptr<RenderJob> job)
+{
+    if (job == nullptr) {
+        return;
+    }
+
+    if (job->cancellation.isCancelled()) {
+        emit jobCancelled(job->jobId);
+    } else {
+        emit jobDone(job->jobId, job->image);
+    }
+}
+
+void RenderJobPool::processTasks()
+{
+    mutex.lock();
+    while (!shuttingDown) {
+        RenderJob* job = selectNextJob();
+        if (job == nullptr) {
+            taskAvailable.wait(&mutex);
+            continue;
+        }
+        if (foregroundActive && job->virtualTime > foregroundVirtualTime.load()) {
+            //the foreground work is behind its share, its workers are charging it meanwhile
+            taskAvailable.wait(&mutex, FOREGROUND_POLL_INTERVAL_IN_MS);
+            continue;
+        }
+
+        const int firstLine = job->nextLine;
+        const int lastLine = std::min(firstLine + LINES_PER_TASK, job->request.attributes.getMaxY());
+        const int64_t weight = std::max<int64_t>(job->request.weight, 1);
+        //charge the estimated cost up front so other workers see the job's share as taken
+        const int64_t estimatedCost = (lastLine - firstLine) * job->meanLineCost;
+
+        job->nextLine = lastLine;
+        job->virtualTime += estimatedCost / weight;
+        ++job->tasksInProgress;
+        mutex.unlock();
+
+        ComputedDataSegment segment(job->parameters,
+                                    MandelBrotRenderer::RenderTask { job->request.attributes.getMinX(), job->request.attributes.getMaxX(),
+                                                                     firstLine, lastLine, job->jobId },
+                                    job->jobId);
+
+        MandelBrotRenderer::ComputeTaskResults& resultData = segment.getFullResultData();
+        for (int y = firstLine; y < lastLine && !job->cancellation.isCancelled(); ++y) {
+            job->computeTask(segment, job->cancellation, resultData, y);
+        }
+
+        mutex.lock();
+        const int64_t cost = resultData.iterationSum;
+        job->virtualTime += (cost - estimatedCost) / weight;
+        job->meanLineCost = std::max<int64_t>((job->meanLineCost + cost / (lastLine - firstLine)) / 2, 1);
+        job->linesDone += lastLine - firstLine;
+        --job->tasksInProgress;
+
+        std::unique_ptr<RenderJob> finishedJob = removeJobIfFinished(job);
+        if (finishedJob != nullptr) {
+            mutex.unlock();
+            publishFinishedJob(std::move(finishedJob));
+            mutex.lock();
+        }
+    }
+    mutex.unlock();
+}
@@ -98,18 +98,31 @@ RenderThread::RenderThread(SettingsHandler&settingsHandler, QObject *parent)
       threadConfigurer(nullptr),
       numPassesConfigurer(nullptr),
       applicationSettingsHandler(settingsHandler),
-      bufferedResults(MAX_NUM_WORKER_THREADS, MQuintVector(0)),
-      bufferedAttributes(MAX_NUM_WORKER_THREADS, RegionAttributes()),
       originX(MandelbrotWidget::unInitializedFloatString),  //TODO improve this, check for the lifetime of this static value
       originY(MandelbrotWidget::unInitializedFloatString),
       scaleFactor(notYetInitializedDouble),
+      requestedServiceClass(renderServiceClass::final),
       abort(false), currentImage(nullptr), computationChunksDone(0), colorMapSize(MandelBrotRenderer::DefaultColormapSize),
       timerInSeconds(this),
       numWorkerThreads(calculateInitialNumThreads()),
       sem(nullptr),
+      launchedWorkers(numWorkerThreads),
+      activeWorkers(0),
+      targetNumWorkerThreads(numWorkerThreads),
+      appliedNumWorkerThreads(numWorkerThreads),
+      progressChunkLimit(0),
+      renderJobCount(0),
+      recordingCompletedAreas(false),
       rendererData { numWorkerThreads, possiblePassValues[1], possiblePassValues[1], threadReallocationDefaultEnabled, colorMapSize,
-                        internalDataType::unknownType, MandelBrotRenderer::notYetInitializedInt64},
+                        internalDataType::unknownType, MandelBrotRenderer::notYetInitializedInt64, focusedRenderingDefaultEnabled,
+                        speculativeRenderingDefaultEnabled, snappedZoomDefaultEnabled, frameBudgetDefaultEnabled,
+                        FrameBudget::DEFAULT_BUDGET_IN_MS},
       threadMediator(rendererData),
+      tileCacheSettings { tileCacheDefaultSizeInMB, diskTileCacheDefaultEnabled, DiskTileStore::defaultDirectory(), false,
+                          diskTileCacheDefaultSizeInMB },
+      tileCacheSettingsChanged(true),
+      speculativeRenderActive(false),
+      jobPool(calculateInitialNumThreads()),
       displayer(nullptr)
 {
     ++count;
@@ -122,10 +135,7 @@ RenderThread::RenderThread(SettingsHandler&settingsHandler, QObject *parent)
 
 void RenderThread::populateColorMap()
 {
-    colormap.resize(static_cast<std::size_t>(colorMapSize));
-    uint count = 0;
-    for (auto&  i : colormap)
-        i = MandelBrotRenderer::rgbFromWaveLength(380.0 + ((count++) * 400.0 / colorMapSize));
+    colormap = MandelBrotRenderer::createColormap(colorMapSize);
 }
 
 void RenderThread::publishDynamicTasksEnabled()
@@ -137,6 +147,45 @@ void RenderThread::publishDynamicTasksEnabled()
 }
 
 
+void RenderThread::setFocusedRenderingByState(int state)
+{
+    rendererData.focusedRenderingEnabled = (state == Qt::Checked);
+    writeSettings();
+}
+
+void RenderThread::setSpeculativeRenderingByState(int state)
+{
+    rendererData.speculativeRenderingEnabled = (state == Qt::Checked);
+    writeSettings();
+}
+
+void RenderThread::setSnappedZoomByState(int state)
+{
+    rendererData.snappedZoomEnabled = (state == Qt::Checked);
+    writeSettings();
+}
+
+void RenderThread::setFrameBudgetByState(int state)
+{
+    rendererData.frameBudgetEnabled = (state == Qt::Checked);
+    writeSettings();
+}
+
+void RenderThread::setBackgroundModeByState(int state)
+{
+    cpuThrottle.setLimit(state == Qt::Checked, cpuThrottle.getCpuSharePercent());
+    //a running pass follows the new limit
+    targetNumWorkerThreads = cpuThrottle.limitWorkerCount(rendererData.pendingNumWorkerThreads);
+    writeSettings();
+}
+
+void RenderThread::setBackgroundCpuShare(int percent)
+{
+    cpuThrottle.setLimit(cpuThrottle.isEnabled(), percent);
+    targetNumWorkerThreads = cpuThrottle.limitWorkerCount(rendererData.pendingNumWorkerThreads);
+    writeSettings();
+}
+
 void RenderThread::setOwnerOnce(MandelbrotWidget * owner)
 {
     if (this->owner == nullptr) {
@@ -153,7 +202,8 @@ void RenderThread::render(const MandelBrotRenderer::CoordValue& originX, const M
                           const QString& preciseOriginX, const QString& preciseOriginY,
 #endif
                           double scaleFactor,
-                          QSize resultSize)
+                          QSize resultSize,
+                          renderServiceClass serviceClass)
 {
     QMutexLocker locker(&mutex);
 
@@ -167,6 +217,7 @@ void RenderThread::render(const MandelBrotRenderer::CoordValue& originX, const M
     publishCoordinates();
 
     this->resultSize = resultSize;
+    requestedServiceClass = serviceClass;
 
     owner->displayDynamicTasksInfo(threadMediator.getEnabled());
 
@@ -176,10 +227,33 @@ void RenderThread::render(const MandelBrotRenderer::CoordValue& originX, const M
         start(LowPriority);
     } else {
         restart = true;
+        //stop the workers of the current render as soon as possible
+        cancellationToken.cancel();
         condition.wakeAll();
     }
 }
 
+/*
+ * Offer an image rendered earlier for a view which is about to be requested,
+ * it is shown instead of a new render if the current settings are those of the key
+ */
+void RenderThread::provideCachedView(const ViewCacheKey& key, const QImage& image)
+{
+    QMutexLocker locker(&mutex);
+    providedViews.emplace_back(key, CachedView { image, MandelBrotRenderer::notYetInitializedInt64 });
+}
+
+/*
+ * Called by the master thread with the mutex held
+ */
+void RenderThread::acceptProvidedViews()
+{
+    for (const auto& i : providedViews) {
+        viewCache.insert(i.first, i.second);
+    }
+    providedViews.clear();
+}
+
 internalDataType RenderThread::getInternalDataType() const
 {
     return rendererData.numericType;
@@ -216,6 +290,8 @@ void RenderThread::setNumberOfThreads(int value)
     }
 
     rendererData.pendingNumWorkerThreads = value;
+    //a running pass follows the new value, the next pass is partitioned for it
+    targetNumWorkerThreads = cpuThrottle.limitWorkerCount(value);
 }
 
 void RenderThread::setNumberOfPasses(int value)
@@ -237,6 +313,8 @@ void RenderThread::cleanup()
 
             if (!thread->isCleanedUp())
             {
+                //the worker is done with the mediator, its index may be given to a new worker
+                workerIndexInUse.at(static_cast<size_t>(thread->getThreadIndex())) = false;
                 signalSender->disconnect();
                 //signalSender->deleteLater();
                 thread->setCleanedUp();
@@ -256,13 +334,13 @@ void RenderThread::cleanup()
     }
 
     emit writeToLog("sem available: " + QString::number(sem->available()));
-    if (sem->available() == numWorkerThreads)
+    if (sem->available() == launchedWorkers)
     {
         std::cout << "All done" << std::endl;
 
         displayer->configureThreadInfo(numWorkerThreads);
 
-        if (!quitIsPending) {
+        if (!quitIsPending && !speculativeRenderActive) {
             emit renderedImage(currentImage, scaleFactor);
         }
         threadMediator.resetThreadMediator();
@@ -297,6 +375,7 @@ void RenderThread::halt(const bool quitApplication)
 {
     std::cout << "In " << static_cast<const char*>(__FUNCTION__) << std::endl;
     abort = true;
+    cancellationToken.cancel();
 
     quitIsPending = quitApplication;
 }
@@ -348,20 +427,13 @@ void RenderThread::createChecksum(bool forcedToStop) const
         emit writeToLog("no image for checksum!",
                            true);
     }
-    checksum = 0;
-    const uchar *st = currentImage->bits();
+    checksum = computeChecksum(*currentImage);
     int pixelCount = currentImage->width() * currentImage->height();
 
-    std::vector<uchar> results;
-    results.assign(st, st + pixelCount);
-
-    for (const auto& i : results) {
-        checksum += i;
-    }
-
     auto elapsedTime = static_cast<double>(owner->getElapsedTimeDisplayed());
 
     bool dynamicAlgorithmActive = threadMediator.getEnabled();
+    const BufferArena::Statistics arenaStatistics = frameArena.getStatistics();
 
     emit writeToLog("Threads: " + QString::number(numWorkerThreads) +
                        ", Passes: " + QString::number(rendererData.currentNumPassValue) +
@@ -372,6 +444,15 @@ void RenderThread::createChecksum(bool forcedToStop) const
                        ", ColourMapSize: " + QString::number(rendererData.colorMapSize) +
                        ", Internal Data Type: " + QString::number(toUnderlyingType(rendererData.numericType)) +
                        ", Iteration Sum: " + QString::number(rendererData.iterationSumCount) +
+                       ", Mediator Wakeups: " + QString::number(threadMediator.getWakeupCount()) +
+                       ", Mediator Wait Time: " + QString::number(threadMediator.getWaitTimeInMs()) +
+                       ", Segment Copies: " + QString::number(ComputedDataSegment::getCopyCount()) +
+                       ", Buffer Allocations: " + QString::number(arenaStatistics.allocationCount) +
+                       ", Buffer Reuses: " + QString::number(arenaStatistics.reuseCount) +
+                       ", Buffer Bytes: " + QString::number(arenaStatistics.allocatedBytes) +
+                       ", Pause Checks: " + QString::number(owner->getPauseGate().getCheckCount()) +
+                       ", Max Pause Latency (us): " + QString::number(owner->getPauseGate().getMaxPauseLatencyInUs()) +
+                       ", Max Resume Latency (us): " + QString::number(owner->getPauseGate().getMaxResumeLatencyInUs()) +
                        ", Time: " + QString::number(elapsedTime),
                        true);
 #ifdef DEBUG_RAW_RESULTS
@@ -404,19 +485,496 @@ bool RenderThread::dynamicThreadAllocationEnabled()
     return (threadMediator.getEnabled());
 }
 
+/*
+ * Apply the requested number of worker threads, must only be called when
+ * no workers are running (the semaphore follows the number of launched workers)
+ */
 void RenderThread::adjustWorkerThreadCount()
 {
-    if (numWorkerThreads != rendererData.pendingNumWorkerThreads) {
-        numWorkerThreads = rendererData.pendingNumWorkerThreads;
+    //in background mode the workers are capped to the share of the CPU
+    int allowedNumWorkerThreads = cpuThrottle.limitWorkerCount(rendererData.pendingNumWorkerThreads);
+    if (speculativeRenderActive) {
+        //idle work, the requested count is applied again by the next requested render
+        numWorkerThreads = std::min(allowedNumWorkerThreads, MAX_SPECULATIVE_WORKER_THREADS);
+    } else if (numWorkerThreads != allowedNumWorkerThreads) {
+        numWorkerThreads = allowedNumWorkerThreads;
         owner->displayThreadsInfo(numWorkerThreads);
-        for (size_t i = 0; i < static_cast<size_t>(numWorkerThreads); ++i) {
-            bufferedResults.at(i).clear();
+
+        emit numThreadsUpdate();
+    }
+    cpuThrottle.setWorkerCount(numWorkerThreads);
+}
+
+/*
+ * Called by a worker of the running pass, retires it if more workers
+ * are active than requested
+ */
+bool RenderThread::claimWorkerRetirement()
+{
+    int active = activeWorkers.load();
+    while (active > targetNumWorkerThreads.load()) {
+        if (activeWorkers.compare_exchange_weak(active, active - 1)) {
+            return true;
         }
+    }
+    return false;
+}
 
-        delete(sem);
-        sem = new QSemaphore(numWorkerThreads);
+void RenderThread::returnUnfinishedLines(const RenderTask& task)
+{
+    QMutexLocker locker(&returnedLinesMutex);
+    returnedLines.push_back(task);
+}
 
-        emit numThreadsUpdate();
+bool RenderThread::takeReturnedLines(RenderTask& task)
+{
+    QMutexLocker locker(&returnedLinesMutex);
+    if (returnedLines.empty()) {
+        return false;
+    }
+    task = returnedLines.back();
+    returnedLines.pop_back();
+    return true;
+}
+
+bool RenderThread::returnedLinesExist()
+{
+    QMutexLocker locker(&returnedLinesMutex);
+    return !returnedLines.empty();
+}
+
+/*
+ * Called by a worker of the final pass for each area (in centred coordinates)
+ * it has computed completely, only while completedAreasRecorded()
+ */
+void RenderThread::recordCompletedArea(const QRect& area)
+{
+    QMutexLocker locker(&completedAreasMutex);
+    completedAreas.push_back(area);
+}
+
+/*
+ * The parameters of a render which are shared by all its tasks (over all passes),
+ * the frame buffer is resolved once here
+ */
+SharedTaskParameters RenderThread::createTaskParameters(ViewParameters& view, QImage& image)
+{
+    const int halfWidth = static_cast<int>(static_cast<double>(view.size.width()) / 2.0);
+    const int halfHeight = static_cast<int>(static_cast<double>(view.size.height()) / 2.0);
+
+    return SharedTaskParameters { ++renderJobCount,
+                                  RegionAttributes(view.scaleFactor,
+                                                   view.originX, view.originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                                   view.preciseOriginX,
+                                                   view.preciseOriginY,
+#endif
+                                                   -halfWidth,
+                                                   halfWidth,
+                                                   -halfHeight,
+                                                   view.size.height() - halfHeight,
+                                                   view.size.height()),
+                                  &image,
+                                  createFrameBuffer(image, view.size.width() / 2, view.size.height() / 2),
+                                  noReusedSamples,
+                                  noPreviewSamples };
+}
+
+/*
+ * When the view is a whole pixel translation of a cached view (same scale and settings),
+ * copy the overlapping pixels into the image of the new render and list the strips
+ * exposed by the translation (in the centred coordinates of the tasks), which are
+ * all that is left to compute
+ */
+bool RenderThread::reuseTranslatedView(const ViewCacheKey& key, const SharedTaskParameters& parameters, std::vector<QRect>& exposedAreas)
+{
+    QPoint offset;
+    CachedView source;
+    if (!viewCache.findTranslatedView(key, offset, source)) {
+        return false;
+    }
+
+    const FrameBuffer& frameBuffer = parameters.frameBuffer;
+    const int width = key.view.size.width();
+    const int height = key.view.size.height();
+    const int dx = offset.x();
+    const int dy = offset.y();
+
+    //the pixel (x, y) of the new view is the pixel (x + dx, y + dy) of the cached one
+    const int firstCopiedLine = std::max(0, -dy);
+    const int lastCopiedLine = std::min(height, height - dy);
+    const int firstCopiedColumn = std::max(0, -dx);
+    const int copiedWidth = width - std::abs(dx);
+    for (int y = firstCopiedLine; y < lastCopiedLine; ++y) {
+        auto sourceLine = reinterpret_cast<const uint *>(source.image.constScanLine(y + dy)) + firstCopiedColumn + dx;
+        std::copy(sourceLine, sourceLine + copiedWidth,
+                  frameBuffer.pixelAt(firstCopiedColumn - frameBuffer.originX, y - frameBuffer.originY));
+    }
+
+    //image coordinates of the exposed strips (inclusive), clipped to the region of the tasks
+    std::vector<QRect> strips;
+    if (dy != 0) {
+        strips.emplace_back(QPoint(0, (dy > 0) ? lastCopiedLine : 0),
+                            QPoint(width - 1, (dy > 0) ? height - 1 : firstCopiedLine - 1));
+    }
+    if (dx != 0) {
+        strips.emplace_back(QPoint((dx > 0) ? width - dx : 0, firstCopiedLine),
+                            QPoint((dx > 0) ? width - 1 : -dx - 1, lastCopiedLine - 1));
+    }
+
+    const RegionAttributes& region = parameters.attributes;
+    const QRect taskRegion(QPoint(region.getMinX(), region.getMinY()), QPoint(region.getMaxX() - 1, region.getMaxY() - 1));
+    exposedAreas.clear();
+    for (const auto& i : strips) {
+        const QRect area = i.translated(-frameBuffer.originX, -frameBuffer.originY).intersected(taskRegion);
+        if (!area.isEmpty()) {
+            exposedAreas.push_back(area);
+        }
+    }
+
+    emit writeToLog("Reusing a cached view translated by (" + QString::number(dx) + ", " + QString::number(dy) + ") pixels", true);
+    return true;
+}
+
+/*
+ * When the view is a power of two zoom of a cached view (as made by MandelbrotWidget::zoom()
+ * with snapped zoom enabled), copy the samples of the cached view which fall exactly on
+ * pixels of the new view into its image, the tasks of all passes skip these pixels:
+ * a quarter of the pixels of a zoom in, up to a quarter of those of a zoom out
+ */
+bool RenderThread::reuseZoomedSamples(const ViewCacheKey& key, SharedTaskParameters& parameters)
+{
+    QPoint offset;
+    bool zoomedIn = false;
+    CachedView source;
+    if (!viewCache.findZoomedView(key, offset, zoomedIn, source)) {
+        return false;
+    }
+
+    //centred coordinates of the cached view, which has the same size as the new one
+    const int sourceMinX = -(source.image.width() / 2);
+    const int sourceMaxX = source.image.width() + sourceMinX;
+    const int sourceMinY = -(source.image.height() / 2);
+    const int sourceMaxY = source.image.height() + sourceMinY;
+
+    auto ceilDiv = [](int value, int divisor) { return (value >= 0) ? (value + divisor - 1) / divisor : -(-value / divisor); };
+    auto alignUp = [](int value, int step) { return (value % step == 0) ? value : value + 1; };
+
+    //the pixel x of the new view is the pixel (offset.x + x / 2) of the cached view when zooming in
+    //(for even values of x), (offset.x + 2 * x) when zooming out
+    SampleGrid grid;
+    if (zoomedIn) {
+        grid = SampleGrid { 2,
+                            alignUp(std::max(parameters.attributes.getMinX(), 2 * (sourceMinX - offset.x())), 2),
+                            std::min(parameters.attributes.getMaxX(), 2 * (sourceMaxX - offset.x())),
+                            alignUp(std::max(parameters.attributes.getMinY(), 2 * (sourceMinY - offset.y())), 2),
+                            std::min(parameters.attributes.getMaxY(), 2 * (sourceMaxY - offset.y())) };
+    } else {
+        grid = SampleGrid { 1,
+                            std::max(parameters.attributes.getMinX(), ceilDiv(sourceMinX - offset.x(), 2)),
+                            std::min(parameters.attributes.getMaxX(), ceilDiv(sourceMaxX - offset.x(), 2)),
+                            std::max(parameters.attributes.getMinY(), ceilDiv(sourceMinY - offset.y(), 2)),
+                            std::min(parameters.attributes.getMaxY(), ceilDiv(sourceMaxY - offset.y(), 2)) };
+    }
+    if (grid.minX >= grid.maxX || grid.minY >= grid.maxY) {
+        return false;
+    }
+
+    auto sourceColumn = [&](int x) { return (zoomedIn ? offset.x() + x / 2 : offset.x() + 2 * x) - sourceMinX; };
+    auto sourceLine = [&](int y) { return (zoomedIn ? offset.y() + y / 2 : offset.y() + 2 * y) - sourceMinY; };
+
+    int64_t reusedCount = 0;
+    for (int y = grid.minY; y < grid.maxY; y += grid.step) {
+        auto sourcePixels = reinterpret_cast<const uint *>(source.image.constScanLine(sourceLine(y)));
+        uint* pixel = parameters.frameBuffer.pixelAt(grid.minX, y);
+        for (int x = grid.minX; x < grid.maxX; x += grid.step) {
+            *pixel = sourcePixels[sourceColumn(x)];
+            pixel += grid.step;
+            ++reusedCount;
+        }
+    }
+
+    parameters.reusedSamples = grid;
+
+    emit writeToLog("Reusing " + QString::number(reusedCount) + " samples of a cached view zoomed " +
+                    (zoomedIn ? "in" : "out") + " by 2", true);
+    return true;
+}
+
+/*
+ * Copy an image of the same size as the render into its frame buffer
+ */
+static void copyIntoFrameBuffer(const QImage& source, const FrameBuffer& frameBuffer)
+{
+    for (int y = 0; y < source.height(); ++y) {
+        auto sourceLine = reinterpret_cast<const uint *>(source.constScanLine(y));
+        std::copy(sourceLine, sourceLine + source.width(), frameBuffer.pixelAt(-frameBuffer.originX, y - frameBuffer.originY));
+    }
+}
+
+/*
+ * Keep the final render of the view pre-empted during its final pass, with the areas
+ * its workers completed, must only be called when no workers are running
+ */
+void RenderThread::suspendRender(const ViewCacheKey& key, const QImage& image)
+{
+    QMutexLocker locker(&completedAreasMutex);
+    suspendedRender.key = key;
+    suspendedRender.image = image;
+    suspendedRender.completedAreas.swap(completedAreas);
+    completedAreas.clear();
+}
+
+/*
+ * Carry on with the pre-empted final render of the view: its pixels are copied into
+ * the image of the new render and the areas not completed yet are listed
+ */
+bool RenderThread::resumeSuspendedRender(const ViewCacheKey& key, const SharedTaskParameters& parameters,
+                                         std::vector<QRect>& remainingAreas)
+{
+    if (suspendedRender.image.isNull() || !(suspendedRender.key == key)) {
+        return false;
+    }
+
+    copyIntoFrameBuffer(suspendedRender.image, parameters.frameBuffer);
+
+    const RegionAttributes& region = parameters.attributes;
+    QRegion remaining(QRect(QPoint(region.getMinX(), region.getMinY()), QPoint(region.getMaxX() - 1, region.getMaxY() - 1)));
+    for (const auto& i : suspendedRender.completedAreas) {
+        remaining -= QRegion(i);
+    }
+    const QVector<QRect> remainingRects = remaining.rects();
+    remainingAreas.assign(remainingRects.begin(), remainingRects.end());
+
+    emit writeToLog("Resuming a pre-empted render, " + QString::number(static_cast<int>(remainingAreas.size())) +
+                    " areas remaining", true);
+
+    suspendedRender = SuspendedRender();
+    return true;
+}
+
+/*
+ * A final render of the view shown by the last interactive render starts from its image,
+ * which is on screen already, so the preview passes of the frame time budget are skipped
+ */
+bool RenderThread::reuseInteractivePreview(const ViewCacheKey& key, const SharedTaskParameters& parameters)
+{
+    if (interactivePreview.second.isNull() || !(interactivePreview.first == key)) {
+        return false;
+    }
+
+    copyIntoFrameBuffer(interactivePreview.second, parameters.frameBuffer);
+
+    interactivePreview.second = QImage();
+    return true;
+}
+
+/*
+ * The settings a cached tile must have been rendered with to be reused,
+ * the tasks of the final pass compute up to calcMaxIterations(numPasses - 1) iterations
+ */
+TileRenderSettings RenderThread::createTileRenderSettings(int numPasses) const
+{
+    return TileRenderSettings { rendererData.numericType,
+                                MandelBrotRenderer::calcMaxIterations(static_cast<uint>(numPasses - 1)),
+                                setType::mandelbrot,
+                                rendererData.colorMapSize };
+}
+
+/*
+ * Copy the cached tiles covered by the view into the image of the new render
+ * and list the areas (in the centred coordinates of the tasks) still to be computed
+ */
+bool RenderThread::restoreCachedTiles(const ViewParameters& view, int numPasses, const SharedTaskParameters& parameters,
+                                      std::vector<QRect>& remainingAreas)
+{
+    TileGrid grid;
+    if (!TileCache::locateGrid(view, grid)) {
+        return false;
+    }
+
+    const RegionAttributes& region = parameters.attributes;
+    const QRect taskRegion(QPoint(region.getMinX(), region.getMinY()), QPoint(region.getMaxX() - 1, region.getMaxY() - 1));
+    const int restoredCount = tileCache.restoreTiles(grid, createTileRenderSettings(numPasses), taskRegion,
+                                                     parameters.frameBuffer, remainingAreas);
+    if (restoredCount == 0) {
+        return false;
+    }
+
+    emit writeToLog("Reusing " + QString::number(restoredCount) + " cached tiles, " +
+                    QString::number(static_cast<int>(remainingAreas.size())) + " tiles left to compute", true);
+    return true;
+}
+
+/*
+ * Called once a render has completed
+ */
+void RenderThread::storeCompletedTiles(const ViewParameters& view, int numPasses, const SharedTaskParameters& parameters)
+{
+    TileGrid grid;
+    if (!TileCache::locateGrid(view, grid)) {
+        return;
+    }
+
+    const RegionAttributes& region = parameters.attributes;
+    const QRect taskRegion(QPoint(region.getMinX(), region.getMinY()), QPoint(region.getMaxX() - 1, region.getMaxY() - 1));
+    tileCache.storeTiles(grid, createTileRenderSettings(numPasses), taskRegion, parameters.frameBuffer);
+}
+
+/*
+ * Called by the master thread with the mutex held, before any tile is looked up
+ */
+void RenderThread::applyTileCacheSettings()
+{
+    if (!tileCacheSettingsChanged) {
+        return;
+    }
+    tileCacheSettingsChanged = false;
+
+    tileCache.setMemoryBudget(static_cast<std::size_t>(tileCacheSettings.memorySizeInMB) * 1024 * 1024);
+    diskTileStore.setSizeLimit(static_cast<qint64>(tileCacheSettings.diskStoreSizeInMB) * 1024 * 1024);
+
+    if (!tileCacheSettings.diskStoreEnabled) {
+        tileCache.setBackingStore(nullptr);
+        diskTileStore.close();
+        return;
+    }
+
+    if (!diskTileStore.isOpen() || diskTileStore.getDirectory() != tileCacheSettings.diskStoreDirectory ||
+        diskTileStore.isReadOnly() != tileCacheSettings.diskStoreReadOnly)
+    {
+        tileCache.setBackingStore(nullptr);
+        if (!diskTileStore.open(tileCacheSettings.diskStoreDirectory, tileCacheSettings.diskStoreReadOnly)) {
+            emit writeToLog("The tile store " + tileCacheSettings.diskStoreDirectory + " can't be opened", true);
+            return;
+        }
+        tileCache.setBackingStore(&diskTileStore);
+        emit writeToLog("Tile store opened, " + QString::number(diskTileStore.getUsedSize() / (1024 * 1024)) + " MB in use", true);
+    }
+}
+
+/*
+ * The lowest index not held by a running worker, or a negative value
+ * when all are taken, the caller must hold the mutex
+ */
+int RenderThread::takeFreeWorkerIndex()
+{
+    auto freeIndex = std::find(workerIndexInUse.begin(), workerIndexInUse.end(), false);
+    if (freeIndex == workerIndexInUse.end()) {
+        return -1;
+    }
+    *freeIndex = true;
+    return static_cast<int>(freeIndex - workerIndexInUse.begin());
+}
+
+/*
+ * Launch a worker with an index no running worker holds (the thread mediator
+ * and the thread display track workers by index), the caller must hold the mutex
+ */
+bool RenderThread::launchWorker(std::vector<RenderWorker *>& helpers, PassContext& context, int minY, int maxY)
+{
+    const int index = takeFreeWorkerIndex();
+    if (index < 0) {
+        return false;
+    }
+
+    ++launchedWorkers;
+    ++activeWorkers;
+
+    /* launch worker tasks in new threads to start computing immediately */
+    helpers.emplace_back
+            (new RenderWorker(this,
+                                    owner,
+                                     static_cast<uint>(context.pass),
+                                     static_cast<uint>(context.numPasses),
+                                     colormap,
+                                     restart,
+                                     cancellationToken,
+                                     index,
+                                    ComputedDataSegment(context.parameters,
+                                                        RenderTask { context.parameters.attributes.getMinX(),
+                                                                     context.parameters.attributes.getMaxX(),
+                                                                     minY,
+                                                                     maxY,
+                                                                     context.parameters.jobId },
+                                                        index)
+                                    ,
+                                     haltChecker([&]{
+                                            return cancellationToken.isCancelled();
+                                            }),
+                                        owner->getPauseGate()
+                                     )
+            );
+    return true;
+}
+
+/*
+ * Follow an increase of the requested thread count during a pass: the extra workers
+ * start without lines of their own and take a share of the remaining work (from busy
+ * workers via the thread mediator, or from the focused tile queue)
+ *
+ * A decrease is handled by the workers themselves, see claimWorkerRetirement()
+ */
+void RenderThread::addWorkersToRunningPass(std::vector<RenderWorker *>& helpers, PassContext& runningPass)
+{
+    int target = targetNumWorkerThreads.load();
+    if (speculativeRenderActive) {
+        target = std::min(target, MAX_SPECULATIVE_WORKER_THREADS);
+    }
+
+    if (target < appliedNumWorkerThreads) {
+        appliedNumWorkerThreads = target;
+    } else if (target > appliedNumWorkerThreads &&
+               (threadMediator.getEnabled() || focusTaskQueue.isActive())) {
+        QMutexLocker locker(&mutex);
+        const int emptyRegionY = -runningPass.view.size.height() / 2;
+        for (int i = appliedNumWorkerThreads; i < target; ++i) {
+            if (!launchWorker(helpers, runningPass, emptyRegionY, emptyRegionY)) {
+                break;
+            }
+        }
+        appliedNumWorkerThreads = target;
+    }
+}
+
+/*
+ * Wait until all workers launched for the running pass (if any) are done,
+ * meanwhile following changes of the requested thread count
+ *
+ * Lines handed back by retired workers which no other worker picked up
+ * are computed by workers launched here before the pass is complete
+ */
+void RenderThread::waitForPassWorkers(std::vector<RenderWorker *>& helpers, PassContext* runningPass)
+{
+    for (;;) {
+        while (!sem->tryAcquire(launchedWorkers, WORKER_COUNT_POLL_INTERVAL_IN_MS)) {
+            if (runningPass != nullptr && !cancellationToken.isCancelled()) {
+                addWorkersToRunningPass(helpers, *runningPass);
+            }
+        }
+
+        if (runningPass == nullptr || !returnedLinesExist()) {
+            break;
+        }
+
+        if (cancellationToken.isCancelled()) {
+            QMutexLocker locker(&returnedLinesMutex);
+            returnedLines.clear();
+            break;
+        }
+
+        QMutexLocker locker(&mutex);
+        sem->release(launchedWorkers);
+        threadMediator.resetBusyThreadCount();
+        threadMediator.resetThreadMediator();
+
+        //the indices of the workers which are done are reused, any others stay with their workers
+        const int emptyRegionY = -runningPass->view.size.height() / 2;
+        for (int i = 0; i < targetNumWorkerThreads.load(); ++i) {
+            if (!launchWorker(helpers, *runningPass, emptyRegionY, emptyRegionY)) {
+                break;
+            }
+        }
     }
 }
 
@@ -444,6 +1002,22 @@ void RenderThread::releaseHelpers(std::vector <RenderWorker *>& helpers)
     helpers.clear();
 }
 
+/*
+ * Make the line costs measured by the workers of the previous pass available as
+ * the estimate for the next one, must only be called when no workers are running
+ * (pass 0 is cheap and serves as a probe for the first full pass)
+ */
+void RenderThread::prepareLineCostEstimate(int pass, int firstLine, int lastLine)
+{
+    if (pass == 0) {
+        lineCostEstimate.reset(firstLine, firstLine);
+    } else {
+        lineCostRecorder.finalizeMeasurements();
+        lineCostEstimate.swap(lineCostRecorder);
+    }
+    lineCostRecorder.reset(firstLine, lastLine);
+}
+
 bool RenderThread::getTypeIsSupported(const QString& typeDescription) const
 {
     Q_ASSERT(!descriptionToTypeMap.empty());
@@ -504,30 +1078,19 @@ void RenderThread::AddNumericTypeToSelector(const QString &description, internal
 void RenderThread::initializeSupportedTypesTable(typeNameUser& nameUser)
 {
     //TODO find a way to more safely link the enum value and combobox indices
-
-#if (USE_BOOST_MULTIPRECISION == 1)
-    constexpr bool boostTypesUsed = true;
-    constexpr bool gccLikeTypesUsed = true;
-#else
-    constexpr bool boostTypesUsed = false;
-#if defined(__GNUC__)
-    constexpr bool gccLikeTypesUsed = true;
-#else
-    constexpr bool gccLikeTypesUsed = false;
-#endif //__GNUC__
-#endif //USE_BOOST_MULTIPRECISION
+    using MandelBrotRenderer::typeIsCompiledIn;
 
     AddNumericTypeToSelector("float (single precision)", internalDataType::singlePrecisionFloat, nameUser);
     AddNumericTypeToSelector("double (double precision)", internalDataType::doublePrecisionFloat, nameUser);
-    AddNumericTypeToSelector("customized floating point type", internalDataType::customFloat20, nameUser, boostTypesUsed);
-    AddNumericTypeToSelector("20 decimal digit precision float", internalDataType::float20dd, nameUser, boostTypesUsed);
-    AddNumericTypeToSelector("30 decimal digit precision float", internalDataType::float30dd, nameUser, boostTypesUsed);
-    AddNumericTypeToSelector("50 decimal digit precision float", internalDataType::float50dd, nameUser, boostTypesUsed);
-    AddNumericTypeToSelector("80 bit floating type", internalDataType::float80, nameUser, gccLikeTypesUsed);
-    AddNumericTypeToSelector("128 bit floating type", internalDataType::float128, nameUser, gccLikeTypesUsed);
+    AddNumericTypeToSelector("customized floating point type", internalDataType::customFloat20, nameUser, typeIsCompiledIn(internalDataType::customFloat20));
+    AddNumericTypeToSelector("20 decimal digit precision float", internalDataType::float20dd, nameUser, typeIsCompiledIn(internalDataType::float20dd));
+    AddNumericTypeToSelector("30 decimal digit precision float", internalDataType::float30dd, nameUser, typeIsCompiledIn(internalDataType::float30dd));
+    AddNumericTypeToSelector("50 decimal digit precision float", internalDataType::float50dd, nameUser, typeIsCompiledIn(internalDataType::float50dd));
+    AddNumericTypeToSelector("80 bit floating type", internalDataType::float80, nameUser, typeIsCompiledIn(internalDataType::float80));
+    AddNumericTypeToSelector("128 bit floating type", internalDataType::float128, nameUser, typeIsCompiledIn(internalDataType::float128));
     AddNumericTypeToSelector("32 bit integer", internalDataType::int32, nameUser);
     AddNumericTypeToSelector("64 bit integer", internalDataType::int64, nameUser);
-    AddNumericTypeToSelector("128 bit integer", internalDataType::int128, nameUser, gccLikeTypesUsed);
+    AddNumericTypeToSelector("128 bit integer", internalDataType::int128, nameUser, typeIsCompiledIn(internalDataType::int128));
 }
 
 void RenderThread::setColormapSize(int value)
@@ -576,12 +1139,6 @@ const MandelBrotRenderer::RendererData& RenderThread::getRendererData() const
     return rendererData;
 }
 
-int RenderThread::calculateInitialNumThreads()
-{
-    return (std::min<int>(MAX_NUM_WORKER_THREADS,
-             MIN_NUM_UNUSED_THREADS < QThread::idealThreadCount() ? QThread::idealThreadCount() - MIN_NUM_UNUSED_THREADS : 1 ));
-}
-
 void RenderThread::writeSettings()
 {
     applicationSettingsHandler.getSettings().beginGroup("Renderer");
@@ -592,6 +1149,22 @@ void RenderThread::writeSettings()
     applicationSettingsHandler.getSettings().setValue("threadMediatorEnabled", threadMediator.getEnabled());
     applicationSettingsHandler.getSettings().setValue("colourMapSize", rendererData.colorMapSize);
     applicationSettingsHandler.getSettings().setValue("internalNumericType", toUnderlyingType(rendererData.numericType));
+    applicationSettingsHandler.getSettings().setValue("focusedRenderingEnabled", rendererData.focusedRenderingEnabled);
+    applicationSettingsHandler.getSettings().setValue("speculativeRenderingEnabled", rendererData.speculativeRenderingEnabled);
+    applicationSettingsHandler.getSettings().setValue("hugePageBuffers", frameArena.getUseHugePages());
+    applicationSettingsHandler.getSettings().setValue("snappedZoomEnabled", rendererData.snappedZoomEnabled);
+    applicationSettingsHandler.getSettings().setValue("frameBudgetEnabled", rendererData.frameBudgetEnabled);
+    applicationSettingsHandler.getSettings().setValue("frameBudgetInMs", rendererData.frameBudgetInMs);
+    applicationSettingsHandler.getSettings().setValue("backgroundModeEnabled", cpuThrottle.isEnabled());
+    applicationSettingsHandler.getSettings().setValue("backgroundCpuSharePercent", cpuThrottle.getCpuSharePercent());
+    mutex.lock();
+    const TileCacheSettings savedTileCacheSettings = tileCacheSettings;
+    mutex.unlock();
+    applicationSettingsHandler.getSettings().setValue("tileCacheSizeInMB", savedTileCacheSettings.memorySizeInMB);
+    applicationSettingsHandler.getSettings().setValue("diskTileCacheEnabled", savedTileCacheSettings.diskStoreEnabled);
+    applicationSettingsHandler.getSettings().setValue("diskTileCacheDirectory", savedTileCacheSettings.diskStoreDirectory);
+    applicationSettingsHandler.getSettings().setValue("diskTileCacheReadOnly", savedTileCacheSettings.diskStoreReadOnly);
+    applicationSettingsHandler.getSettings().setValue("diskTileCacheSizeInMB", savedTileCacheSettings.diskStoreSizeInMB);
     applicationSettingsHandler.getSettings().endGroup();
     applicationSettingsHandler.getSettings().sync();
 }
@@ -602,11 +1175,30 @@ void RenderThread::processSettingUpdate(QSettings &settings)
 
     numWorkerThreads = settings.value("numWorkerThreads", calculateInitialNumThreads()).toInt();
     rendererData.pendingNumWorkerThreads = numWorkerThreads;
+    targetNumWorkerThreads = numWorkerThreads;
     rendererData.currentNumPassValue = settings.value("currentNumPassValue", possiblePassValues[1]).toInt();
     rendererData.nextNumPassValue = rendererData.currentNumPassValue;
     rendererData.colorMapSize = settings.value("colourMapSize", MandelBrotRenderer::DefaultColormapSize).toInt();
     rendererData.numericType = static_cast<internalDataType>(settings.value("internalNumericType",
                                                                             static_cast<int>(internalDataType::doublePrecisionFloat)).toInt());
+    rendererData.focusedRenderingEnabled = settings.value("focusedRenderingEnabled", focusedRenderingDefaultEnabled).toBool();
+    rendererData.speculativeRenderingEnabled = settings.value("speculativeRenderingEnabled", speculativeRenderingDefaultEnabled).toBool();
+    frameArena.setUseHugePages(settings.value("hugePageBuffers", hugePageBuffersDefaultEnabled).toBool());
+    rendererData.snappedZoomEnabled = settings.value("snappedZoomEnabled", snappedZoomDefaultEnabled).toBool();
+    rendererData.frameBudgetEnabled = settings.value("frameBudgetEnabled", frameBudgetDefaultEnabled).toBool();
+    rendererData.frameBudgetInMs = std::max(1, settings.value("frameBudgetInMs", FrameBudget::DEFAULT_BUDGET_IN_MS).toInt());
+    cpuThrottle.setLimit(settings.value("backgroundModeEnabled", backgroundModeDefaultEnabled).toBool(),
+                         settings.value("backgroundCpuSharePercent", CpuThrottle::DEFAULT_CPU_SHARE_PERCENT).toInt());
+    targetNumWorkerThreads = cpuThrottle.limitWorkerCount(numWorkerThreads);
+
+    mutex.lock();
+    tileCacheSettings.memorySizeInMB = std::max(0, settings.value("tileCacheSizeInMB", tileCacheDefaultSizeInMB).toInt());
+    tileCacheSettings.diskStoreEnabled = settings.value("diskTileCacheEnabled", diskTileCacheDefaultEnabled).toBool();
+    tileCacheSettings.diskStoreDirectory = settings.value("diskTileCacheDirectory", DiskTileStore::defaultDirectory()).toString();
+    tileCacheSettings.diskStoreReadOnly = settings.value("diskTileCacheReadOnly", false).toBool();
+    tileCacheSettings.diskStoreSizeInMB = std::max(0, settings.value("diskTileCacheSizeInMB", diskTileCacheDefaultSizeInMB).toInt());
+    tileCacheSettingsChanged = true;
+    mutex.unlock();
 
     threadMediator.setEnabled(settings.value("threadMediatorEnabled", threadReallocationDefaultEnabled).toBool());
 
@@ -624,10 +1216,123 @@ void RenderThread::prepareForNewTasks()
     adjustWorkerThreadCount();
     displayer->configureThreadInfo(numWorkerThreads, threadState::starting);
     threadMediator.resetThreadMediator();
+    threadMediator.resetWaitStatistics();
+    ComputedDataSegment::resetCounters();
+    frameArena.resetCounters();
+    owner->getPauseGate().resetStatistics();
     populateColorMap();
     rendererData.iterationSumCount = 0;
 }
 
+/*
+ * The view most recently passed to render(), the caller must hold the mutex
+ */
+ViewParameters RenderThread::getRequestedView() const
+{
+    return ViewParameters { originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                            preciseOriginX, preciseOriginY,
+#endif
+                            scaleFactor, resultSize };
+}
+
+ViewCacheKey RenderThread::createViewCacheKey(const ViewParameters& view, int numPasses) const
+{
+    return ViewCacheKey { view, numPasses, rendererData.numericType, rendererData.colorMapSize };
+}
+
+/*
+ * Show a previously rendered image of the requested view instead of computing it again
+ */
+bool RenderThread::presentCachedView(const ViewParameters& view)
+{
+    if (!viewCache.find(createViewCacheKey(view, rendererData.nextNumPassValue), cachedView)) {
+        return false;
+    }
+
+    const int NumPasses = adjustNumPasses();
+    currentImage = &cachedView.image;
+    //views provided by the render history come without their iteration count
+    if (cachedView.iterationSumCount != MandelBrotRenderer::notYetInitializedInt64) {
+        rendererData.iterationSumCount = cachedView.iterationSumCount;
+        owner->setIterationSumCount(rendererData.iterationSumCount);
+    }
+
+    emit renderStarting();
+    emit renderedImage(currentImage, view.scaleFactor);
+    emit chunkDone(numWorkerThreads * NumPasses);
+    emit allDone();
+    emit frameCompleted(cachedView.image, view.originX, view.originY, view.scaleFactor, NumPasses);
+    emit writeToLog("View taken from the cache", true);
+    emit(sendTransientStatusMessage("Rendering completed"));
+    owner->getInfoDisplayer()->setRenderState(InformationDisplay::renderState::idle);
+
+    return true;
+}
+
+/*
+ * Queue the views the user is most likely to request next (generated exactly as
+ * MandelbrotWidget::zoom() and scroll() do) for rendering into the view cache while idle
+ */
+void RenderThread::queueSpeculativeViews(const ViewParameters& view)
+{
+    speculativeViews.clear();
+    if (!rendererData.speculativeRenderingEnabled) {
+        return;
+    }
+
+    auto scrolledView = [&view](int deltaX, int deltaY) {
+        ViewParameters result = view;
+        MandelBrotRenderer::CoordValue originX = view.originX;
+        MandelBrotRenderer::CoordValue originY = view.originY;
+        result.originX = MandelbrotWidget::computeDeltaWithHigherPrecision(originX, deltaX, view.scaleFactor);
+        result.originY = MandelbrotWidget::computeDeltaWithHigherPrecision(originY, deltaY, view.scaleFactor);
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+        result.preciseOriginX = result.originX;
+        result.preciseOriginY = result.originY;
+#endif
+        return result;
+    };
+
+    const bool snapped = rendererData.snappedZoomEnabled;
+    ViewParameters zoomedIn = view;
+    zoomedIn.scaleFactor *= snapped ? MandelbrotWidget::snapZoomFactor(MandelbrotWidget::ZoomInFactor) : MandelbrotWidget::ZoomInFactor;
+    ViewParameters zoomedOut = view;
+    zoomedOut.scaleFactor *= snapped ? MandelbrotWidget::snapZoomFactor(MandelbrotWidget::ZoomOutFactor) : MandelbrotWidget::ZoomOutFactor;
+
+    const int step = MandelbrotWidget::ScrollStep;
+    for (const auto& i : { zoomedIn, scrolledView(-step, 0), scrolledView(step, 0),
+                           scrolledView(0, -step), scrolledView(0, step), zoomedOut }) {
+        if (!viewCache.contains(createViewCacheKey(i, rendererData.nextNumPassValue))) {
+            speculativeViews.push_back(i);
+        }
+    }
+}
+
+/*
+ * Block until the next render request, unless speculative views are still to be rendered
+ */
+void RenderThread::waitForNextRequest()
+{
+    if (!quitIsPending) {
+        mutex.lock();
+        if (restart || abort) {
+            speculativeViews.clear();
+        }
+        if (!restart && !abort && speculativeViews.empty()) {
+            condition.wait(&mutex);
+        }
+        mutex.unlock();
+    }
+    else
+    {
+        sem->acquire(launchedWorkers);
+        int busyThreads = threadMediator.getBusyThreadCount();
+        Q_ASSERT(busyThreads == 0);
+        sem->release(launchedWorkers);
+    }
+}
+
 void RenderThread::run()
 {
     bool endThisRun = false;
@@ -637,67 +1342,145 @@ void RenderThread::run()
 
     InitializeDynamicValuesInGUI();
 
+    launchedWorkers = numWorkerThreads;
     sem = new QSemaphore(numWorkerThreads);
     while (!endThisRun) {
         mutex.lock();
 
-        timer.start();
-        elapsedTimeLastRun = 0;
+        //a pending request always takes precedence over the speculative views
+        if (restart) {
+            speculativeViews.clear();
+        }
+        restart = false;
+        acceptProvidedViews();
+
+        const bool speculative = !quitIsPending && !speculativeViews.empty();
+        ViewParameters view;
+        bool interactive = false;
+        if (speculative) {
+            view = speculativeViews.front();
+            speculativeViews.pop_front();
+        } else {
+            view = getRequestedView();
+            interactive = (requestedServiceClass == renderServiceClass::interactive);
+            timer.start();
+            elapsedTimeLastRun = 0;
+        }
+        speculativeRenderActive = speculative;
 
-        QSize resultSize = this->resultSize;
-        double scaleFactor = this->scaleFactor;
+        QSize resultSize = view.size;
+        double scaleFactor = view.scaleFactor;
         //TODO - fix this shadowing
-        MandelBrotRenderer::CoordValue originX = this->originX;
-        MandelBrotRenderer::CoordValue originY = this->originY;
+        MandelBrotRenderer::CoordValue originX = view.originX;
+        MandelBrotRenderer::CoordValue originY = view.originY;
 #if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
-        QString preciseOriginX = this->preciseOriginX;
-        QString preciseOriginY = this->preciseOriginY;
+        QString preciseOriginX = view.preciseOriginX;
+        QString preciseOriginY = view.preciseOriginY;
 #endif
+        if (!quitIsPending) {
+            //the workers of any previous render are done at this point, from now on render() cancels this one
+            cancellationToken.reset();
+        }
         mutex.unlock();
 
+        if (!speculative && !quitIsPending && presentCachedView(view)) {
+            queueSpeculativeViews(view);
+            waitForNextRequest();
+            continue;
+        }
+
         auto halfWidth = static_cast<double>(resultSize.width()) / 2.0;
 
         auto halfHeight = static_cast<double>(resultSize.height()) / 2.0;
         double fullHeight = resultSize.height();
-        QImage image(resultSize, QImage::Format_RGB32);
+        //the pixel buffer is reused from earlier renders of the same size
+        QImage image = frameArena.createImage(resultSize);
         currentImage = &image;
 
         int pass = 0;
         if (!quitIsPending) {
             //quit flow skips signalling to dependent GUI elements in order to simplify its appearance
-            emit(sendStatusMessage("Rendering in progress"));
-            emit(renderStarting());
+            if (!speculative) {
+                emit(sendStatusMessage("Rendering in progress"));
+                emit(renderStarting());
+            }
 
             abort = false;
 
             std::cout << "Dynamic flow enabled state: " << threadMediator.getEnabled() << std::endl;
         }
-        emit chunkDone(0);
-        passesDone = 0;
+        if (!speculative) {
+            emit chunkDone(0);
+            passesDone = 0;
+        }
 
         computationChunksDone = 0;
 
-        sem->acquire(numWorkerThreads);
+        sem->acquire(launchedWorkers);
 
         mutex.lock();
         releaseHelpers(helpers);
 
-        sem->release(numWorkerThreads);
+        sem->release(launchedWorkers);
         prepareForNewTasks();
 
         const int NumPasses = adjustNumPasses();
+        applyTileCacheSettings();
 
         const double roundOffCorrection =  0.25;
-        const double heightStep = (fullHeight + roundOffCorrection)/ numWorkerThreads;
         mutex.unlock();
 
-        clearBuffers();
+        //shared by all the tasks of this render, the workers write their lines straight into the image
+        PassContext runningPass { view, 0, NumPasses, createTaskParameters(view, image) };
+        PassContext* activePass = nullptr;
+
+        //a whole pixel translation of a cached view (e.g. after panning) only needs
+        //the newly exposed strips computed, straight away at final quality
+        std::vector<QRect> exposedAreas;
+        //a final render pre-empted during its final pass carries on where it stopped
+        const bool resumed = !quitIsPending && !speculative && !interactive &&
+                resumeSuspendedRender(createViewCacheKey(view, NumPasses), runningPass.parameters, exposedAreas);
+        //interactive renders are coarse previews, they neither take over nor leave final quality pixels
+        const bool translated = !quitIsPending && !resumed && !interactive &&
+                reuseTranslatedView(createViewCacheKey(view, NumPasses), runningPass.parameters, exposedAreas);
+        bool tilesRestored = false;
+        bool previewReused = false;
+        if (translated || resumed) {
+            pass = NumPasses - 1;
+        } else if (!quitIsPending && !interactive) {
+            previewReused = !speculative && reuseInteractivePreview(createViewCacheKey(view, NumPasses), runningPass.parameters);
+            if (rendererData.snappedZoomEnabled) {
+                //a power of two zoom of a cached view only needs the samples between the old ones
+                reuseZoomedSamples(createViewCacheKey(view, NumPasses), runningPass.parameters);
+            }
+            //tiles cached by earlier renders at this scale (of any view size) are not computed again
+            tilesRestored = restoreCachedTiles(view, NumPasses, runningPass.parameters, exposedAreas);
+            if (tilesRestored && exposedAreas.empty()) {
+                pass = NumPasses - 1;
+            }
+        }
+
+        //pass costs are only representative when every pixel of the view is computed
+        const bool passesAreMeasured = (pass == 0 && !tilesRestored && runningPass.parameters.reusedSamples.step == 0);
+        //an interactive render first shows a preview fitting the frame time budget, then refines it to full quality
+        FrameBudget::Plan previewPlan = FrameBudget::noPreview;
+        if (interactive) {
+            previewPlan = FrameBudget::Plan { INTERACTIVE_SAMPLE_STRIDE, 0 };
+        } else if (passesAreMeasured && !speculative && !previewReused && rendererData.frameBudgetEnabled) {
+            previewPlan = frameBudget.plan(view.size, NumPasses, rendererData.numericType, rendererData.frameBudgetInMs);
+        }
+        QElapsedTimer passTimer;
+        int measuredPass = -1;
+        int measuredSampleStride = 1;
+
+        //the workers charge the iterations of the view to the job pool, see RenderWorker::execute()
+        jobPool.beginForegroundWork(speculative ? SPECULATIVE_RENDER_WEIGHT : VIEW_RENDER_WEIGHT);
 
         while (pass < NumPasses) {
             bool allBlack = true;
 
             //wait for all threads ready
-            sem->acquire(numWorkerThreads);
+            waitForPassWorkers(helpers, activePass);
 
             mutex.lock();
 
@@ -707,60 +1490,102 @@ void RenderThread::run()
 
             if (quitIsPending) {
                 pass = NumPasses;
-                sem->release(numWorkerThreads);
+                sem->release(launchedWorkers);
                 mutex.unlock();
                 endThisRun = true;
                 break;
             }
 
+            if (cancellationToken.isCancelled()) {
+                //skip the remaining passes
+                pass = NumPasses;
+                sem->release(launchedWorkers);
+                mutex.unlock();
+                break;
+            }
+
+            if (passesAreMeasured && measuredPass >= 0) {
+                frameBudget.recordPass(measuredPass, measuredSampleStride, view.size, rendererData.numericType,
+                                       passTimer.nsecsElapsed() / 1000);
+            }
+
             threadMediator.resetThreadMediator();
 
-            passesDone = pass;
+            //thread count changes made during the previous pass are kept from here on
+            adjustWorkerThreadCount();
+            const double heightStep = (fullHeight + roundOffCorrection)/ numWorkerThreads;
+            if (pass > 0) {
+                computationChunksDone = pass * numWorkerThreads;
+                if (!speculative) {
+                    emit chunkDone(computationChunksDone);
+                }
+            }
+            progressChunkLimit = (pass + 1) * numWorkerThreads;
+
+            if (!speculative) {
+                passesDone = pass;
 
-            emit renderedImage(currentImage, scaleFactor);
+                emit renderedImage(currentImage, scaleFactor);
+            }
 
             rendererData.iterationSumCount = 0;
 
-            double currentHeight = -halfHeight;
+            std::vector<int> segmentBoundaries(static_cast<std::size_t>(numWorkerThreads) + 1);
+            for (std::size_t i = 0; i < segmentBoundaries.size(); ++i) {
+                segmentBoundaries[i] = static_cast<int>(-halfHeight + static_cast<double>(i) * heightStep);
+            }
+
+            prepareLineCostEstimate(pass, segmentBoundaries.front(), segmentBoundaries.front() + resultSize.height());
+            //give each worker a task of (roughly) equal estimated cost
+            lineCostEstimate.balanceBoundaries(segmentBoundaries);
+
+            if (translated || tilesRestored || resumed) {
+                //the rest of the image was copied from the cached view, tiles or pre-empted render
+                focusTaskQueue.prepare(exposedAreas);
+            } else if (rendererData.focusedRenderingEnabled) {
+                //workers take tiles nearest the focus point instead of computing their own segment
+                focusTaskQueue.prepare(QRect(QPoint(static_cast<int>(-halfWidth), segmentBoundaries.front()),
+                                             QPoint(static_cast<int>(halfWidth) - 1, segmentBoundaries.back() - 1)));
+            } else {
+                focusTaskQueue.deactivate();
+            }
 
             std::cout << "**** " << "pass: " << pass << " ****" << std::endl;
 
+            runningPass.pass = pass;
+            measuredSampleStride = (pass <= previewPlan.lastPreviewPass) ? previewPlan.sampleStride : 1;
+            runningPass.parameters.previewSamples = FrameBudget::createSampleGrid(view.size, measuredSampleStride);
+            measuredPass = pass;
+            passTimer.start();
+            if (pass == NumPasses - 1 && !speculative && !interactive) {
+                //the completed areas let the final pass be resumed if an interactive request pre-empts it
+                QMutexLocker areasLocker(&completedAreasMutex);
+                completedAreas.clear();
+                if (translated || tilesRestored || resumed) {
+                    QRegion copiedArea(QRect(QPoint(-static_cast<int>(halfWidth), segmentBoundaries.front()),
+                                             QPoint(static_cast<int>(halfWidth) - 1, segmentBoundaries.back() - 1)));
+                    for (const auto& i : exposedAreas) {
+                        copiedArea -= QRegion(i);
+                    }
+                    const QVector<QRect> copiedRects = copiedArea.rects();
+                    completedAreas.assign(copiedRects.begin(), copiedRects.end());
+                }
+                recordingCompletedAreas = true;
+            } else {
+                recordingCompletedAreas = false;
+            }
+            launchedWorkers = 0;
+            activeWorkers = 0;
+            appliedNumWorkerThreads = numWorkerThreads;
+            //the workers of the previous pass are cleaned up, so these get the indices 0 to numWorkerThreads - 1
             for (int i = 0; i < numWorkerThreads; ++i)
             {
-                /* launch worker tasks in new threads to start computing immediately */
-                helpers.emplace_back
-                        (new RenderWorker(this,
-                                                owner,
-                                                 static_cast<uint>(pass),
-                                                 static_cast<uint>(NumPasses),
-                                                 colormap,
-                                                 restart,
-                                                 abort,
-                                                 i,
-                                                ComputedDataSegment( RegionAttributes(scaleFactor,
-                                                                                      originX, originY,
-#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
-                                                                                      preciseOriginX,
-                                                                                      preciseOriginY,
-#endif
-                                                                                      static_cast<int>(-halfWidth),
-                                                                                      static_cast<int>(halfWidth),
-                                                                                      static_cast<int>(currentHeight),
-                                                                                      static_cast<int>(currentHeight + heightStep),
-                                                                                      static_cast<int>(fullHeight)),
-                                                                     &image,
-                                                                    i,
-                                                                    bufferedResults[static_cast<size_t>(i)],
-                                                                    bufferedAttributes[static_cast<size_t>(i)])
-                                                ,
-                                                 haltChecker([&]{
-                                                        return abort;
-                                                        }),
-                                                    *owner->getMutex(static_cast<std::size_t>(i))
-                                                 )
-                        );
-                currentHeight += heightStep;
+                const bool launched = launchWorker(helpers, runningPass,
+                                                   segmentBoundaries[static_cast<size_t>(i)], segmentBoundaries[static_cast<size_t>(i) + 1]);
+                Q_ASSERT(launched);
+                Q_UNUSED(launched);
             }
+            activePass = &runningPass;
 
             mutex.unlock();
 
@@ -768,64 +1593,102 @@ void RenderThread::run()
                 pass = NumPasses / 2;
 
                 computationChunksDone = (pass  - 1) * numWorkerThreads;
-                emit chunkDone(computationChunksDone);
+                progressChunkLimit = pass * numWorkerThreads;
+                if (!speculative) {
+                    emit chunkDone(computationChunksDone);
+                }
 
             } else {
 
-                if (!restart)
+                if (!restart && !speculative)
                 {
                     elapsedTimeLastRun = timer.elapsed();
                     passesDone = pass;
                 }
                 ++pass;
             }
+
+            if (previewPlan.lastPreviewPass >= 0 && pass > previewPlan.lastPreviewPass && pass < NumPasses - 1) {
+                //the preview is done, the final pass follows straight away (unless a new request cancels it)
+                pass = NumPasses - 1;
+            }
+
+            if (interactive) {
+                //a single coarse pass, the final render follows once the interaction stops
+                pass = NumPasses;
+            }
         }
 
         bool forcedToStop = false;
 
         if (pass >= NumPasses)
         {
-            sem->acquire(numWorkerThreads);
+            waitForPassWorkers(helpers, activePass);
             int busyThreads = threadMediator.getBusyThreadCount();
             Q_ASSERT(busyThreads == 0);
             emit writeToLog("emitting allDone, pass: " + QString::number(pass));
 
-            emit chunkDone(numWorkerThreads * NumPasses);
-            msleep(PROGRESS_BAR_WAIT_IN_MS);
+            const bool completed = !cancellationToken.isCancelled() && !quitIsPending;
+            if (!completed) {
+                emit writeToLog("Time from cancellation to all workers idle (us): " +
+                                QString::number(cancellationToken.getMaxStopLatencyInUs()), true);
+                if (recordingCompletedAreas && !quitIsPending) {
+                    suspendRender(createViewCacheKey(view, NumPasses), image);
+                }
+            } else if (interactive) {
+                interactivePreview = std::make_pair(createViewCacheKey(view, NumPasses), image);
+            } else {
+                if (passesAreMeasured && measuredPass >= 0) {
+                    frameBudget.recordPass(measuredPass, measuredSampleStride, view.size, rendererData.numericType,
+                                           passTimer.nsecsElapsed() / 1000);
+                }
+                viewCache.insert(createViewCacheKey(view, NumPasses), CachedView { image, rendererData.iterationSumCount });
+                storeCompletedTiles(view, NumPasses, runningPass.parameters);
+                if (!speculative) {
+                    emit frameCompleted(image, view.originX, view.originY, view.scaleFactor, NumPasses);
+                }
+            }
+            recordingCompletedAreas = false;
 
-            owner->setIterationSumCount(rendererData.iterationSumCount);
+            if (speculative) {
+                sem->release(launchedWorkers);
+                abort = false;
+                if (!completed) {
+                    speculativeViews.clear();
+                }
+            } else {
+                emit chunkDone(numWorkerThreads * NumPasses);
+                msleep(PROGRESS_BAR_WAIT_IN_MS);
 
-            sem->release(numWorkerThreads);
+                owner->setIterationSumCount(rendererData.iterationSumCount);
 
-            std::cout << " <<<<<<<<<<<<<<<<<< ALL DONE >>>>>>>> " << "available: " << sem->available() << std::endl;
+                sem->release(launchedWorkers);
 
-            emit(allDone());
-            forcedToStop = abort;
-            abort = false;
-        }
+                std::cout << " <<<<<<<<<<<<<<<<<< ALL DONE >>>>>>>> " << "available: " << sem->available() << std::endl;
 
-        releaseHelpers(helpers);
-        createChecksum(forcedToStop);
-        emit(sendTransientStatusMessage("Rendering completed"));
-        owner->getInfoDisplayer()->setRenderState(
-            forcedToStop ? InformationDisplay::renderState::aborted : InformationDisplay::renderState::idle);
+                emit(allDone());
+                forcedToStop = abort;
+                abort = false;
 
-        if (!quitIsPending) {
-            mutex.lock();
-            if (!restart && !abort) {
-                condition.wait(&mutex);
+                if (completed && !interactive) {
+                    queueSpeculativeViews(view);
+                }
             }
-            restart = false;
-            mutex.unlock();
         }
-        else
-        {
-            sem->acquire(numWorkerThreads);
-            int busyThreads = threadMediator.getBusyThreadCount();
-            Q_ASSERT(busyThreads == 0);
-            sem->release(numWorkerThreads);
+
+        jobPool.endForegroundWork();
+
+        releaseHelpers(helpers);
+        if (!speculative) {
+            createChecksum(forcedToStop);
+            emit(sendTransientStatusMessage("Rendering completed"));
+            owner->getInfoDisplayer()->setRenderState(
+                forcedToStop ? InformationDisplay::renderState::aborted : InformationDisplay::renderState::idle);
         }
+
+        waitForNextRequest();
     }
+    speculativeRenderActive = false;
     std::cout << " master thread run done!" << std::endl;
 }
 
@@ -843,64 +1706,28 @@ void RenderThread::publishCoordinates() const
 #endif
 }
 
- void RenderThread::drawPreComputedData(ComputedDataSegment& data)
+ /*
+  * The pixels of the segment are already in the image, only its statistics are collected
+  */
+ void RenderThread::acceptComputedSegment(ComputedDataSegment& data)
 {
     QMutexLocker locker(&mutex2);
-    int i = 0;
 
     if(data.hasBeenUsed())
     {
         return;
     }
-
-    MQuintVector rawResultData = data.extractRawResultData();
-
-    if (rawResultData.empty())
-    {
-        //TODO add a flag to check this is as expected
-        return;
-    }
+    data.markConsumed();
 
     rendererData.iterationSumCount += data.getFullResultData().iterationSum;
-    owner->setIterationSumCount(rendererData.iterationSumCount);
-
-    QImage *image = data.getImage();
-
-    if (image == nullptr || image->isNull() || image->format() == QImage::Format_Invalid)
-    {
-       emit writeToLog("NULL or invalid image referenced in segment data!");
-       return;
+    if (!speculativeRenderActive) {
+        owner->setIterationSumCount(rendererData.iterationSumCount);
     }
 
     const int segmentIndex = data.getSegmentIndex();
 
-    emit writeToLog("drawing data for segment: " + QString::number(segmentIndex), false);
-
-    const int minX = data.getMinX();
-    const int maxX = data.getMaxX();
-    const int minY = data.getMinY();
-    const int maxY = data.getMaxY();
-    const int fullHeight = data.getFullHeight();
-
-    for (int y = minY; y < maxY; ++y)
-    {
-        auto scanLine =
-                reinterpret_cast<uint *>(image->scanLine(y + ((fullHeight)/ 2)));
-
-        for (int x = minX; x < maxX; ++x)
-        {
-
-            *scanLine++ = rawResultData[i++];
-            //*scanLine++ = rawResultData.at(i++);
-        }
-    }
-
-    bufferedResults[static_cast<size_t>(segmentIndex)].clear();
-    bufferedResults[static_cast<size_t>(segmentIndex)].append(rawResultData);
-
-    bufferedAttributes[static_cast<size_t>(segmentIndex)] = data.getAttributes();
-
-    rawResultData.clear();
+    emit writeToLog("lines " + QString::number(data.getMinY()) + " to " + QString::number(data.getMaxY()) +
+                    " ready for segment: " + QString::number(segmentIndex), false);
 
     QObject* signalSender = QObject::sender();
     auto thread = dynamic_cast<RenderWorker* >(signalSender);
@@ -908,13 +1735,17 @@ void RenderThread::publishCoordinates() const
     {
         WorkerThreadData&& threadData = thread->transferWorkerThreadData();
         emit writeToLog("acquired data, pass: " + QString::number(threadData.getPassData()));
-        threadData.getValues().push_back(minX);
+        threadData.getValues().push_back(data.getMinX());
     }
  }
 
  void RenderThread::markThreadProgressComplete()
  {
-     emit chunkDone(++computationChunksDone);
+     //workers added or relaunched during a pass don't add to its share of the progress
+     computationChunksDone = std::min(computationChunksDone + 1, progressChunkLimit);
+     if (!speculativeRenderActive) {
+         emit chunkDone(computationChunksDone);
+     }
  }
 
 
@@ -927,13 +1758,3 @@ void RenderThread::publishCoordinates() const
  {
      halt(false);
  }
-
- void RenderThread::clearBuffers()
- {
-     bufferedAttributes.clear();
-
-     for (int i = 0; i < MAX_NUM_WORKER_THREADS; ++i)
-     {
-        bufferedAttributes.emplace_back(RegionAttributes());
-     }
- }
@@ -1,6 +1,8 @@
 #include "renderthreadmediator.h"
 #include "renderworker.h"
 
+#include <QElapsedTimer>
+
 
 /************************************************
  *  Dynamic Task algorithm helper class
@@ -13,11 +15,14 @@
  ************************************************/
 
 using MandelBrotRenderer::nonExistentThreadIndex;
+using MandelBrotRenderer::RenderTask;
 
 RenderThreadMediator::RenderThreadMediator(MandelBrotRenderer::RendererData& rendererData) :
     rendererData(rendererData),
     allocationUnderway(false), requestUnderway(false),
-    readyThreadIndex(nonExistentThreadIndex), busyThreadCount(0),  waitingThreadCount(0), sharedSegmentCount(0)
+    readyThreadIndex(nonExistentThreadIndex), busyThreadCount(0),  waitingThreadCount(0),
+    taskForSharing { 0, 0, 0, 0, nonExistentThreadIndex }, sharedSegmentCount(0),
+    wakeupCount(0), waitTimeInNs(0)
 {
     waitingThreads.fill(nonExistentThreadIndex);
     doneThreads.fill(false);
@@ -72,7 +77,7 @@ void RenderThreadMediator::resetThreadMediator()
 
     readyThreadIndex.store(nonExistentThreadIndex);
 
-    clearNewTaskSegment();
+    clearNewTask();
 
     waitingThreadCount.store(0);
 
@@ -128,14 +133,15 @@ bool RenderThreadMediator::requestNewTask(RenderWorker* workerThread)
         workerThread->publishState(MandelBrotRenderer::threadState::idle);
        return false;
     }
-    // find a shared task, keep trying if it's not yet available (but expected)
+    QMutexLocker locker(&mutex);
+
+    // find a shared task, wait for one if it's not yet available (but expected)
     while(
           (BusyThreadsExist() ||
            computeSegmentsAreReadyForSharing()) &&
           !newTaskReceived.load())
     {
         {
-            QMutexLocker locker(&mutex);
             int workerThreadIndex = workerThread->getThreadIndex();
 
             if (readyThreadIndex.load() == nonExistentThreadIndex ||
@@ -154,20 +160,34 @@ bool RenderThreadMediator::requestNewTask(RenderWorker* workerThread)
                 if (computeSegmentsAreReadyForSharing() &&
                         threadIsReady) {
 
-                    workerThread->setSegment(getNewTaskSegment());
-                    clearNewTaskSegment();
+                    workerThread->setTask(takeNewTask());
                     newTaskReceived.store(true);
                     removeThreadFromWaitingQueue(static_cast<uint>(workerThread->getThreadIndex()));
                     waitingThreadCount.store(0);
                     readyThreadIndex.store(nonExistentThreadIndex);
                     setAllocationUnderway(false);
+                    //let another waiting thread take over as the ready thread
+                    taskAvailable.wakeAll();
                 }
             }
 
-            locker.unlock();
+            //only the ready thread may take a published segment, every other thread must
+            //release the mutex here (the ready thread may be waiting to reacquire it)
+            const bool taskIsForThisThread = (readyThreadIndex.load() == workerThreadIndex) &&
+                                             computeSegmentsAreReadyForSharing();
+            if (!newTaskReceived.load() && !taskIsForThisThread)
+            {
+                QElapsedTimer waitTimer;
+                waitTimer.start();
+                taskAvailable.wait(&mutex, MAX_WAIT_FOR_TASK_IN_MS);
+                waitTimeInNs += waitTimer.nsecsElapsed();
+                ++wakeupCount;
+            }
         }
     }
 
+    locker.unlock();
+
     if (!newTaskReceived.load())
     {
         workerThread->publishState(MandelBrotRenderer::threadState::idle);
@@ -190,12 +210,15 @@ bool RenderThreadMediator::shareTask(RenderWorker *workerThread)
     return unused;
 }
 
-void RenderThreadMediator::cacheComputeSegmentForSharing(const ComputedDataSegment& newTaskSegment)
+void RenderThreadMediator::cacheTaskForSharing(const RenderTask& newTask)
 {
-    Q_ASSERT(segmentsForSharing.getSegmentIndex() == nonExistentThreadIndex);
+    Q_ASSERT(!computeSegmentsAreReadyForSharing());
 
-    segmentsForSharing = newTaskSegment;
+    taskForSharing = newTask;
     sharedSegmentCount.store(1);
+
+    //the caller holds the mediator mutex (via shareTask)
+    taskAvailable.wakeAll();
 }
 
 bool RenderThreadMediator::computeSegmentsAreReadyForSharing() const
@@ -203,17 +226,23 @@ bool RenderThreadMediator::computeSegmentsAreReadyForSharing() const
     return (sharedSegmentCount.load() > 0);
 }
 
-ComputedDataSegment &RenderThreadMediator::getNewTaskSegment()
+/*
+ * Hand the shared task over to the caller,
+ * the caller holds the mediator mutex
+ */
+RenderTask RenderThreadMediator::takeNewTask()
 {
     Q_ASSERT(computeSegmentsAreReadyForSharing());
-    Q_ASSERT(segmentsForSharing.getSegmentIndex() != nonExistentThreadIndex);
 
-    return segmentsForSharing;
+    const RenderTask newTask = taskForSharing;
+    clearNewTask();
+
+    return newTask;
 }
 
-void RenderThreadMediator::clearNewTaskSegment()
+void RenderThreadMediator::clearNewTask()
 {
-    segmentsForSharing.clearSegmentIndex();
+    taskForSharing = RenderTask { 0, 0, 0, 0, nonExistentThreadIndex };
     sharedSegmentCount.store(0);
 }
 
@@ -242,7 +271,29 @@ void RenderThreadMediator::setRequestUnderway(bool value)
 void RenderThreadMediator::setThreadDone(uint threadIndex)
 {
     Q_ASSERT(threadIndex < MandelBrotRenderer::MAX_NUM_WORKER_THREADS);
+    QMutexLocker locker(&mutex);
     doneThreads.at(threadIndex) = true;
+    taskAvailable.wakeAll();
+}
+
+void RenderThreadMediator::decrementBusyThreadCount()
+{
+    const int remainingBusyThreads = --busyThreadCount;
+    //std::cout << "threadCount-- ->  " << busyThreadCount << std::endl;
+    Q_ASSERT(remainingBusyThreads >= 0);
+
+    if (remainingBusyThreads == 0)
+    {
+        //no more tasks can be shared, release the waiting threads
+        QMutexLocker locker(&mutex);
+        taskAvailable.wakeAll();
+    }
+}
+
+void RenderThreadMediator::resetWaitStatistics()
+{
+    wakeupCount.store(0);
+    waitTimeInNs.store(0);
 }
 
 bool RenderThreadMediator::getAllocationUnderway() const
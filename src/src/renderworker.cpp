@@ -30,27 +30,29 @@ RenderWorker::RenderWorker(RenderThread* parentThread,
                                        uint finalPassValue,
                                        colorMapStore& colormap,
                                        bool restart,
-                                       const bool& abort,
+                                       const CancellationToken& cancellation,
                                        int threadIndex,
                                        ComputedDataSegment&& segment,
                                        MandelBrotRenderer::haltChecker abortChecker,
-                                       QMutex&  pauseMutex)
+                                       PauseGate& pauseGate)
     : parentThread(parentThread),
       internalData{owner, currentPassValue},
       pass(currentPassValue),
       finalPassValue(finalPassValue),
-      MaxMaxIterations(calcMaxIterations(finalPassValue)),
+      MaxMaxIterations(MandelBrotRenderer::calcMaxIterations(finalPassValue)),
       iterationColourScale(static_cast<double>(MaxMaxIterations) / static_cast<double>(colormap.size())),
       colormap(colormap),
       restart(restart),
-      abort(abort),
+      cancellation(cancellation),
       threadIndex(threadIndex),
       segment{std::move(segment)},
       currentYPosition(nonExistentPixelLinePosition),
-      pauseMutex(pauseMutex),
+      pauseGate(pauseGate),
+      throttleGate(parentThread->getCpuThrottle().getGate()),
       pointsDone(0),
       cleanedUp(false),
       computationCompleted(false),
+      retired(false),
       setToGenerate(setType::mandelbrot),
       owner(owner),
       abortChecker{std::move(abortChecker)}
@@ -60,7 +62,7 @@ RenderWorker::RenderWorker(RenderThread* parentThread,
     connect(this, SIGNAL(renderedSubImage(const QImage*,double)), owner, SLOT(updatePixmap(const QImage*,double)));
 
     connect(this, SIGNAL(finished()), parentThread, SLOT(cleanup()));
-    connect(this, SIGNAL(computationDone(ComputedDataSegment&)), parentThread, SLOT(drawPreComputedData(ComputedDataSegment&)));
+    connect(this, SIGNAL(computationDone(ComputedDataSegment&)), parentThread, SLOT(acceptComputedSegment(ComputedDataSegment&)));
     connect(this, SIGNAL(taskDone()), parentThread, SLOT(markThreadProgressComplete()));
 
     connect(parentThread, SIGNAL(sendRestart(bool)), this, SLOT(setRestart(bool)));
@@ -92,18 +94,13 @@ void RenderWorker::shareTask()
     Q_ASSERT(parentThread->getThreadMediator().threadsAreWaiting());
 
     QMutexLocker locker(&mutex);
-    ComputedDataSegment segmentForOtherThread(segment);
-    RegionAttributes newAttributesForOtherThread = segment.getAttributes();
-    newAttributesForOtherThread.adjustYValues(currentYPosition, true);
-    segmentForOtherThread.ChangeRegionAttributes(newAttributesForOtherThread);
-    segmentForOtherThread.clearRawData();
 
-    parentThread->getThreadMediator().cacheComputeSegmentForSharing(segmentForOtherThread);
+    //split the remaining lines at the point of equal estimated cost (from the previous pass), rather than in half
+    const int splitPosition = parentThread->getLineCostEstimate().findCostMidpoint(currentYPosition, segment.getMaxY());
 
-    RegionAttributes newAttributes = segment.getAttributes();
-    newAttributes.adjustYValues(currentYPosition, false);
-
-    segment.ChangeRegionAttributes(newAttributes);
+    //both parts share the job parameters and frame buffer, only the line range is handed over
+    parentThread->getThreadMediator().cacheTaskForSharing(segment.getTask().linesFrom(splitPosition));
+    segment.setTask(segment.getTask().linesBefore(splitPosition));
 
     publishState(threadState::shared);
 }
@@ -113,7 +110,7 @@ void RenderWorker::handleSegmentDone()
 {
     QMutexLocker locker(&mutex);
 
-    if (abort) {
+    if (cancellation.isCancelled()) {
        // std::cout << "pass : " << pass << " thread : " << threadIndex <<
        //              " finished after abort " << std::endl;
     }
@@ -133,8 +130,7 @@ bool RenderWorker::execute(const computeFunction& computeTask)
 {
     bool result = false;
 
-    int pauseLoopCount = 0;
-    constexpr int pauseInterval = 5;
+    int64_t pauseCheckCount = 0;
 
     emit writeToLog("worker running, thread index: " + QString::number(threadIndex));
 
@@ -143,29 +139,42 @@ bool RenderWorker::execute(const computeFunction& computeTask)
         //std::cout << "data already used!" << std::endl;
     }
 
+    if (parentThread->getFocusTaskQueue().isActive())
+    {
+        return executeFocusedTasks(computeTask);
+    }
+
     bool newTaskReceived = true;
 
     publishState(threadState::busy);
     while (newTaskReceived) {
 
         ComputeTaskResults& fullResultData = segment.getFullResultData();
-        int currentPixelIndex = 0;
         parentThread->getThreadMediator().incrementBusyThreadCount();
 
         for (int y = segment.getMinY(); y < segment.getMaxY(); ++y) {
-            if (restart || abort) {
+            if (restart || cancellation.isCancelled()) {
                 handleSegmentDone();
                 publishState(threadState::idle);
                 parentThread->getThreadMediator().decrementBusyThreadCount();
+                pauseGate.recordChecks(pauseCheckCount);
+                cancellation.recordWorkerStopped();
                 return result;
             }
 
-            if (++pauseLoopCount > pauseInterval)
+            if (y > segment.getMinY() && retireIfRequested()) {
+                //fewer threads were requested during the pass
+                handBackRemainingLines(y);
+                break;
+            }
+
+            ++pauseCheckCount;
+            if (pauseGate.isClosed())
             {
-                QMutexLocker locker(&mutex);
-                pauseMutex.lock();
-                pauseLoopCount = 0;
-                pauseMutex.unlock();
+                pauseGate.waitWhileClosed();
+            }
+            if (throttleGate.isClosed()) {
+                throttleGate.waitWhileClosed();
             }
 
             if (segment.getMaxY() - y <= MIN_REALLOCATION_SIZE_IN_PIXELS ) {
@@ -179,20 +188,40 @@ bool RenderWorker::execute(const computeFunction& computeTask)
             /***************************************
              * calculate the fractal pixel values! *
              ***************************************/
-            computeTask(segment, abort, currentPixelIndex, fullResultData, y);
+            const int64_t iterationsBeforeLine = fullResultData.iterationSum;
+            computeTask(segment, cancellation, fullResultData, y);
+            if (cancellation.isCancelled()) {
+                //the line may be partly computed, neither its cost nor its area are known
+                continue;
+            }
+            parentThread->getLineCostRecorder().recordLineCost(y, fullResultData.iterationSum - iterationsBeforeLine);
+            parentThread->getJobPool().chargeForegroundWork(fullResultData.iterationSum - iterationsBeforeLine);
+            if (parentThread->completedAreasRecorded()) {
+                parentThread->recordCompletedArea(QRect(QPoint(segment.getMinX(), y), QPoint(segment.getMaxX() - 1, y)));
+            }
         }
         handleSegmentDone();
 
         publishState(threadState::idle);
         parentThread->getThreadMediator().decrementBusyThreadCount();
 
-        //as this task is idle, contact the thread mediator to request a new compute task
+        if (retired) {
+            break;
+        }
+
+        //lines handed back by retired workers are taken first, then
+        //contact the thread mediator to request a new compute task
         //this call will block this thread if a new task looks like it can be found
-        newTaskReceived = parentThread->getThreadMediator().performDynamicThreadOperation(this, dynamicThreadAction::requestTask);
+        //(lines may also have been handed back while it was waiting)
+        newTaskReceived = takeReturnedLines() ||
+                parentThread->getThreadMediator().performDynamicThreadOperation(this, dynamicThreadAction::requestTask) ||
+                takeReturnedLines();
         if (newTaskReceived) {
             publishState(threadState::restarted);
         }
     }
+    pauseGate.recordChecks(pauseCheckCount);
+    cancellation.recordWorkerStopped();
     emit taskDone();
     result = true;
     publishState(threadState::idle);
@@ -202,17 +231,94 @@ bool RenderWorker::execute(const computeFunction& computeTask)
 
 /*
  *
- * Generate a compute task using the specified type
- * and execute the compute flow (with assistance from a mediator object)
- *
+ * Focused rendering flow: take the queued tiles nearest the focus
+ * point until none remain, publishing the results of each tile as it completes
+ * (the thread mediator isn't needed, the shared queue balances the load)
  */
 
-template <typename T>
-bool RenderWorker::executeTask()
+bool RenderWorker::executeFocusedTasks(const computeFunction& computeTask)
 {
-    ComputeTaskGenerator<T> taskGenerator(*this);
-    RenderWorker::computeFunction computeTask = taskGenerator.generateComputeTask();
-    return (execute(computeTask));
+    FocusTaskQueue& taskQueue = parentThread->getFocusTaskQueue();
+    const int jobId = segment.getTask().jobId;
+    int64_t pauseCheckCount = 0;
+    QRect tile;
+
+    publishState(threadState::busy);
+    parentThread->getThreadMediator().incrementBusyThreadCount();
+
+    while (!retireIfRequested() && taskQueue.takeNextTile(tile)) {
+        setTask(RenderTask { tile.left(), tile.right() + 1, tile.top(), tile.bottom() + 1, jobId });
+
+        ComputeTaskResults& fullResultData = segment.getFullResultData();
+
+        for (int y = segment.getMinY(); y < segment.getMaxY() && !restart && !cancellation.isCancelled(); ++y) {
+            ++pauseCheckCount;
+            if (pauseGate.isClosed())
+            {
+                pauseGate.waitWhileClosed();
+            }
+            if (throttleGate.isClosed()) {
+                throttleGate.waitWhileClosed();
+            }
+            const int64_t iterationsBeforeLine = fullResultData.iterationSum;
+            computeTask(segment, cancellation, fullResultData, y);
+            parentThread->getJobPool().chargeForegroundWork(fullResultData.iterationSum - iterationsBeforeLine);
+        }
+        handleSegmentDone();
+
+        if (!restart && !cancellation.isCancelled() && parentThread->completedAreasRecorded()) {
+            parentThread->recordCompletedArea(tile);
+        }
+
+        if (restart || cancellation.isCancelled()) {
+            publishState(threadState::idle);
+            parentThread->getThreadMediator().decrementBusyThreadCount();
+            pauseGate.recordChecks(pauseCheckCount);
+            cancellation.recordWorkerStopped();
+            return false;
+        }
+    }
+
+    parentThread->getThreadMediator().decrementBusyThreadCount();
+    pauseGate.recordChecks(pauseCheckCount);
+    emit taskDone();
+    publishState(threadState::idle);
+    parentThread->getThreadMediator().setThreadDone(static_cast<uint>(threadIndex));
+    return true;
+}
+
+/*
+ * Give up this worker's slot if fewer workers than are active were requested
+ * during the pass (the render thread decides which workers retire)
+ */
+bool RenderWorker::retireIfRequested()
+{
+    retired = parentThread->claimWorkerRetirement();
+    return retired;
+}
+
+/*
+ * Keep the lines computed so far (from the start of the segment up to y)
+ * and hand the remaining lines back to the render thread
+ */
+void RenderWorker::handBackRemainingLines(int y)
+{
+    QMutexLocker locker(&mutex);
+
+    parentThread->returnUnfinishedLines(segment.getTask().linesFrom(y));
+    segment.setTask(segment.getTask().linesBefore(y));
+}
+
+bool RenderWorker::takeReturnedLines()
+{
+    RenderTask returnedLines;
+    if (!parentThread->takeReturnedLines(returnedLines)) {
+        return false;
+    }
+
+    QMutexLocker locker(&mutex);
+    setTask(returnedLines);
+    return true;
 }
 
 /*
@@ -226,40 +332,17 @@ bool RenderWorker::getComputeResult()
     static MandelBrotRenderer::setType setTypeSetting = setType::mandelbrot;
     setToGenerate = setTypeSetting;
 
-    bool result;
+    //other services of the machine come first in background mode and for speculative (idle) renders
+    const BackgroundThreadPriority priority(parentThread->backgroundModeEnabled() || parentThread->speculativeRenderIsActive());
 
     /*
      * Generate a task object encapsulating the computations to be done with the
      * specified type
      */
-    if (parentThread->getRendererData().numericType == internalDataType::singlePrecisionFloat)
-    {
-        result = executeTask<float>();
-    } else if (parentThread->getRendererData().numericType == internalDataType::int32) {
-        result = executeTask<int32_t>();
-    } else if (parentThread->getRendererData().numericType == internalDataType::int64) {
-        result = executeTask<int64_t>();
-#if (USE_BOOST_MULTIPRECISION == 1)
-    }else if (parentThread->getRendererData().numericType == internalDataType::customFloat20) {
-        result = executeTask<CustomFloat>();
-    }else if (parentThread->getRendererData().numericType == internalDataType::float20dd) {
-        result = executeTask<Float20dd>();
-    }else if (parentThread->getRendererData().numericType == internalDataType::float30dd) {
-        result = executeTask<Float30dd>();
-    }else if (parentThread->getRendererData().numericType == internalDataType::float50dd) {
-        result = executeTask<Float50dd>();
-#endif
+    bool result = execute(generateComputeTaskForType(*this, parentThread->getRendererData().numericType));
 
-#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
-    } else if (parentThread->getRendererData().numericType == internalDataType::float80) {
-        result = executeTask<Float80>();
-    } else if (parentThread->getRendererData().numericType == internalDataType::float128) {
-        result = executeTask<Float128>();
-    } else if (parentThread->getRendererData().numericType == internalDataType::int128) {
-        result = executeTask<Int128>();
-#endif
-    } else  {
-        result = executeTask<double>();
+    if (!retired) {
+        parentThread->releaseWorkerSlot();
     }
 
     emit finished();
@@ -283,9 +366,13 @@ MandelBrotRenderer::setType RenderWorker::getSetToGenerate() const
     return setToGenerate;
 }
 
-void RenderWorker::setSegment(const ComputedDataSegment &value)
+/*
+ * Start over with a task of the same job (from another worker or handed back)
+ */
+void RenderWorker::setTask(const MandelBrotRenderer::RenderTask& task)
 {
-    segment = value;
+    segment.setTask(task);
+    segment.clearResults();
 }
 
 int RenderWorker::getThreadIndex() const
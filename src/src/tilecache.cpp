@@ -0,0 +1,241 @@
+#include "tilecache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "PrecisionHandler.h"
+#include "disktilestore.h"
+
+static int64_t floorDiv(int64_t value, int64_t divisor)
+{
+    return (value >= 0) ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+/*
+ * Split a position on the grid (in pixels) into the nearest grid pixel and the quantized phase
+ */
+template <typename T>
+static void splitGridPosition(const T& position, int64_t& index, int& phase)
+{
+    index = static_cast<int64_t>((position >= 0) ? position + static_cast<T>(0.5) : position - static_cast<T>(0.5));
+    const auto fraction = static_cast<double>(position - static_cast<T>(index));
+    phase = static_cast<int>(std::lround(fraction * TileCache::PHASES_PER_PIXEL));
+}
+
+bool TileKey::operator==(const TileKey& other) const
+{
+    return (scaleFactor == other.scaleFactor &&
+            phaseX == other.phaseX &&
+            phaseY == other.phaseY &&
+            tileX == other.tileX &&
+            tileY == other.tileY &&
+            settings.numericType == other.settings.numericType &&
+            settings.maxIterations == other.settings.maxIterations &&
+            settings.set == other.settings.set &&
+            settings.colorMapSize == other.settings.colorMapSize);
+}
+
+std::size_t TileKeyHash::operator()(const TileKey& key) const noexcept
+{
+    std::size_t hash = std::hash<double>()(key.scaleFactor);
+    auto combine = [&hash](std::size_t value) { hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2); };
+    combine(std::hash<int64_t>()(key.tileX));
+    combine(std::hash<int64_t>()(key.tileY));
+    combine(std::hash<int>()(key.phaseX * TileCache::PHASES_PER_PIXEL + key.phaseY));
+    combine(std::hash<uint>()(key.settings.maxIterations));
+    return hash;
+}
+
+TileCache::TileCache(std::size_t memoryBudgetInBytes)
+    : memoryBudget(memoryBudgetInBytes),
+      usedMemory(0),
+      backingStore(nullptr)
+{
+}
+
+/*
+ * Find the position of the view on the pixel grid of its scale,
+ * fails when the origin is too far away (in pixels) for the phase to be precise
+ */
+bool TileCache::locateGrid(const ViewParameters& view, TileGrid& grid)
+{
+    if (!(view.scaleFactor > 0.0)) {
+        return false;
+    }
+
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+    using MandelBrotRenderer::Float128;
+    static const Float128 maxGridPosition = static_cast<Float128>(1.0e18);
+    const MandelBrotRenderer::PreciseFloatResult originX = MandelBrotRenderer::generateFloatFromPreciseString(view.preciseOriginX);
+    const MandelBrotRenderer::PreciseFloatResult originY = MandelBrotRenderer::generateFloatFromPreciseString(view.preciseOriginY);
+    if (!originX.second || !originY.second) {
+        return false;
+    }
+    const Float128 positionX = originX.first / static_cast<Float128>(view.scaleFactor);
+    const Float128 positionY = originY.first / static_cast<Float128>(view.scaleFactor);
+    if (!(positionX < maxGridPosition && positionX > -maxGridPosition &&
+          positionY < maxGridPosition && positionY > -maxGridPosition)) {
+        return false;
+    }
+#else
+    static const double maxGridPosition = 1.0e12;
+    const MandelBrotRenderer::DoubleResult originX = MandelBrotRenderer::generateFloatFromString(view.originX);
+    const MandelBrotRenderer::DoubleResult originY = MandelBrotRenderer::generateFloatFromString(view.originY);
+    if (!originX.second || !originY.second) {
+        return false;
+    }
+    const double positionX = originX.first / view.scaleFactor;
+    const double positionY = originY.first / view.scaleFactor;
+    if (!(std::abs(positionX) < maxGridPosition && std::abs(positionY) < maxGridPosition)) {
+        return false;
+    }
+#endif
+
+    grid.scaleFactor = view.scaleFactor;
+    splitGridPosition(positionX, grid.indexX, grid.phaseX);
+    splitGridPosition(positionY, grid.indexY, grid.phaseY);
+    return true;
+}
+
+/*
+ * Call function(tileX, tileY, tileArea, complete) for each tile of the grid
+ * overlapping the (centred, inclusive) area, with the tile area clipped to the area
+ */
+template <typename Function>
+void TileCache::forEachTile(const TileGrid& grid, const QRect& area, Function function)
+{
+    const int64_t firstTileX = floorDiv(grid.indexX + area.left(), TILE_SIZE_IN_PIXELS);
+    const int64_t lastTileX = floorDiv(grid.indexX + area.right(), TILE_SIZE_IN_PIXELS);
+    const int64_t firstTileY = floorDiv(grid.indexY + area.top(), TILE_SIZE_IN_PIXELS);
+    const int64_t lastTileY = floorDiv(grid.indexY + area.bottom(), TILE_SIZE_IN_PIXELS);
+
+    for (int64_t tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+        const auto top = static_cast<int>(tileY * TILE_SIZE_IN_PIXELS - grid.indexY);
+        for (int64_t tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+            const auto left = static_cast<int>(tileX * TILE_SIZE_IN_PIXELS - grid.indexX);
+            const QRect tile(QPoint(left, top), QPoint(left + TILE_SIZE_IN_PIXELS - 1, top + TILE_SIZE_IN_PIXELS - 1));
+            const QRect clipped = tile.intersected(area);
+            function(tileX, tileY, clipped, clipped == tile);
+        }
+    }
+}
+
+/*
+ * Copy the cached tiles covering the (centred, inclusive) area into the frame buffer,
+ * the parts of the area still to be computed are listed in remainingAreas
+ */
+int TileCache::restoreTiles(const TileGrid& grid, const TileRenderSettings& settings, const QRect& area,
+                            const MandelBrotRenderer::FrameBuffer& frameBuffer, std::vector<QRect>& remainingAreas)
+{
+    int restoredCount = 0;
+    remainingAreas.clear();
+
+    forEachTile(grid, area, [&](int64_t tileX, int64_t tileY, const QRect& tileArea, bool complete) {
+        if (!complete) {
+            remainingAreas.push_back(tileArea);
+            return;
+        }
+
+        const TileKey key { grid.scaleFactor, grid.phaseX, grid.phaseY, tileX, tileY, settings };
+        const uint* pixels = nullptr;
+        auto found = index.find(key);
+        if (found != index.end()) {
+            //keep the most recently used tiles at the front
+            tiles.splice(tiles.begin(), tiles, found->second);
+            pixels = found->second->second.data();
+        } else if (backingStore != nullptr && (pixels = backingStore->find(key)) != nullptr) {
+            TilePixels& cachedPixels = insertTile(key);
+            std::copy(pixels, pixels + cachedPixels.size(), cachedPixels.begin());
+            pixels = cachedPixels.data();
+        } else {
+            remainingAreas.push_back(tileArea);
+            return;
+        }
+
+        for (int line = 0; line < TILE_SIZE_IN_PIXELS; ++line) {
+            const uint* source = pixels + line * TILE_SIZE_IN_PIXELS;
+            std::copy(source, source + TILE_SIZE_IN_PIXELS, frameBuffer.pixelAt(tileArea.left(), tileArea.top() + line));
+        }
+        ++restoredCount;
+    });
+
+    evictTiles();
+    return restoredCount;
+}
+
+/*
+ * Keep the complete tiles of the (centred, inclusive) area of a completely rendered frame buffer
+ */
+int TileCache::storeTiles(const TileGrid& grid, const TileRenderSettings& settings, const QRect& area,
+                          const MandelBrotRenderer::FrameBuffer& frameBuffer)
+{
+    int storedCount = 0;
+    const bool storeOnDisk = (backingStore != nullptr && backingStore->isOpen() && !backingStore->isReadOnly());
+    std::vector<std::pair<TileKey, const uint*>> newStoredTiles;
+
+    forEachTile(grid, area, [&](int64_t tileX, int64_t tileY, const QRect& tileArea, bool complete) {
+        if (!complete) {
+            return;
+        }
+
+        const TileKey key { grid.scaleFactor, grid.phaseX, grid.phaseY, tileX, tileY, settings };
+        const uint* pixels = nullptr;
+        auto found = index.find(key);
+        if (found != index.end()) {
+            //already cached, the pixels are the same
+            tiles.splice(tiles.begin(), tiles, found->second);
+            pixels = found->second->second.data();
+        } else {
+            TilePixels& cachedPixels = insertTile(key);
+            for (int line = 0; line < TILE_SIZE_IN_PIXELS; ++line) {
+                const uint* source = frameBuffer.pixelAt(tileArea.left(), tileArea.top() + line);
+                std::copy(source, source + TILE_SIZE_IN_PIXELS, cachedPixels.begin() + line * TILE_SIZE_IN_PIXELS);
+            }
+            pixels = cachedPixels.data();
+            ++storedCount;
+        }
+
+        if (storeOnDisk && !backingStore->contains(key)) {
+            newStoredTiles.emplace_back(key, pixels);
+        }
+    });
+
+    //before any tile is evicted, the pixels are referenced by the list
+    if (storeOnDisk) {
+        backingStore->storeTiles(newStoredTiles);
+    }
+
+    evictTiles();
+    return storedCount;
+}
+
+TileCache::TilePixels& TileCache::insertTile(const TileKey& key)
+{
+    tiles.emplace_front(key, TilePixels(static_cast<std::size_t>(TILE_SIZE_IN_PIXELS * TILE_SIZE_IN_PIXELS)));
+    index.emplace(key, tiles.begin());
+    usedMemory += TILE_SIZE_IN_BYTES;
+    return tiles.front().second;
+}
+
+void TileCache::setMemoryBudget(std::size_t bytes)
+{
+    memoryBudget = bytes;
+    evictTiles();
+}
+
+void TileCache::clear()
+{
+    index.clear();
+    tiles.clear();
+    usedMemory = 0;
+}
+
+void TileCache::evictTiles()
+{
+    while (usedMemory > memoryBudget && !tiles.empty()) {
+        index.erase(tiles.back().first);
+        tiles.pop_back();
+        usedMemory -= TILE_SIZE_IN_BYTES;
+    }
+}
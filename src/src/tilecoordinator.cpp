@@ -0,0 +1,402 @@
+#include "tilecoordinator.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "tileworker.h"
+
+TileCoordinator::TileCoordinator(QObject *parent)
+    : QObject{ parent },
+      localWorkersStarted(false),
+      jobActive(false),
+      jobId(0),
+      imageMinX(0),
+      imageMinY(0),
+      tileColumns(0),
+      nextLeaseId(0),
+      tilesDone(0),
+      reissuedLeaseCount(0),
+      noWorkerSince(-1)
+{
+    connect(&server, SIGNAL(newConnection()), this, SLOT(acceptWorkers()));
+    connect(&leaseTimer, SIGNAL(timeout()), this, SLOT(expireLeases()));
+    clock.start();
+}
+
+TileCoordinator::~TileCoordinator()
+{
+    //local workers exit once their connection is closed
+    for (auto i : connections) {
+        disconnect(i, nullptr, this, nullptr);
+        i->abort();
+    }
+    for (auto i : localWorkers) {
+        disconnect(i, nullptr, this, nullptr);
+        i->waitForFinished(LEASE_DURATION_IN_MS);
+    }
+}
+
+bool TileCoordinator::listen(const QHostAddress& address, quint16 port)
+{
+    return server.isListening() || server.listen(address, port);
+}
+
+/*
+ * Start worker processes on this machine, connected over the loopback interface,
+ * returns the number of processes running
+ */
+int TileCoordinator::startLocalWorkers(int count)
+{
+    if (!listen()) {
+        return 0;
+    }
+
+    localWorkersStarted = true;
+    for (int i = 0; i < count; ++i) {
+        auto worker = new QProcess(this);
+        connect(worker, SIGNAL(finished(int,QProcess::ExitStatus)), this, SLOT(localWorkerFinished(int,QProcess::ExitStatus)));
+        connect(worker, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(localWorkerError(QProcess::ProcessError)));
+        localWorkers.push_back(worker);
+        worker->start(QCoreApplication::applicationFilePath(),
+                      QStringList { QString(TileWorker::WORKER_ARGUMENT), QHostAddress(QHostAddress::LocalHost).toString(),
+                                    QString::number(getPort()) });
+    }
+
+    //a worker failing to start leaves the list (see localWorkerError())
+    const std::vector<QProcess*> started = localWorkers;
+    for (auto i : started) {
+        i->waitForStarted(WORKER_START_TIMEOUT_IN_MS);
+    }
+    return static_cast<int>(localWorkers.size());
+}
+
+/*
+ * Split the job into tiles and lease them to the workers, one job at a time
+ */
+bool TileCoordinator::render(const RenderJobRequest& request)
+{
+    const RegionAttributes& attributes = request.attributes;
+    if (attributes.getMaxX() <= attributes.getMinX() ||
+        attributes.getMaxY() <= attributes.getMinY() ||
+        request.colormap.empty())
+    {
+        throw std::out_of_range("Render job region or colormap is empty");
+    }
+
+    if (jobActive) {
+        return false;
+    }
+
+    jobActive = true;
+    jobMessage = TileProtocol::encodeJob(++jobId, request);
+    imageMinX = attributes.getMinX();
+    imageMinY = attributes.getMinY();
+    image = QImage(attributes.getMaxX() - attributes.getMinX(), attributes.getMaxY() - attributes.getMinY(), QImage::Format_RGB32);
+
+    tiles.clear();
+    pendingTiles.clear();
+    leases.clear();
+    tilesDone = 0;
+    tileColumns = (image.width() + TILE_SIZE_IN_PIXELS - 1) / TILE_SIZE_IN_PIXELS;
+    for (int y = attributes.getMinY(); y < attributes.getMaxY(); y += TILE_SIZE_IN_PIXELS) {
+        for (int x = attributes.getMinX(); x < attributes.getMaxX(); x += TILE_SIZE_IN_PIXELS) {
+            const MandelBrotRenderer::RenderTask area { x, std::min(x + TILE_SIZE_IN_PIXELS, attributes.getMaxX()),
+                                                        y, std::min(y + TILE_SIZE_IN_PIXELS, attributes.getMaxY()),
+                                                        static_cast<int>(jobId) };
+            pendingTiles.push_back(static_cast<int>(tiles.size()));
+            tiles.push_back(Tile { area, false });
+        }
+    }
+
+    for (auto i : workers) {
+        TileProtocol::sendMessage(*i, TileProtocol::messageType::job, jobMessage);
+    }
+    grantLeasesToAll();
+    noWorkerSince = workers.empty() ? clock.elapsed() : -1;
+    leaseTimer.start(LEASE_CHECK_INTERVAL_IN_MS);
+    return true;
+}
+
+/*
+ * The leases held are left to expire, their results are ignored
+ */
+void TileCoordinator::cancel()
+{
+    if (jobActive) {
+        endJob();
+        emit jobCancelled();
+    }
+}
+
+void TileCoordinator::acceptWorkers()
+{
+    while (server.hasPendingConnections()) {
+        QTcpSocket* connection = server.nextPendingConnection();
+        connect(connection, SIGNAL(readyRead()), this, SLOT(readFromWorker()));
+        connect(connection, SIGNAL(disconnected()), this, SLOT(workerDisconnected()));
+        connections.push_back(connection);
+    }
+}
+
+void TileCoordinator::readFromWorker()
+{
+    auto worker = qobject_cast<QTcpSocket*>(sender());
+    TileProtocol::messageType type;
+    QByteArray payload;
+    bool invalid = false;
+    while (TileProtocol::receiveMessage(*worker, type, payload, invalid)) {
+        processMessage(worker, type, payload);
+    }
+    if (invalid) {
+        worker->abort();
+    }
+}
+
+void TileCoordinator::processMessage(QTcpSocket* worker, TileProtocol::messageType type, const QByteArray& payload)
+{
+    const bool isWorker = (std::find(workers.begin(), workers.end(), worker) != workers.end());
+
+    if (type == TileProtocol::messageType::hello && !isWorker) {
+        if (!TileProtocol::decodeHello(payload)) {
+            worker->abort();
+            return;
+        }
+        workers.push_back(worker);
+        if (jobActive) {
+            TileProtocol::sendMessage(*worker, TileProtocol::messageType::job, jobMessage);
+            grantLeases(worker);
+        }
+        emit workersChanged(getNumWorkers());
+    } else if (type == TileProtocol::messageType::tile && isWorker) {
+        TileProtocol::TileResult tile;
+        if (!TileProtocol::decodeTile(payload, tile)) {
+            worker->abort();
+            return;
+        }
+        leases.erase(tile.leaseId);
+        storeTile(tile);
+        if (jobActive) {
+            grantLeases(worker);
+        }
+    } else {
+        worker->abort();
+    }
+}
+
+void TileCoordinator::grantLeases(QTcpSocket* worker)
+{
+    int heldLeases = static_cast<int>(std::count_if(leases.begin(), leases.end(),
+                                                    [worker](const std::pair<const quint32, Lease>& i) { return i.second.worker == worker; }));
+
+    while (heldLeases < LEASES_PER_WORKER && !pendingTiles.empty()) {
+        const int tile = pendingTiles.front();
+        pendingTiles.pop_front();
+        if (tiles[tile].done) {
+            continue;
+        }
+
+        const quint32 leaseId = nextLeaseId++;
+        leases.emplace(leaseId, Lease { tile, worker, -1 });
+        TileProtocol::sendMessage(*worker, TileProtocol::messageType::lease,
+                                  TileProtocol::encodeLease(TileProtocol::Lease { jobId, leaseId, tiles[tile].area }));
+        ++heldLeases;
+    }
+    startNextLease(worker);
+}
+
+/*
+ * The worker computes its leases in the order granted, the clock of the oldest
+ * one runs once it holds no other running lease (so a slow tile doesn't expire
+ * the one queued behind it)
+ */
+void TileCoordinator::startNextLease(QTcpSocket* worker)
+{
+    auto next = leases.end();
+    for (auto i = leases.begin(); i != leases.end(); ++i) {
+        if (i->second.worker != worker) {
+            continue;
+        }
+        if (i->second.expiresAt >= 0) {
+            return;
+        }
+        if (next == leases.end()) {
+            //the lease ids are granted in increasing order
+            next = i;
+        }
+    }
+    if (next != leases.end()) {
+        next->second.expiresAt = clock.elapsed() + LEASE_DURATION_IN_MS;
+    }
+}
+
+void TileCoordinator::grantLeasesToAll()
+{
+    for (auto i : workers) {
+        grantLeases(i);
+    }
+}
+
+/*
+ * Keep the first result of a tile of the current job, wherever its lease went
+ */
+void TileCoordinator::storeTile(const TileProtocol::TileResult& tile)
+{
+    if (!jobActive || tile.jobId != jobId) {
+        return;
+    }
+
+    const int column = (tile.area.minX - imageMinX) / TILE_SIZE_IN_PIXELS;
+    const int line = (tile.area.minY - imageMinY) / TILE_SIZE_IN_PIXELS;
+    const int index = line * tileColumns + column;
+    if (tile.area.minX < imageMinX || tile.area.minY < imageMinY || column >= tileColumns ||
+        index >= static_cast<int>(tiles.size()))
+    {
+        return;
+    }
+
+    Tile& found = tiles[static_cast<std::size_t>(index)];
+    if (found.done || found.area.minX != tile.area.minX || found.area.maxX != tile.area.maxX ||
+        found.area.minY != tile.area.minY || found.area.maxY != tile.area.maxY)
+    {
+        return;
+    }
+
+    const int width = tile.area.maxX - tile.area.minX;
+    const auto lineSize = static_cast<std::size_t>(width) * sizeof(uint);
+    for (int y = tile.area.minY; y < tile.area.maxY; ++y) {
+        uchar* line = image.scanLine(y - imageMinY) + static_cast<std::size_t>(tile.area.minX - imageMinX) * sizeof(uint);
+        std::memcpy(line, tile.pixels.constData() + static_cast<std::size_t>(y - tile.area.minY) * lineSize, lineSize);
+    }
+    found.done = true;
+
+    if (++tilesDone == static_cast<int>(tiles.size())) {
+        const QImage completedImage = image;
+        endJob();
+        emit jobDone(completedImage);
+    }
+}
+
+/*
+ * The tile of the lease is handed out again first
+ */
+void TileCoordinator::revokeLease(std::map<quint32, Lease>::iterator lease)
+{
+    if (!tiles[lease->second.tile].done) {
+        pendingTiles.push_front(lease->second.tile);
+        ++reissuedLeaseCount;
+    }
+    leases.erase(lease);
+}
+
+void TileCoordinator::expireLeases()
+{
+    const qint64 now = clock.elapsed();
+    bool expired = false;
+    for (auto i = leases.begin(); i != leases.end(); ) {
+        auto next = std::next(i);
+        if (i->second.expiresAt >= 0 && i->second.expiresAt <= now) {
+            revokeLease(i);
+            expired = true;
+        }
+        i = next;
+    }
+
+    if (expired) {
+        grantLeasesToAll();
+    }
+
+    //workers of other machines may still join
+    if (!workers.empty()) {
+        noWorkerSince = -1;
+    } else if (noWorkerSince < 0) {
+        noWorkerSince = now;
+    } else if (now - noWorkerSince >= NO_WORKER_TIMEOUT_IN_MS) {
+        endJob();
+        emit jobFailed(tr("No tile worker connected within %1 s").arg(NO_WORKER_TIMEOUT_IN_MS / 1000));
+    }
+}
+
+void TileCoordinator::workerDisconnected()
+{
+    auto connection = qobject_cast<QTcpSocket*>(sender());
+    connections.erase(std::remove(connections.begin(), connections.end(), connection), connections.end());
+    const auto worker = std::find(workers.begin(), workers.end(), connection);
+    const bool wasWorker = (worker != workers.end());
+    if (wasWorker) {
+        workers.erase(worker);
+    }
+    connection->deleteLater();
+
+    bool revoked = false;
+    for (auto i = leases.begin(); i != leases.end(); ) {
+        auto next = std::next(i);
+        if (i->second.worker == connection) {
+            revokeLease(i);
+            revoked = true;
+        }
+        i = next;
+    }
+
+    if (revoked) {
+        grantLeasesToAll();
+    }
+    if (wasWorker) {
+        emit workersChanged(getNumWorkers());
+    }
+    failJobWithoutWorkers();
+}
+
+void TileCoordinator::localWorkerFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    Q_UNUSED(exitCode);
+    Q_UNUSED(exitStatus);
+    localWorkerStopped(qobject_cast<QProcess*>(sender()));
+}
+
+void TileCoordinator::localWorkerError(QProcess::ProcessError error)
+{
+    if (error == QProcess::FailedToStart) {
+        localWorkerStopped(qobject_cast<QProcess*>(sender()));
+    }
+}
+
+/*
+ * The leases of the worker are revoked once its connection is closed
+ */
+void TileCoordinator::localWorkerStopped(QProcess* worker)
+{
+    const auto found = std::find(localWorkers.begin(), localWorkers.end(), worker);
+    if (found == localWorkers.end()) {
+        return;
+    }
+    localWorkers.erase(found);
+    worker->deleteLater();
+    failJobWithoutWorkers();
+}
+
+/*
+ * Without local workers, a job waits for the workers of other machines
+ * until NO_WORKER_TIMEOUT_IN_MS passed (see expireLeases())
+ */
+void TileCoordinator::failJobWithoutWorkers()
+{
+    if (jobActive && localWorkersStarted && localWorkers.empty() && workers.empty()) {
+        endJob();
+        emit jobFailed(tr("The tile workers stopped before completing the image"));
+    }
+}
+
+void TileCoordinator::endJob()
+{
+    jobActive = false;
+    leaseTimer.stop();
+    leases.clear();
+    pendingTiles.clear();
+    tiles.clear();
+    image = QImage();
+}
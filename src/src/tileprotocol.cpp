@@ -0,0 +1,206 @@
+#include "tileprotocol.h"
+
+#include <QDataStream>
+#include <QtEndian>
+
+namespace TileProtocol
+{
+
+static constexpr int FRAME_HEADER_SIZE = sizeof(quint32);
+
+static QDataStream& operator <<(QDataStream& outputStream, const MandelBrotRenderer::RenderTask& area)
+{
+    outputStream << static_cast<qint32>(area.minX) << static_cast<qint32>(area.maxX)
+                 << static_cast<qint32>(area.minY) << static_cast<qint32>(area.maxY);
+    return outputStream;
+}
+
+static QDataStream& operator >>(QDataStream& inputStream, MandelBrotRenderer::RenderTask& area)
+{
+    qint32 minX = 0;
+    qint32 maxX = 0;
+    qint32 minY = 0;
+    qint32 maxY = 0;
+    inputStream >> minX >> maxX >> minY >> maxY;
+    area = MandelBrotRenderer::RenderTask { minX, maxX, minY, maxY, 0 };
+    return inputStream;
+}
+
+static bool isValidTile(const MandelBrotRenderer::RenderTask& area)
+{
+    return (area.maxX > area.minX && area.maxY > area.minY &&
+            area.maxX - area.minX <= MAX_TILE_SIZE_IN_PIXELS && area.maxY - area.minY <= MAX_TILE_SIZE_IN_PIXELS);
+}
+
+void sendMessage(QIODevice& device, messageType type, const QByteArray& payload)
+{
+    QByteArray frame;
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out << static_cast<quint32>(payload.size() + 1) << static_cast<quint8>(type);
+    frame.append(payload);
+    device.write(frame);
+}
+
+/*
+ * Take the next complete message from the device, false when none is complete yet
+ * (or the stream is invalid, the connection should then be dropped)
+ */
+bool receiveMessage(QIODevice& device, messageType& type, QByteArray& payload, bool& invalid)
+{
+    invalid = false;
+    if (device.bytesAvailable() < FRAME_HEADER_SIZE + 1) {
+        return false;
+    }
+
+    const QByteArray header = device.peek(FRAME_HEADER_SIZE);
+    const quint32 size = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(header.constData()));
+    if (size == 0 || size > MAX_MESSAGE_SIZE) {
+        invalid = true;
+        return false;
+    }
+    if (device.bytesAvailable() < FRAME_HEADER_SIZE + static_cast<qint64>(size)) {
+        return false;
+    }
+
+    device.read(FRAME_HEADER_SIZE);
+    const QByteArray message = device.read(size);
+    type = static_cast<messageType>(static_cast<quint8>(message.at(0)));
+    payload = message.mid(1);
+    return true;
+}
+
+QByteArray encodeHello()
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << PROTOCOL_VERSION;
+    return payload;
+}
+
+bool decodeHello(const QByteArray& payload)
+{
+    QDataStream in(payload);
+    quint32 version = 0;
+    in >> version;
+    return (in.status() == QDataStream::Ok && version == PROTOCOL_VERSION);
+}
+
+QByteArray encodeJob(quint32 jobId, const RenderJobRequest& request)
+{
+    const RegionAttributes& attributes = request.attributes;
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << jobId
+        << attributes.getScaleFactor() << attributes.getOriginX() << attributes.getOriginY()
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+        << attributes.getPreciseOriginX() << attributes.getPreciseOriginY()
+#endif
+        << static_cast<qint32>(attributes.getMinX()) << static_cast<qint32>(attributes.getMaxX())
+        << static_cast<qint32>(attributes.getMinY()) << static_cast<qint32>(attributes.getMaxY())
+        << static_cast<qint32>(attributes.getFullHeight())
+        << static_cast<qint32>(MandelBrotRenderer::toUnderlyingType(request.numericType))
+        << static_cast<qint32>(request.numPasses)
+        << static_cast<quint32>(request.colormap.size());
+    for (const auto& i : request.colormap) {
+        out << static_cast<quint32>(i);
+    }
+    return payload;
+}
+
+bool decodeJob(const QByteArray& payload, quint32& jobId, RenderJobRequest& request)
+{
+    QDataStream in(payload);
+    double scaleFactor = 0.0;
+    double originX = 0.0;
+    double originY = 0.0;
+    QString preciseOriginX;
+    QString preciseOriginY;
+    qint32 minX = 0;
+    qint32 maxX = 0;
+    qint32 minY = 0;
+    qint32 maxY = 0;
+    qint32 fullHeight = 0;
+    qint32 numericType = 0;
+    qint32 numPasses = 0;
+    quint32 colorMapSize = 0;
+
+    in >> jobId >> scaleFactor >> originX >> originY
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+       >> preciseOriginX >> preciseOriginY
+#endif
+       >> minX >> maxX >> minY >> maxY >> fullHeight >> numericType >> numPasses >> colorMapSize;
+
+    //each colour takes 4 bytes of the payload
+    if (in.status() != QDataStream::Ok || colorMapSize == 0 || colorMapSize > static_cast<quint32>(payload.size() / 4)) {
+        return false;
+    }
+
+    MandelBrotRenderer::colorMapStore colormap(colorMapSize);
+    for (auto& i : colormap) {
+        quint32 colour = 0;
+        in >> colour;
+        i = colour;
+    }
+    if (in.status() != QDataStream::Ok || maxX <= minX || maxY <= minY) {
+        return false;
+    }
+
+    //the pass sets the iteration count (a shift), an unknown type would be rendered as a double
+    const bool typeIsKnown = numericType >= MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::internalDataType::singlePrecisionFloat) &&
+                             numericType <= MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::internalDataType::int128) &&
+                             MandelBrotRenderer::typeIsCompiledIn(static_cast<MandelBrotRenderer::internalDataType>(numericType));
+    if (numPasses < 1 || numPasses > MandelBrotRenderer::MAX_PASSES || !typeIsKnown) {
+        return false;
+    }
+
+    //the origins are transmitted as doubles, which convert back to the same values
+    MandelBrotRenderer::CoordValue originXValue = QString::number(originX, 'g', 17);
+    MandelBrotRenderer::CoordValue originYValue = QString::number(originY, 'g', 17);
+    request = RenderJobRequest { RegionAttributes(scaleFactor, originXValue, originYValue,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                                  preciseOriginX, preciseOriginY,
+#endif
+                                                  minX, maxX, minY, maxY, fullHeight),
+                                 static_cast<MandelBrotRenderer::internalDataType>(numericType),
+                                 numPasses,
+                                 colormap,
+                                 1 };
+    return true;
+}
+
+QByteArray encodeLease(const Lease& lease)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << lease.jobId << lease.leaseId << lease.area;
+    return payload;
+}
+
+bool decodeLease(const QByteArray& payload, Lease& lease)
+{
+    QDataStream in(payload);
+    in >> lease.jobId >> lease.leaseId >> lease.area;
+    return (in.status() == QDataStream::Ok && isValidTile(lease.area));
+}
+
+QByteArray encodeTile(const TileResult& tile)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << tile.jobId << tile.leaseId << tile.area << tile.pixels;
+    return payload;
+}
+
+bool decodeTile(const QByteArray& payload, TileResult& tile)
+{
+    QDataStream in(payload);
+    in >> tile.jobId >> tile.leaseId >> tile.area >> tile.pixels;
+    if (in.status() != QDataStream::Ok || !isValidTile(tile.area)) {
+        return false;
+    }
+
+    const int pixelCount = (tile.area.maxX - tile.area.minX) * (tile.area.maxY - tile.area.minY);
+    return (tile.pixels.size() == pixelCount * static_cast<int>(sizeof(uint)));
+}
+
+}
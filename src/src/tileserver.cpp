@@ -0,0 +1,420 @@
+#include "tileserver.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QUrlQuery>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "PrecisionHandler.h"
+#include "regionattributes.h"
+#include "renderjobpool.h"
+
+const char TileServer::SERVER_ARGUMENT[] = "--tile-server";
+
+QString TileServer::TileRequest::toKey() const
+{
+    return QString::number(MandelBrotRenderer::toUnderlyingType(numericType)) + "/" + QString::number(numPasses) + "/" +
+           QString::number(zoom) + "/" + QString::number(x) + "/" + QString::number(y);
+}
+
+TileServer::TileServer(RenderJobPool& jobPool, QObject *parent)
+    : QObject{ parent },
+      jobPool(jobPool),
+      colormap(MandelBrotRenderer::createColormap(MandelBrotRenderer::DefaultColormapSize)),
+      cacheSize(DEFAULT_CACHE_SIZE_IN_BYTES),
+      cachedBytes(0)
+{
+    connect(&server, SIGNAL(newConnection()), this, SLOT(acceptConnections()));
+    //the pool signals from its worker threads, the results are queued to this thread
+    connect(&jobPool, SIGNAL(jobDone(int,QImage)), this, SLOT(tileRendered(int,QImage)));
+    connect(&jobPool, SIGNAL(jobCancelled(int)), this, SLOT(tileCancelled(int)));
+}
+
+TileServer::~TileServer()
+{
+    for (const auto& i : pendingTiles) {
+        jobPool.cancel(i.first);
+    }
+}
+
+/*
+ * Only local clients are served
+ */
+bool TileServer::listen(quint16 port)
+{
+    return server.listen(QHostAddress::LocalHost, port);
+}
+
+void TileServer::setCacheSize(std::size_t bytes)
+{
+    cacheSize = bytes;
+    evictTiles();
+}
+
+bool TileServer::isServerInvocation(int argc, char *argv[])
+{
+    return (argc > 1 && std::strcmp(argv[1], SERVER_ARGUMENT) == 0);
+}
+
+/*
+ * Entry point of the server mode: arguments are SERVER_ARGUMENT and optionally the port
+ */
+int TileServer::runServer(const QStringList& arguments)
+{
+    constexpr int EXIT_BAD_ARGUMENTS = 2;
+    constexpr int EXIT_NO_PORT = 3;
+
+    bool portIsValid = true;
+    const quint16 port = (arguments.size() > 2) ? arguments.at(2).toUShort(&portIsValid) : DEFAULT_PORT;
+    if (!portIsValid) {
+        return EXIT_BAD_ARGUMENTS;
+    }
+
+    RenderJobPool jobPool(MandelBrotRenderer::calculateInitialNumThreads());
+    TileServer tileServer(jobPool);
+    if (!tileServer.listen(port)) {
+        return EXIT_NO_PORT;
+    }
+    return QCoreApplication::exec();
+}
+
+void TileServer::acceptConnections()
+{
+    while (server.hasPendingConnections()) {
+        QTcpSocket* client = server.nextPendingConnection();
+        connect(client, SIGNAL(readyRead()), this, SLOT(readRequest()));
+        connect(client, SIGNAL(disconnected()), this, SLOT(connectionClosed()));
+        requestBuffers.emplace(client, QByteArray());
+    }
+}
+
+/*
+ * Wait for the complete header of the request, only its first line is used
+ */
+void TileServer::readRequest()
+{
+    auto client = qobject_cast<QTcpSocket*>(sender());
+    auto buffer = requestBuffers.find(client);
+    if (buffer == requestBuffers.end()) {
+        //already answered, or being answered
+        client->readAll();
+        return;
+    }
+
+    buffer->second.append(client->readAll());
+    const int headerEnd = buffer->second.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        if (buffer->second.size() > MAX_REQUEST_HEADER_SIZE) {
+            requestBuffers.erase(buffer);
+            respond(client, 431, "Request Header Fields Too Large", "text/plain", "request too large\n");
+        }
+        return;
+    }
+
+    const QByteArray requestLine = buffer->second.left(buffer->second.indexOf("\r\n"));
+    requestBuffers.erase(buffer);
+    processRequest(client, requestLine);
+}
+
+void TileServer::processRequest(QTcpSocket* client, const QByteArray& requestLine)
+{
+    const QList<QByteArray> parts = requestLine.split(' ');
+    if (parts.size() != 3 || !parts.at(2).startsWith("HTTP/1.")) {
+        respond(client, 400, "Bad Request", "text/plain", "bad request\n");
+        return;
+    }
+    if (!(parts.at(0) == "GET")) {
+        respond(client, 405, "Method Not Allowed", "text/plain", "only GET is supported\n");
+        return;
+    }
+
+    const QString target = QString::fromUtf8(parts.at(1));
+    const int queryStart = target.indexOf("?");
+    const QString path = (queryStart < 0) ? target : target.left(queryStart);
+    const QString query = (queryStart < 0) ? QString() : target.mid(queryStart + 1);
+
+    TileRequest request;
+    if (path == "/" || path == "/index.html") {
+        respond(client, 200, "OK", "text/html; charset=utf-8", viewerPage());
+    } else if (parseTileRequest(path, query, request)) {
+        requestTile(client, request);
+    } else {
+        respond(client, 404, "Not Found", "text/plain", "not found\n");
+    }
+}
+
+bool TileServer::parseTileRequest(const QString& path, const QString& query, TileRequest& request) const
+{
+    //"", "tiles", z, x, "y.png"
+    const QStringList parts = path.split("/");
+    if (parts.size() != 5 || !parts.at(0).isEmpty() || parts.at(1) != "tiles" || !parts.at(4).endsWith(".png")) {
+        return false;
+    }
+
+    bool zoomIsValid = false;
+    bool xIsValid = false;
+    bool yIsValid = false;
+    request.zoom = parts.at(2).toInt(&zoomIsValid);
+    request.x = parts.at(3).toLongLong(&xIsValid);
+    request.y = parts.at(4).left(parts.at(4).size() - 4).toLongLong(&yIsValid);
+    if (!zoomIsValid || !xIsValid || !yIsValid || request.zoom < 0 || request.zoom > MAX_ZOOM) {
+        return false;
+    }
+
+    const qint64 tilesPerSide = static_cast<qint64>(1) << request.zoom;
+    if (request.x < 0 || request.x >= tilesPerSide || request.y < 0 || request.y >= tilesPerSide) {
+        return false;
+    }
+
+    const QUrlQuery parameters(query);
+    bool typeIsValid = true;
+    bool passesAreValid = true;
+    const int numericType = parameters.hasQueryItem("type") ?
+                parameters.queryItemValue("type").toInt(&typeIsValid) :
+                MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::defaultRendererType);
+    request.numPasses = parameters.hasQueryItem("passes") ?
+                parameters.queryItemValue("passes").toInt(&passesAreValid) :
+                MandelBrotRenderer::defaultNumPassesValue;
+    if (!typeIsValid || !passesAreValid ||
+        numericType < MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::internalDataType::singlePrecisionFloat) ||
+        numericType > MandelBrotRenderer::toUnderlyingType(MandelBrotRenderer::internalDataType::int128) ||
+        !MandelBrotRenderer::typeIsCompiledIn(static_cast<MandelBrotRenderer::internalDataType>(numericType)) ||
+        request.numPasses < 1 || request.numPasses > MandelBrotRenderer::MAX_PASSES)
+    {
+        return false;
+    }
+    request.numericType = static_cast<MandelBrotRenderer::internalDataType>(numericType);
+    return true;
+}
+
+/*
+ * Answer from the cache, or join (or start) the job rendering the tile
+ */
+void TileServer::requestTile(QTcpSocket* client, const TileRequest& request)
+{
+    const QString key = request.toKey();
+
+    auto cached = cacheIndex.find(key);
+    if (cached != cacheIndex.end()) {
+        cachedTiles.splice(cachedTiles.begin(), cachedTiles, cached->second);
+        respond(client, 200, "OK", "image/png", cached->second->second);
+        return;
+    }
+
+    auto pending = pendingJobs.find(key);
+    if (pending != pendingJobs.end()) {
+        pendingTiles[pending->second].clients.push_back(client);
+        clientJobs.emplace(client, pending->second);
+        return;
+    }
+
+    //the centre of the tile, in the precision of the widest type when available
+    const double tileSpan = PLANE_SIZE / std::ldexp(1.0, request.zoom);
+    const double scaleFactor = tileSpan / TILE_SIZE_IN_PIXELS;
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+    using MandelBrotRenderer::Float128;
+    const Float128 centreX = static_cast<Float128>(PLANE_MIN_X) +
+                             (static_cast<Float128>(request.x) + static_cast<Float128>(0.5)) * static_cast<Float128>(tileSpan);
+    const Float128 centreY = static_cast<Float128>(PLANE_MIN_Y) +
+                             (static_cast<Float128>(request.y) + static_cast<Float128>(0.5)) * static_cast<Float128>(tileSpan);
+    MandelBrotRenderer::CoordValue originX = MandelBrotRenderer::generateDoubleAsString(static_cast<double>(centreX));
+    MandelBrotRenderer::CoordValue originY = MandelBrotRenderer::generateDoubleAsString(static_cast<double>(centreY));
+#else
+    MandelBrotRenderer::CoordValue originX = MandelBrotRenderer::generateDoubleAsString(PLANE_MIN_X + (request.x + 0.5) * tileSpan);
+    MandelBrotRenderer::CoordValue originY = MandelBrotRenderer::generateDoubleAsString(PLANE_MIN_Y + (request.y + 0.5) * tileSpan);
+#endif
+
+    constexpr int halfTileSize = TILE_SIZE_IN_PIXELS / 2;
+    const RenderJobRequest job { RegionAttributes(scaleFactor, originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                                                  MandelBrotRenderer::generatePreciseFloatingPointString(centreX),
+                                                  MandelBrotRenderer::generatePreciseFloatingPointString(centreY),
+#endif
+                                                  -halfTileSize, halfTileSize, -halfTileSize, halfTileSize, TILE_SIZE_IN_PIXELS),
+                                 request.numericType,
+                                 request.numPasses,
+                                 colormap,
+                                 1 };
+
+    const int jobId = jobPool.submit(job);
+    pendingTiles.emplace(jobId, PendingTile { key, std::vector<QTcpSocket*> { client } });
+    pendingJobs.emplace(key, jobId);
+    clientJobs.emplace(client, jobId);
+}
+
+void TileServer::tileRendered(int jobId, const QImage& image)
+{
+    auto pending = pendingTiles.find(jobId);
+    if (pending == pendingTiles.end()) {
+        //a job of another user of the pool, or cancelled meanwhile
+        return;
+    }
+
+    QByteArray tile;
+    QBuffer buffer(&tile);
+    buffer.open(QIODevice::WriteOnly);
+    image.save(&buffer, "PNG");
+    storeInCache(pending->second.key, tile);
+
+    const PendingTile finished = pending->second;
+    pendingTiles.erase(pending);
+    pendingJobs.erase(finished.key);
+    for (auto i : finished.clients) {
+        clientJobs.erase(i);
+        respond(i, 200, "OK", "image/png", tile);
+    }
+}
+
+void TileServer::tileCancelled(int jobId)
+{
+    auto pending = pendingTiles.find(jobId);
+    if (pending == pendingTiles.end()) {
+        return;
+    }
+
+    const PendingTile cancelled = pending->second;
+    pendingTiles.erase(pending);
+    pendingJobs.erase(cancelled.key);
+    for (auto i : cancelled.clients) {
+        clientJobs.erase(i);
+        respond(i, 503, "Service Unavailable", "text/plain", "tile cancelled\n");
+    }
+}
+
+/*
+ * A tile nobody waits for any more is not rendered further
+ */
+void TileServer::connectionClosed()
+{
+    auto client = qobject_cast<QTcpSocket*>(sender());
+    requestBuffers.erase(client);
+    client->deleteLater();
+
+    auto clientJob = clientJobs.find(client);
+    if (clientJob == clientJobs.end()) {
+        return;
+    }
+    const int jobId = clientJob->second;
+    clientJobs.erase(clientJob);
+
+    auto pending = pendingTiles.find(jobId);
+    if (pending == pendingTiles.end()) {
+        return;
+    }
+    std::vector<QTcpSocket*>& clients = pending->second.clients;
+    clients.erase(std::remove(clients.begin(), clients.end(), client), clients.end());
+    if (clients.empty()) {
+        //forgotten first, the pool signals the cancellation right away
+        pendingJobs.erase(pending->second.key);
+        pendingTiles.erase(pending);
+        jobPool.cancel(jobId);
+    }
+}
+
+void TileServer::respond(QTcpSocket* client, int status, const QByteArray& reason,
+                         const QByteArray& contentType, const QByteArray& body)
+{
+    QByteArray response("HTTP/1.1 ");
+    response.append(QByteArray::number(status)).append(" ").append(reason).append("\r\n");
+    response.append("Content-Type: ").append(contentType).append("\r\n");
+    response.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+    if (status == 200) {
+        //a tile never changes
+        response.append("Cache-Control: public, max-age=86400\r\n");
+    }
+    response.append("Connection: close\r\n\r\n");
+    response.append(body);
+
+    client->write(response);
+    client->disconnectFromHost();
+}
+
+void TileServer::storeInCache(const QString& key, const QByteArray& tile)
+{
+    if (cacheIndex.find(key) != cacheIndex.end()) {
+        return;
+    }
+
+    cachedTiles.emplace_front(key, tile);
+    cacheIndex.emplace(key, cachedTiles.begin());
+    cachedBytes += static_cast<std::size_t>(tile.size());
+    evictTiles();
+}
+
+void TileServer::evictTiles()
+{
+    while (cachedBytes > cacheSize && !cachedTiles.empty()) {
+        cachedBytes -= static_cast<std::size_t>(cachedTiles.back().second.size());
+        cacheIndex.erase(cachedTiles.back().first);
+        cachedTiles.pop_back();
+    }
+}
+
+/*
+ * Viewer of the tiles, self contained (no external scripts): drag to pan, wheel to zoom;
+ * the query of the page (type, passes) is passed on to the tile requests. Tiles leaving
+ * the view are dropped, which closes their connections and cancels them when pending
+ */
+QByteArray TileServer::viewerPage()
+{
+    return QByteArray(
+        "<!DOCTYPE html>\n"
+        "<html><head><meta charset=\"utf-8\"><title>Mandelbrot</title>\n"
+        "<style>html, body { height: 100%; margin: 0; background: #000; }\n"
+        "#view { position: absolute; left: 0; top: 0; right: 0; bottom: 0; overflow: hidden; cursor: move; }\n"
+        "#view img { position: absolute; user-select: none; }</style>\n"
+        "</head><body><div id=\"view\"></div><script>\n"
+        "var TILE = ")
+        .append(QByteArray::number(TILE_SIZE_IN_PIXELS))
+        .append(", MAX_ZOOM = ")
+        .append(QByteArray::number(MAX_ZOOM))
+        .append(";\n"
+                "var view = document.getElementById('view'), tiles = {}, zoom = 1, centreX = 0.5, centreY = 0.5, drag = null;\n"
+                "function span() { return Math.pow(2, zoom) * TILE; }\n"
+                "function draw() {\n"
+                "  var n = Math.pow(2, zoom), left = centreX * span() - view.clientWidth / 2, top = centreY * span() - view.clientHeight / 2;\n"
+                "  var minX = Math.max(0, Math.floor(left / TILE)), maxX = Math.min(n - 1, Math.floor((left + view.clientWidth) / TILE));\n"
+                "  var minY = Math.max(0, Math.floor(top / TILE)), maxY = Math.min(n - 1, Math.floor((top + view.clientHeight) / TILE));\n"
+                "  var shown = {};\n"
+                "  for (var y = minY; y <= maxY; y++) {\n"
+                "    for (var x = minX; x <= maxX; x++) {\n"
+                "      var src = '/tiles/' + zoom + '/' + x + '/' + y + '.png' + location.search;\n"
+                "      var tile = tiles[src];\n"
+                "      if (!tile) { tile = tiles[src] = document.createElement('img'); tile.draggable = false; tile.src = src; view.appendChild(tile); }\n"
+                "      tile.style.left = Math.round(x * TILE - left) + 'px';\n"
+                "      tile.style.top = Math.round(y * TILE - top) + 'px';\n"
+                "      shown[src] = true;\n"
+                "    }\n"
+                "  }\n"
+                "  for (var i in tiles) { if (!shown[i]) { view.removeChild(tiles[i]); delete tiles[i]; } }\n"
+                "}\n"
+                "function clamp(value) { return Math.min(1, Math.max(0, value)); }\n"
+                "view.onmousedown = function (e) { drag = { x: e.clientX, y: e.clientY }; };\n"
+                "window.onmouseup = function () { drag = null; };\n"
+                "window.onmousemove = function (e) {\n"
+                "  if (!drag) { return; }\n"
+                "  centreX = clamp(centreX - (e.clientX - drag.x) / span());\n"
+                "  centreY = clamp(centreY - (e.clientY - drag.y) / span());\n"
+                "  drag = { x: e.clientX, y: e.clientY };\n"
+                "  draw();\n"
+                "};\n"
+                "view.onwheel = function (e) {\n"
+                "  e.preventDefault();\n"
+                "  var newZoom = Math.min(MAX_ZOOM, Math.max(0, zoom + (e.deltaY < 0 ? 1 : -1)));\n"
+                "  var dx = e.clientX - view.clientWidth / 2, dy = e.clientY - view.clientHeight / 2;\n"
+                "  var pointX = centreX + dx / span(), pointY = centreY + dy / span();\n"
+                "  zoom = newZoom;\n"
+                "  centreX = clamp(pointX - dx / span());\n"
+                "  centreY = clamp(pointY - dy / span());\n"
+                "  draw();\n"
+                "};\n"
+                "window.onresize = draw;\n"
+                "draw();\n"
+                "</script></body></html>\n");
+}
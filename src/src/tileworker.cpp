@@ -0,0 +1,150 @@
+#include "tileworker.h"
+
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <cstring>
+
+#include "cancellationtoken.h"
+#include "computeddatasegment.h"
+#include "jobtaskowner.h"
+#include "ComputeTaskGenerator.h"
+
+const char TileWorker::WORKER_ARGUMENT[] = "--tile-worker";
+
+TileWorker::TileWorker(QObject *parent)
+    : QObject{ parent },
+      jobId(0),
+      job { RegionAttributes(), MandelBrotRenderer::defaultRendererType, 0, {}, 1 },
+      tileScheduled(false)
+{
+    connect(&socket, SIGNAL(connected()), this, SLOT(sayHello()));
+    connect(&socket, SIGNAL(readyRead()), this, SLOT(readFromCoordinator()));
+    connect(&socket, SIGNAL(disconnected()), QCoreApplication::instance(), SLOT(quit()));
+    connect(&socket, SIGNAL(error(QAbstractSocket::SocketError)), QCoreApplication::instance(), SLOT(quit()));
+}
+
+TileWorker::~TileWorker() = default;
+
+bool TileWorker::isWorkerInvocation(int argc, char *argv[])
+{
+    return (argc > 1 && std::strcmp(argv[1], WORKER_ARGUMENT) == 0);
+}
+
+/*
+ * Entry point of a worker process: arguments are WORKER_ARGUMENT,
+ * the address and the port of the coordinator
+ */
+int TileWorker::runWorker(const QStringList& arguments)
+{
+    constexpr int EXIT_BAD_ARGUMENTS = 2;
+
+    bool portIsValid = false;
+    const quint16 port = (arguments.size() > 3) ? arguments.at(3).toUShort(&portIsValid) : 0;
+    if (!portIsValid) {
+        return EXIT_BAD_ARGUMENTS;
+    }
+
+    TileWorker worker;
+    worker.connectToCoordinator(arguments.at(2), port);
+    return QCoreApplication::exec();
+}
+
+void TileWorker::connectToCoordinator(const QString& host, quint16 port)
+{
+    socket.connectToHost(host, port);
+}
+
+void TileWorker::sayHello()
+{
+    TileProtocol::sendMessage(socket, TileProtocol::messageType::hello, TileProtocol::encodeHello());
+}
+
+void TileWorker::readFromCoordinator()
+{
+    TileProtocol::messageType type;
+    QByteArray payload;
+    bool invalid = false;
+    while (TileProtocol::receiveMessage(socket, type, payload, invalid)) {
+        processMessage(type, payload);
+    }
+    if (invalid) {
+        socket.abort();
+    }
+}
+
+void TileWorker::processMessage(TileProtocol::messageType type, const QByteArray& payload)
+{
+    if (type == TileProtocol::messageType::job) {
+        quint32 newJobId = 0;
+        RenderJobRequest newJob = job;
+        if (!TileProtocol::decodeJob(payload, newJobId, newJob)) {
+            socket.abort();
+            return;
+        }
+
+        //the leases of the previous job are worthless now
+        leases.clear();
+        jobId = newJobId;
+        job = newJob;
+        taskOwner.reset(new JobTaskOwner(job.numPasses, job.colormap));
+        computeTask = generateComputeTaskForType(*taskOwner, job.numericType);
+    } else if (type == TileProtocol::messageType::lease) {
+        TileProtocol::Lease lease;
+        if (!TileProtocol::decodeLease(payload, lease)) {
+            socket.abort();
+            return;
+        }
+        if (lease.jobId == jobId && taskOwner != nullptr) {
+            leases.push_back(lease);
+            scheduleNextTile();
+        }
+    } else {
+        socket.abort();
+    }
+}
+
+/*
+ * Tiles are computed from the event loop, so messages are read in between
+ */
+void TileWorker::scheduleNextTile()
+{
+    if (!tileScheduled && !leases.empty()) {
+        tileScheduled = true;
+        QTimer::singleShot(0, this, SLOT(computeNextTile()));
+    }
+}
+
+void TileWorker::computeNextTile()
+{
+    tileScheduled = false;
+    if (leases.empty()) {
+        return;
+    }
+
+    const TileProtocol::Lease lease = leases.front();
+    leases.pop_front();
+
+    //the tasks of a segment must belong to the job of its parameters
+    MandelBrotRenderer::RenderTask area = lease.area;
+    area.jobId = static_cast<int>(lease.jobId);
+    const int width = area.maxX - area.minX;
+    const int height = area.maxY - area.minY;
+    TileProtocol::TileResult tile { lease.jobId, lease.leaseId, area,
+                                    QByteArray(width * height * static_cast<int>(sizeof(uint)), '\0') };
+
+    const SharedTaskParameters parameters { static_cast<int>(lease.jobId), job.attributes, nullptr,
+                                            MandelBrotRenderer::FrameBuffer { reinterpret_cast<uchar *>(tile.pixels.data()),
+                                                                              width * static_cast<int>(sizeof(uint)),
+                                                                              -area.minX, -area.minY },
+                                            MandelBrotRenderer::noReusedSamples, MandelBrotRenderer::noPreviewSamples };
+    ComputedDataSegment segment(parameters, area, 0);
+    MandelBrotRenderer::ComputeTaskResults& resultData = segment.getFullResultData();
+    const CancellationToken cancellation;
+    for (int y = area.minY; y < area.maxY; ++y) {
+        computeTask(segment, cancellation, resultData, y);
+    }
+
+    TileProtocol::sendMessage(socket, TileProtocol::messageType::tile, TileProtocol::encodeTile(tile));
+    scheduleNextTile();
+}
@@ -33,14 +33,23 @@ using MandelBrotRenderer::addHorizontalLine;
 
 ToolsOptionsWidget::ToolsOptionsWidget(RenderThread *masterThread, MandelbrotWidget* mainWidget, SettingsHandler& settingsHandler)
     : sliderTitle(nullptr), threadCountSlider(nullptr), numPassesTitle(nullptr), threadAlgorithmTitle(nullptr),
-      colorMapTitle(nullptr), numericTypeTitle(nullptr), showInfoButton(nullptr), okOrCancelBox(nullptr),
+      colorMapTitle(nullptr), numericTypeTitle(nullptr), showInfoButton(nullptr), focusedRenderingButton(nullptr),
+      speculativeRenderingButton(nullptr), snappedZoomButton(nullptr), frameBudgetButton(nullptr),
+      backgroundModeButton(nullptr), backgroundCpuShareSetting(nullptr),
+      okOrCancelBox(nullptr),
       masterThread(masterThread), mainWidget(mainWidget),
       applicationSettingsHandler(settingsHandler),
       numPassValue(masterThread != nullptr ? masterThread->getRunningNumPasses() : MandelBrotRenderer::defaultNumPassesValue),
-      numWorkerThreads(masterThread != nullptr ? masterThread->getNumWorkerThreads() : RenderThread::calculateInitialNumThreads()),
+      numWorkerThreads(masterThread != nullptr ? masterThread->getNumWorkerThreads() : MandelBrotRenderer::calculateInitialNumThreads()),
       threadMediatorEnabled(false),
       colorMapSize(MandelBrotRenderer::DefaultColormapSize),
-      displayDetailedInfo(true)
+      displayDetailedInfo(true),
+      focusedRenderingEnabled(false),
+      speculativeRenderingEnabled(false),
+      snappedZoomEnabled(false),
+      frameBudgetEnabled(false),
+      backgroundModeEnabled(false),
+      backgroundCpuShare(CpuThrottle::DEFAULT_CPU_SHARE_PERCENT)
 {
     processSettingUpdate(settingsHandler.getSettings());
     setWindowTitle("Options");
@@ -67,6 +76,20 @@ ToolsOptionsWidget::ToolsOptionsWidget(RenderThread *masterThread, MandelbrotWid
 
     addHorizontalLine(this, toolsOptionsLayout);
 
+    addFocusedRenderingButton();
+
+    addSpeculativeRenderingButton();
+
+    addSnappedZoomButton();
+
+    addFrameBudgetButton();
+
+    addHorizontalLine(this, toolsOptionsLayout);
+
+    addBackgroundModeControls();
+
+    addHorizontalLine(this, toolsOptionsLayout);
+
     colorMapSizeSetting = new QSpinBox;
 
     addColorMapSizeField();
@@ -99,6 +122,18 @@ void ToolsOptionsWidget::processSettingUpdate(QSettings& settings)
 
     colorMapSize = settings.value("colourMapSize", MandelBrotRenderer::DefaultColormapSize).toInt();
 
+    focusedRenderingEnabled = settings.value("focusedRenderingEnabled", masterThread->focusedRenderingEnabled()).toBool();
+
+    speculativeRenderingEnabled = settings.value("speculativeRenderingEnabled", masterThread->speculativeRenderingEnabled()).toBool();
+
+    snappedZoomEnabled = settings.value("snappedZoomEnabled", masterThread->snappedZoomEnabled()).toBool();
+
+    frameBudgetEnabled = settings.value("frameBudgetEnabled", masterThread->frameBudgetEnabled()).toBool();
+
+    backgroundModeEnabled = settings.value("backgroundModeEnabled", masterThread->backgroundModeEnabled()).toBool();
+
+    backgroundCpuShare = settings.value("backgroundCpuSharePercent", masterThread->getBackgroundCpuShare()).toInt();
+
     settings.endGroup();
 
     settings.beginGroup("InformationDisplay");
@@ -202,6 +237,32 @@ void ToolsOptionsWidget::setDetailedInfoInGUI()
     showInfoButton->setCheckState(displayDetailedInfo ? Qt::Checked : Qt::Unchecked);
 }
 
+void ToolsOptionsWidget::setFocusedRenderingInGUI()
+{
+    focusedRenderingButton->setCheckState(focusedRenderingEnabled ? Qt::Checked : Qt::Unchecked);
+}
+
+void ToolsOptionsWidget::setSpeculativeRenderingInGUI()
+{
+    speculativeRenderingButton->setCheckState(speculativeRenderingEnabled ? Qt::Checked : Qt::Unchecked);
+}
+
+void ToolsOptionsWidget::setSnappedZoomInGUI()
+{
+    snappedZoomButton->setCheckState(snappedZoomEnabled ? Qt::Checked : Qt::Unchecked);
+}
+
+void ToolsOptionsWidget::setFrameBudgetInGUI()
+{
+    frameBudgetButton->setCheckState(frameBudgetEnabled ? Qt::Checked : Qt::Unchecked);
+}
+
+void ToolsOptionsWidget::setBackgroundModeInGUI()
+{
+    backgroundModeButton->setCheckState(backgroundModeEnabled ? Qt::Checked : Qt::Unchecked);
+    backgroundCpuShareSetting->setValue(backgroundCpuShare);
+}
+
 void ToolsOptionsWidget::setNumericTypeInGUI()
 {
     const MandelBrotRenderer::RendererData&  renderSettings = masterThread->getRendererData();
@@ -216,6 +277,11 @@ void ToolsOptionsWidget::refresh()
     setNumPassesInGUI();
     setColorMapSizeinGUI();
     setDetailedInfoInGUI();
+    setFocusedRenderingInGUI();
+    setSpeculativeRenderingInGUI();
+    setSnappedZoomInGUI();
+    setFrameBudgetInGUI();
+    setBackgroundModeInGUI();
     setNumericTypeInGUI();
 }
 
@@ -251,6 +317,75 @@ QButtonGroup *ToolsOptionsWidget::addthreadAlgorithmArea()
     return group;
 }
 
+void ToolsOptionsWidget::addFocusedRenderingButton()
+{
+    focusedRenderingButton = new QCheckBox("Render around the cursor first");
+    focusedRenderingButton->setToolTip(tr("the image is computed in tiles, starting with those nearest the mouse cursor "
+                                          "(or the view centre)"));
+
+    connect(focusedRenderingButton, SIGNAL(stateChanged(int)), masterThread, SLOT(setFocusedRenderingByState(int)));
+
+    toolsOptionsLayout->addWidget(focusedRenderingButton);
+    setFocusedRenderingInGUI();
+}
+
+void ToolsOptionsWidget::addSpeculativeRenderingButton()
+{
+    speculativeRenderingButton = new QCheckBox("Prepare the likely next views while idle");
+    speculativeRenderingButton->setToolTip(tr("after a render the zoomed and scrolled neighbouring views are computed "
+                                              "in the background, so that these are shown immediately when requested"));
+
+    connect(speculativeRenderingButton, SIGNAL(stateChanged(int)), masterThread, SLOT(setSpeculativeRenderingByState(int)));
+
+    toolsOptionsLayout->addWidget(speculativeRenderingButton);
+    setSpeculativeRenderingInGUI();
+}
+
+void ToolsOptionsWidget::addSnappedZoomButton()
+{
+    snappedZoomButton = new QCheckBox("Zoom by powers of two");
+    snappedZoomButton->setToolTip(tr("zooming is rounded to halving or doubling the scale, which lets the pixels "
+                                     "of the previous view be reused instead of computed again"));
+
+    connect(snappedZoomButton, SIGNAL(stateChanged(int)), masterThread, SLOT(setSnappedZoomByState(int)));
+
+    toolsOptionsLayout->addWidget(snappedZoomButton);
+    setSnappedZoomInGUI();
+}
+
+void ToolsOptionsWidget::addFrameBudgetButton()
+{
+    frameBudgetButton = new QCheckBox("Show a quick preview while exploring");
+    frameBudgetButton->setToolTip(tr("a coarser first image is shown within the frame time budget (measured on recent renders), "
+                                     "the full quality image follows once the view stops changing"));
+
+    connect(frameBudgetButton, SIGNAL(stateChanged(int)), masterThread, SLOT(setFrameBudgetByState(int)));
+
+    toolsOptionsLayout->addWidget(frameBudgetButton);
+    setFrameBudgetInGUI();
+}
+
+void ToolsOptionsWidget::addBackgroundModeControls()
+{
+    constexpr int MIN_CPU_SHARE_PERCENT = 1;
+    constexpr int MAX_CPU_SHARE_PERCENT = 100;
+
+    backgroundModeButton = new QCheckBox("Run in the background");
+    backgroundModeButton->setToolTip(tr("the workers run at the lowest priority and are limited "
+                                        "to the share of the CPU below, leaving the rest to other programs"));
+    backgroundCpuShareSetting = new QSpinBox;
+    backgroundCpuShareSetting->setRange(MIN_CPU_SHARE_PERCENT, MAX_CPU_SHARE_PERCENT);
+    backgroundCpuShareSetting->setSuffix("%");
+
+    connect(backgroundModeButton, SIGNAL(stateChanged(int)), masterThread, SLOT(setBackgroundModeByState(int)));
+    connect(backgroundCpuShareSetting, SIGNAL(valueChanged(int)), masterThread, SLOT(setBackgroundCpuShare(int)));
+
+    toolsOptionsLayout->addWidget(backgroundModeButton);
+    toolsOptionsLayout->addWidget(new QLabel("Share of the CPU in the background:"));
+    toolsOptionsLayout->addWidget(backgroundCpuShareSetting);
+    setBackgroundModeInGUI();
+}
+
 void ToolsOptionsWidget::addThreadSlider()
 {
     toolsOptionsLayout->addWidget(sliderTitle);
@@ -280,7 +415,7 @@ void ToolsOptionsWidget::setNumWorkerThreadsInGUI()
 
 void ToolsOptionsWidget::createThreadSlider()
 {
-    const int maxNumThreads = RenderThread::calculateInitialNumThreads();
+    const int maxNumThreads = MandelBrotRenderer::calculateInitialNumThreads();
     sliderTitle = new QLabel("Threads:");
 
     threadCountSlider = new QSlider(Qt::Horizontal, this);
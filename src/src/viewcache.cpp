@@ -0,0 +1,169 @@
+#include "viewcache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "PrecisionHandler.h"
+
+/*
+ * Offset between the origins of two views in pixels of the given size: for views of the
+ * same scale the pixel (x, y) of the 'to' view shows the point of the pixel
+ * (x + offset.x, y + offset.y) of the 'from' view.
+ * Fails unless the origins are apart by a whole number of pixels
+ */
+static bool findPixelTranslation(const ViewParameters& from, const ViewParameters& to, double pixelScale, QPoint& offset)
+{
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+    using MandelBrotRenderer::Float128;
+    const MandelBrotRenderer::PreciseFloatResult fromX = MandelBrotRenderer::generateFloatFromPreciseString(from.preciseOriginX);
+    const MandelBrotRenderer::PreciseFloatResult fromY = MandelBrotRenderer::generateFloatFromPreciseString(from.preciseOriginY);
+    const MandelBrotRenderer::PreciseFloatResult toX = MandelBrotRenderer::generateFloatFromPreciseString(to.preciseOriginX);
+    const MandelBrotRenderer::PreciseFloatResult toY = MandelBrotRenderer::generateFloatFromPreciseString(to.preciseOriginY);
+    if (!fromX.second || !fromY.second || !toX.second || !toY.second) {
+        return false;
+    }
+    //the differences are small multiples of the scale, a double is precise enough once divided
+    const auto deltaX = static_cast<double>((toX.first - fromX.first) / static_cast<Float128>(pixelScale));
+    const auto deltaY = static_cast<double>((toY.first - fromY.first) / static_cast<Float128>(pixelScale));
+#else
+    const MandelBrotRenderer::DoubleResult fromX = MandelBrotRenderer::generateFloatFromString(from.originX);
+    const MandelBrotRenderer::DoubleResult fromY = MandelBrotRenderer::generateFloatFromString(from.originY);
+    const MandelBrotRenderer::DoubleResult toX = MandelBrotRenderer::generateFloatFromString(to.originX);
+    const MandelBrotRenderer::DoubleResult toY = MandelBrotRenderer::generateFloatFromString(to.originY);
+    if (!fromX.second || !fromY.second || !toX.second || !toY.second) {
+        return false;
+    }
+    const double deltaX = (toX.first - fromX.first) / pixelScale;
+    const double deltaY = (toY.first - fromY.first) / pixelScale;
+#endif
+
+    const double roundedX = std::round(deltaX);
+    const double roundedY = std::round(deltaY);
+    if (std::abs(deltaX - roundedX) > ViewCache::MAX_TRANSLATION_ERROR_IN_PIXELS ||
+        std::abs(deltaY - roundedY) > ViewCache::MAX_TRANSLATION_ERROR_IN_PIXELS ||
+        std::abs(roundedX) >= to.size.width() || std::abs(roundedY) >= to.size.height())
+    {
+        return false;
+    }
+
+    offset = QPoint(static_cast<int>(roundedX), static_cast<int>(roundedY));
+    return true;
+}
+
+bool ViewCacheKey::operator==(const ViewCacheKey& other) const
+{
+    //values are compared exactly, a view is only found again if it was generated in the same way
+    return (view.originX == other.view.originX &&
+            view.originY == other.view.originY &&
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+            view.preciseOriginX == other.view.preciseOriginX &&
+            view.preciseOriginY == other.view.preciseOriginY &&
+#endif
+            view.scaleFactor == other.view.scaleFactor &&
+            view.size == other.view.size &&
+            numPasses == other.numPasses &&
+            numericType == other.numericType &&
+            colorMapSize == other.colorMapSize);
+}
+
+bool ViewCache::find(const ViewCacheKey& key, CachedView& view)
+{
+    auto found = std::find_if(cachedViews.begin(), cachedViews.end(),
+                              [&](const std::pair<ViewCacheKey, CachedView>& i) { return i.first == key; });
+    if (found == cachedViews.end()) {
+        return false;
+    }
+
+    //keep the most recently used views at the front
+    cachedViews.splice(cachedViews.begin(), cachedViews, found);
+    view = cachedViews.front().second;
+    return true;
+}
+
+bool ViewCache::contains(const ViewCacheKey& key) const
+{
+    return std::any_of(cachedViews.begin(), cachedViews.end(),
+                       [&](const std::pair<ViewCacheKey, CachedView>& i) { return i.first == key; });
+}
+
+/*
+ * Find the cached view rendered with the same settings and scale which overlaps
+ * the view of the key the most, when the two are apart by a whole number of pixels
+ */
+bool ViewCache::findTranslatedView(const ViewCacheKey& key, QPoint& offset, CachedView& view)
+{
+    auto best = cachedViews.end();
+    int64_t bestOverlap = 0;
+
+    for (auto i = cachedViews.begin(); i != cachedViews.end(); ++i) {
+        const ViewCacheKey& cachedKey = i->first;
+        QPoint cachedOffset;
+        if (cachedKey.view.scaleFactor != key.view.scaleFactor ||
+            cachedKey.view.size != key.view.size ||
+            cachedKey.numPasses != key.numPasses ||
+            cachedKey.numericType != key.numericType ||
+            cachedKey.colorMapSize != key.colorMapSize ||
+            !findPixelTranslation(cachedKey.view, key.view, key.view.scaleFactor, cachedOffset))
+        {
+            continue;
+        }
+
+        const int64_t overlap = static_cast<int64_t>(key.view.size.width() - std::abs(cachedOffset.x())) *
+                                (key.view.size.height() - std::abs(cachedOffset.y()));
+        if (overlap > bestOverlap) {
+            best = i;
+            bestOverlap = overlap;
+            offset = cachedOffset;
+        }
+    }
+
+    if (best == cachedViews.end()) {
+        return false;
+    }
+
+    cachedViews.splice(cachedViews.begin(), cachedViews, best);
+    view = cachedViews.front().second;
+    return true;
+}
+
+/*
+ * Find a cached view rendered with the same settings at twice (zoomedIn == true) or half
+ * the scale of the view of the key, with its origin a whole number of its own pixels
+ * away from the origin of the key, so that some of its samples are exactly those of the
+ * new view: offset is the origin of the key in the pixels of the cached view
+ */
+bool ViewCache::findZoomedView(const ViewCacheKey& key, QPoint& offset, bool& zoomedIn, CachedView& view)
+{
+    for (auto i = cachedViews.begin(); i != cachedViews.end(); ++i) {
+        const ViewCacheKey& cachedKey = i->first;
+        const bool cachedIsCoarser = (cachedKey.view.scaleFactor == key.view.scaleFactor * 2.0);
+        const bool cachedIsFiner = (cachedKey.view.scaleFactor == key.view.scaleFactor * 0.5);
+        if ((!cachedIsCoarser && !cachedIsFiner) ||
+            cachedKey.view.size != key.view.size ||
+            cachedKey.numPasses != key.numPasses ||
+            cachedKey.numericType != key.numericType ||
+            cachedKey.colorMapSize != key.colorMapSize ||
+            !findPixelTranslation(cachedKey.view, key.view, cachedKey.view.scaleFactor, offset))
+        {
+            continue;
+        }
+
+        zoomedIn = cachedIsCoarser;
+        cachedViews.splice(cachedViews.begin(), cachedViews, i);
+        view = cachedViews.front().second;
+        return true;
+    }
+
+    return false;
+}
+
+void ViewCache::insert(const ViewCacheKey& key, const CachedView& view)
+{
+    cachedViews.remove_if([&](const std::pair<ViewCacheKey, CachedView>& i) { return i.first == key; });
+    cachedViews.emplace_front(key, view);
+
+    if (cachedViews.size() > MAX_CACHED_VIEWS) {
+        cachedViews.pop_back();
+    }
+}
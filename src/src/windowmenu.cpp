@@ -1,4 +1,5 @@
 #include "windowmenu.h"
+#include "overviewwindow.h"
 #include "windowthreadinfo.h"
 #include "renderthread.h"
 #include "threadiconmap.h"
@@ -13,6 +14,11 @@ WindowMenu::WindowMenu(RenderThread* masterThread) : masterThread(masterThread)
 
     threadStateKey =  new WindowThreadInfoKey(threadIcons);
     addAction("Thread State key", this, SLOT(showKey()));
+
+    overview = new OverviewWindow(masterThread);
+    connect(masterThread, SIGNAL(frameCompleted(QImage,QString,QString,double,int)),
+            overview, SLOT(setView(QImage,QString,QString,double,int)));
+    addAction("Overview Map", this, SLOT(showOverview()));
 }
 
 void WindowMenu::showInfo()
@@ -27,6 +33,12 @@ void WindowMenu::showKey()
     threadStateKey->show();
 }
 
+void WindowMenu::showOverview()
+{
+    overview->raise();
+    overview->show();
+}
+
 const ThreadIconMap *WindowMenu::getThreadIcons() const
 {
     return threadIcons;
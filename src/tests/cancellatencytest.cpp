@@ -0,0 +1,131 @@
+#include <QApplication>
+#include <QEventLoop>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <cstdlib>
+#include <iostream>
+
+#include "mandelbrotwidget.h"
+#include "renderthread.h"
+
+/*
+ * Cancels a render of the GUI render path (RenderThread and its workers) with
+ * the numeric type given as argument (the index of the type selector), once its
+ * later passes are underway; the time from the cancellation until all workers
+ * stopped must be below MAX_CANCEL_LATENCY_IN_US
+ *
+ * Types missing from the build pass without a render. Runs on the offscreen
+ * platform, with the (ini format) settings of the application kept in a
+ * temporary directory
+ */
+
+namespace {
+    constexpr int CANCEL_AFTER_IN_MS = 500;
+    constexpr qint64 MAX_CANCEL_LATENCY_IN_US = 10000;
+    constexpr int RENDER_TIMEOUT_IN_MS = 60000;
+    constexpr int QUIT_TIMEOUT_IN_MS = 10000;
+    const QSize renderSize(640, 480);
+    const char originX[] = "-0.637011";
+    const char originY[] = "-0.0395159";
+    constexpr double scale = 0.00403897;
+
+    void writeRendererSettings(int numericType)
+    {
+        QSettings settings(QSettings::IniFormat, QSettings::UserScope, "ShinkuSoft", "mandelbrot");
+        settings.beginGroup("Renderer");
+        settings.setValue("internalNumericType", numericType);
+        //the longest lines, with the highest iteration counts
+        settings.setValue("currentNumPassValue", MandelBrotRenderer::MAX_PASSES);
+        settings.setValue("focusedRenderingEnabled", false);
+        settings.setValue("speculativeRenderingEnabled", false);
+        settings.setValue("frameBudgetEnabled", false);
+        settings.setValue("backgroundModeEnabled", false);
+        settings.setValue("tileCacheSizeInMB", 0);
+        settings.setValue("diskTileCacheEnabled", false);
+        settings.endGroup();
+    }
+
+    void fail(const QString& message)
+    {
+        std::cerr << "FAIL: " << message.toStdString() << std::endl;
+        std::_Exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    bool typeIsValid = false;
+    const int numericType = (argc > 1) ? QString(argv[1]).toInt(&typeIsValid) : -1;
+    if (!typeIsValid) {
+        fail("usage: cancellatencytest <numeric type>");
+    }
+    if (!MandelBrotRenderer::typeIsCompiledIn(static_cast<MandelBrotRenderer::internalDataType>(numericType))) {
+        std::cout << "PASS: type " << numericType << " is not supported by this build" << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    QTemporaryDir settingsDirectory;
+    if (!settingsDirectory.isValid()) {
+        fail("no settings directory");
+    }
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, settingsDirectory.path());
+    writeRendererSettings(numericType);
+
+    MandelbrotWidget widget;
+    RenderThread& renderThread = widget.getRenderThread();
+    if (renderThread.getInternalDataType() != static_cast<MandelBrotRenderer::internalDataType>(numericType)) {
+        fail("renderer settings not applied");
+    }
+
+    bool completed = false;
+    QObject::connect(&renderThread, &RenderThread::frameCompleted, [&completed] { completed = true; });
+
+    QEventLoop renderLoop;
+    QTimer renderTimeout;
+    renderTimeout.setSingleShot(true);
+    QObject::connect(&renderThread, SIGNAL(allDone()), &renderLoop, SLOT(quit()));
+    QObject::connect(&renderTimeout, SIGNAL(timeout()), &renderLoop, SLOT(quit()));
+
+    renderThread.render(originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                        originX, originY,
+#endif
+                        scale, renderSize);
+    QTimer::singleShot(CANCEL_AFTER_IN_MS, &renderThread, SLOT(haltComputations()));
+    renderTimeout.start(RENDER_TIMEOUT_IN_MS);
+    renderLoop.exec();
+    if (!renderTimeout.isActive()) {
+        fail("the cancelled render did not stop");
+    }
+    renderTimeout.stop();
+    if (completed) {
+        fail("the render completed before it was cancelled, nothing was measured");
+    }
+
+    const qint64 latency = renderThread.getCancelLatencyInUs();
+    std::cout << "type: " << numericType << ", passes done: " << renderThread.getPassesDone()
+              << ", cancel latency (us): " << latency << std::endl;
+    if (latency >= MAX_CANCEL_LATENCY_IN_US) {
+        fail("the workers took " + QString::number(latency) + " us to stop");
+    }
+
+    //the quit flow of the application, without its confirmation
+    QTimer::singleShot(QUIT_TIMEOUT_IN_MS, [] { fail("the renderer did not quit"); });
+    renderThread.quitApplication();
+    renderThread.render(originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                        originX, originY,
+#endif
+                        scale, renderSize);
+    QApplication::exec();
+
+    std::cout << "PASS: cancel latency " << latency << " us" << std::endl;
+    return EXIT_SUCCESS;
+}
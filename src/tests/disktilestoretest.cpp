@@ -0,0 +1,152 @@
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "disktilestore.h"
+
+/*
+ * Opens a tile store holding a valid pack next to packs which are truncated or
+ * have a corrupt index, only the tiles of the valid pack must be found and the
+ * others must be removed (a crash or a full disk used to leave such packs behind)
+ *
+ * Also checks that stale temporary pack files are removed, and that the last
+ * use of a pack is kept as its modification time
+ */
+
+namespace {
+    //offsets in the pack, see DiskTileStore::PackHeader and TileRecord
+    constexpr qint64 TILE_COUNT_OFFSET = 12;
+    constexpr qint64 FIRST_TILE_OFFSET_OFFSET = 16 + 48;
+    constexpr qint64 HOUR_IN_MS = 60 * 60 * 1000;
+
+    const TileKey storedKey { 0.00403897, 0, 0, 12, -7,
+                              TileRenderSettings { MandelBrotRenderer::internalDataType::doublePrecisionFloat, 256,
+                                                   MandelBrotRenderer::setType::mandelbrot, 4096 } };
+
+    void fail(const QString& message)
+    {
+        std::cerr << "FAIL: " << message.toStdString() << std::endl;
+        std::exit(EXIT_FAILURE);
+    }
+
+    void copyPack(const QString& from, const QString& to)
+    {
+        if (!QFile::copy(from, to)) {
+            fail("could not copy the pack to " + to);
+        }
+    }
+
+    template <typename T>
+    void overwrite(const QString& path, qint64 offset, T value)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadWrite) || !file.seek(offset) ||
+            file.write(reinterpret_cast<const char *>(&value), sizeof(value)) != static_cast<qint64>(sizeof(value))) {
+            fail("could not corrupt " + path);
+        }
+    }
+
+    void writeFile(const QString& path, const QByteArray& contents, qint64 lastModified)
+    {
+        QFile file(path);
+        //written out first, or closing the file would set the modification time again
+        if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size() || !file.flush() ||
+            !file.setFileTime(QDateTime::fromMSecsSinceEpoch(lastModified), QFileDevice::FileModificationTime)) {
+            fail("could not write " + path);
+        }
+    }
+}
+
+int main()
+{
+    QTemporaryDir storeDirectory;
+    if (!storeDirectory.isValid()) {
+        fail("no store directory");
+    }
+    QDir directory(storeDirectory.path());
+
+    std::vector<uint> pixels(TileCache::TILE_SIZE_IN_BYTES / sizeof(uint));
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<uint>(i * 2654435761u);
+    }
+
+    QString validPack;
+    {
+        DiskTileStore store;
+        if (!store.open(directory.path(), false) || !store.storeTiles({ { storedKey, pixels.data() } })) {
+            fail("the pack was not written");
+        }
+        const QStringList packs = directory.entryList(QStringList("*.tiles"), QDir::Files);
+        if (packs.size() != 1) {
+            fail("one pack expected");
+        }
+        validPack = directory.filePath(packs.front());
+    }
+    const qint64 validPackSize = QFileInfo(validPack).size();
+
+    const QString truncatedPack = directory.filePath("truncated.tiles");
+    copyPack(validPack, truncatedPack);
+    QFile::resize(truncatedPack, validPackSize / 2);
+
+    const QString oversizedIndexPack = directory.filePath("oversizedindex.tiles");
+    copyPack(validPack, oversizedIndexPack);
+    overwrite<quint32>(oversizedIndexPack, TILE_COUNT_OFFSET, 0x7fffffff);
+
+    const QString badOffsetPack = directory.filePath("badoffset.tiles");
+    copyPack(validPack, badOffsetPack);
+    overwrite<quint64>(badOffsetPack, FIRST_TILE_OFFSET_OFFSET, static_cast<quint64>(validPackSize));
+
+    const QString badMagicPack = directory.filePath("badmagic.tiles");
+    copyPack(validPack, badMagicPack);
+    overwrite<quint32>(badMagicPack, 0, 0);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const QString headerOnlyPack = directory.filePath("short.tiles");
+    writeFile(headerOnlyPack, QByteArray(3, 'x'), now);
+    const QString staleTemporaryFile = directory.filePath("crashed.tiles.aBcDeF");
+    writeFile(staleTemporaryFile, QByteArray(64, 'x'), now - HOUR_IN_MS);
+    const QString recentTemporaryFile = directory.filePath("writing.tiles.GhIjKl");
+    writeFile(recentTemporaryFile, QByteArray(64, 'x'), now);
+
+    //the valid pack was last used an hour ago
+    {
+        QFile pack(validPack);
+        if (!pack.open(QIODevice::ReadWrite) ||
+            !pack.setFileTime(QDateTime::fromMSecsSinceEpoch(now - HOUR_IN_MS), QFileDevice::FileModificationTime)) {
+            fail("could not set the modification time of the pack");
+        }
+    }
+
+    DiskTileStore store;
+    if (!store.open(directory.path(), false)) {
+        fail("the store was not opened");
+    }
+    if (store.getUsedSize() != validPackSize) {
+        fail("only the valid pack may be counted, used size " + QString::number(store.getUsedSize()));
+    }
+    const uint* found = store.find(storedKey);
+    if (found == nullptr || std::memcmp(found, pixels.data(), TileCache::TILE_SIZE_IN_BYTES) != 0) {
+        fail("the tile of the valid pack was not found");
+    }
+    for (const auto& i : { truncatedPack, oversizedIndexPack, badOffsetPack, badMagicPack, headerOnlyPack }) {
+        if (QFile::exists(i)) {
+            fail(i + " was not removed");
+        }
+    }
+    if (QFile::exists(staleTemporaryFile) || !QFile::exists(recentTemporaryFile)) {
+        fail("only the stale temporary file may be removed");
+    }
+    if (QFileInfo(validPack).lastModified().toMSecsSinceEpoch() < now - HOUR_IN_MS / 2) {
+        fail("the last use of the pack was not kept");
+    }
+
+    std::cout << "PASS: the corrupt packs were rejected" << std::endl;
+    return EXIT_SUCCESS;
+}
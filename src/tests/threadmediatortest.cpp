@@ -0,0 +1,111 @@
+#include <QApplication>
+#include <QEventLoop>
+#include <QSettings>
+#include <QTemporaryDir>
+#include <QTimer>
+
+#include <cstdlib>
+#include <iostream>
+
+#include "mandelbrotwidget.h"
+#include "renderthread.h"
+
+/*
+ * Renders a series of views with the maximum number of workers and the thread
+ * mediator enabled, each render must complete within RENDER_TIMEOUT_IN_MS
+ * (a worker holding the mediator mutex while another waited to reacquire it
+ * used to deadlock renders with three or more workers)
+ *
+ * Runs on the offscreen platform, with the (ini format) settings of the
+ * application kept in a temporary directory
+ */
+
+namespace {
+    constexpr int NUM_RENDERS = 8;
+    constexpr int RENDER_TIMEOUT_IN_MS = 60000;
+    constexpr int QUIT_TIMEOUT_IN_MS = 10000;
+    const QSize renderSize(640, 480);
+    const char originX[] = "-0.637011";
+    const char originY[] = "-0.0395159";
+    constexpr double initialScale = 0.00403897;
+
+    void writeRendererSettings()
+    {
+        QSettings settings(QSettings::IniFormat, QSettings::UserScope, "ShinkuSoft", "mandelbrot");
+        settings.beginGroup("Renderer");
+        settings.setValue("numWorkerThreads", MandelBrotRenderer::MAX_NUM_WORKER_THREADS);
+        settings.setValue("threadMediatorEnabled", true);
+        //the other schedulers bypass the mediator, and cached views would skip the workers
+        settings.setValue("focusedRenderingEnabled", false);
+        settings.setValue("speculativeRenderingEnabled", false);
+        settings.setValue("frameBudgetEnabled", false);
+        settings.setValue("backgroundModeEnabled", false);
+        settings.setValue("tileCacheSizeInMB", 0);
+        settings.setValue("diskTileCacheEnabled", false);
+        settings.endGroup();
+    }
+
+    void fail(const QString& message)
+    {
+        std::cerr << "FAIL: " << message.toStdString() << std::endl;
+        //the workers may be deadlocked, don't wait for them
+        std::_Exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    QTemporaryDir settingsDirectory;
+    if (!settingsDirectory.isValid()) {
+        fail("no settings directory");
+    }
+    QSettings::setPath(QSettings::IniFormat, QSettings::UserScope, settingsDirectory.path());
+    writeRendererSettings();
+
+    MandelbrotWidget widget;
+    RenderThread& renderThread = widget.getRenderThread();
+    if (renderThread.getNumWorkerThreads() != MandelBrotRenderer::MAX_NUM_WORKER_THREADS ||
+        !renderThread.dynamicThreadAllocationEnabled()) {
+        fail("renderer settings not applied");
+    }
+
+    QEventLoop renderLoop;
+    QTimer renderTimeout;
+    renderTimeout.setSingleShot(true);
+    QObject::connect(&renderThread, SIGNAL(allDone()), &renderLoop, SLOT(quit()));
+    QObject::connect(&renderTimeout, SIGNAL(timeout()), &renderLoop, SLOT(quit()));
+
+    double scale = initialScale;
+    for (int i = 0; i < NUM_RENDERS; ++i) {
+        renderThread.render(originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                            originX, originY,
+#endif
+                            scale, renderSize);
+        renderTimeout.start(RENDER_TIMEOUT_IN_MS);
+        renderLoop.exec();
+        if (!renderTimeout.isActive()) {
+            fail("render " + QString::number(i) + " did not complete");
+        }
+        renderTimeout.stop();
+        scale *= MandelbrotWidget::ZoomInFactor;
+    }
+
+    //the quit flow of the application, without its confirmation
+    QTimer::singleShot(QUIT_TIMEOUT_IN_MS, [] { fail("the renderer did not quit"); });
+    renderThread.quitApplication();
+    renderThread.render(originX, originY,
+#if (USE_BOOST_MULTIPRECISION == 1) || defined(__GNUC__)
+                        originX, originY,
+#endif
+                        scale, renderSize);
+    QApplication::exec();
+
+    std::cout << "PASS: " << NUM_RENDERS << " renders with " << MandelBrotRenderer::MAX_NUM_WORKER_THREADS << " workers" << std::endl;
+    return EXIT_SUCCESS;
+}